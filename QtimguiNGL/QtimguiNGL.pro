@@ -14,27 +14,63 @@ isEqual(QT_MAJOR_VERSION, 5) {
 MOC_DIR=moc
 # on a mac we don't create a .app bundle file ( for ease of multiplatform use)
 CONFIG-=app_bundle
+# the font atlas renders its glyphs on several threads
+linux:LIBS+= -lpthread
 # Auto include all .cpp files in the project src directory (can specifiy individually if required)
 SOURCES+= $$PWD/src/NGLScene.cpp    \
           $$PWD/../imgui/src/imgui.cpp \
           $$PWD/../imgui/src/imgui_draw.cpp \
 #          $$PWD/src/ImGUIImpl.cpp \
           $$PWD/../imgui/src/ColourPicker.cpp \
+          $$PWD/../imgui/src/ImDrawCompact.cpp \
+          $$PWD/../imgui/src/ImDrawListCache.cpp \
+          $$PWD/../imgui/src/ImDrawVertLayout.cpp \
           $$PWD/src/ImGuiRenderer.cpp \
           $$PWD/src/QtImGui.cpp \
+          $$PWD/src/GLStateCache.cpp \
+          $$PWD/src/GPUTimer.cpp \
+          $$PWD/src/ProgramCache.cpp \
 					$$PWD/src/main.cpp
 # same for the .h files
 HEADERS+= $$PWD/include/NGLScene.h \
           $$PWD/include/QtImGui.h \
           $$PWD/include/ImGuiRenderer.h \
+          $$PWD/include/GLStateCache.h \
+          $$PWD/include/GPUTimer.h \
+          $$PWD/include/ProgramCache.h \
           $$PWD/../imgui/include/imgui.h \
           $$PWD/../imgui/include/stb_rect_pack.h \
           $$PWD/../imgui/include/stb_truetype.h \
           $$PWD/../imgui/include/imconfig.h \
           $$PWD/../imgui/include/imgui_internal.h \
           $$PWD/../imgui/include/stb_textedit.h \
+          $$PWD/../imgui/include/ImDrawCompact.h \
+          $$PWD/../imgui/include/ImDrawListCache.h \
+          $$PWD/../imgui/include/ImDrawVertLayout.h \
+          $$PWD/../imgui/include/ImDrawSimd.h \
 #          $$PWD/include/ImGUIImpl.h
 
+# qmake CONFIG+=prebaked_font bakes the default font atlas into a header at build time so AddFontDefault() skips
+# decompressing and rasterizing ProggyClean. The tool only needs ImGui itself and is built without the define
+prebaked_font {
+	fontbake.target = generated/imgui_default_font_atlas.h
+	fontbake.commands = mkdir -p generated ;
+	fontbake.commands += $$QMAKE_CXX -std=c++11 -O2 -I$$PWD/../imgui/include -o generated/ImFontAtlasBake \
+	                     $$PWD/../imgui/tools/ImFontAtlasBake.cpp $$PWD/../imgui/src/imgui.cpp $$PWD/../imgui/src/imgui_draw.cpp -lpthread ;
+	fontbake.commands += generated/ImFontAtlasBake $$fontbake.target
+	fontbake.depends = $$PWD/../imgui/tools/ImFontAtlasBake.cpp $$PWD/../imgui/src/imgui_draw.cpp
+	QMAKE_EXTRA_TARGETS += fontbake
+	PRE_TARGETDEPS += $$fontbake.target
+	INCLUDEPATH += generated
+	DEFINES += IMGUI_PREBAKED_DEFAULT_FONT
+}
+
+# make polylinebench builds and runs the AddPolyline SIMD / scalar comparison, it is never part of the demo build
+polylinebench.commands = $$QMAKE_CXX -std=c++11 -O2 -I$$PWD/../imgui/include -o ImDrawPolylineBench \
+                         $$PWD/../imgui/tools/ImDrawPolylineBench.cpp $$PWD/../imgui/src/imgui.cpp $$PWD/../imgui/src/imgui_draw.cpp -lpthread ;
+polylinebench.commands += ./ImDrawPolylineBench
+QMAKE_EXTRA_TARGETS += polylinebench
+
 # and add the include dir into the search path for Qt and make
 INCLUDEPATH +=./include
 INCLUDEPATH +=../imgui/include
@@ -0,0 +1,106 @@
+#ifndef GLSTATECACHE_H_
+#define GLSTATECACHE_H_
+#include <ngl/Types.h>
+#include <string>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GLStateCache.h
+/// @brief shadow copy of the bits of GL state the scene and the ImGui renderer touch
+/// @class GLStateCache
+/// @brief every pass asks for the state it needs through this class and only real changes reach the driver, this
+/// replaces the glGet* backup / restore of the ImGui render function (queries can force a pipeline sync).
+/// Anything that changes GL state behind the cache's back (NGL VAOs, ImGui user callbacks, Qt) must call
+/// invalidate() with the matching flags so the next request is emitted again.
+//----------------------------------------------------------------------------------------------------------------------
+class GLStateCache
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief groups of state for invalidate()
+    //----------------------------------------------------------------------------------------------------------------------
+    enum Flags
+    {
+      PROGRAM      = 1 << 0,
+      VERTEX_ARRAY = 1 << 1,
+      TEXTURE      = 1 << 2,
+      CAPABILITIES = 1 << 3,
+      BLEND        = 1 << 4,
+      VIEWPORT     = 1 << 5,
+      SCISSOR      = 1 << 6,
+      POLYGON_MODE = 1 << 7,
+      ALL          = 0xff
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief get the singleton, all state lives in the one GL context the demos use
+    //----------------------------------------------------------------------------------------------------------------------
+    static GLStateCache *instance();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief forget what we know about some state so the next request is sent to GL
+    /// @param[in] _flags the groups to forget, see Flags
+    //----------------------------------------------------------------------------------------------------------------------
+    void invalidate(unsigned int _flags=ALL);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make an ngl::ShaderLib program active, goes through ShaderLib so its setUniform calls stay valid
+    /// @param[in] _name the ShaderLib program name
+    //----------------------------------------------------------------------------------------------------------------------
+    void useProgram(const std::string &_name);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make a raw GL program active
+    /// @param[in] _id the GL program id
+    //----------------------------------------------------------------------------------------------------------------------
+    void useProgram(GLuint _id);
+    void bindVertexArray(GLuint _vao);
+    void bindArrayBuffer(GLuint _buffer);
+    void activeTexture(GLenum _unit);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bind a GL_TEXTURE_2D to the active unit, the cache assumes the ImGui textures all live on unit 0
+    //----------------------------------------------------------------------------------------------------------------------
+    void bindTexture2D(GLuint _texture);
+    void enableBlend(bool _on);
+    void enableCullFace(bool _on);
+    void enableDepthTest(bool _on);
+    void enableScissorTest(bool _on);
+    void blendEquation(GLenum _mode);
+    void blendFunc(GLenum _src, GLenum _dst);
+    void blendFuncSeparate(GLenum _srcRGB, GLenum _dstRGB, GLenum _srcAlpha, GLenum _dstAlpha);
+    void viewport(GLint _x, GLint _y, GLsizei _w, GLsizei _h);
+    void scissor(GLint _x, GLint _y, GLsizei _w, GLsizei _h);
+    void polygonMode(GLenum _mode);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of GL calls requested / actually emitted since the last resetCounters
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int requested() const {return m_requested;}
+    unsigned int emitted() const {return m_emitted;}
+    void resetCounters(){m_requested=m_emitted=0;}
+  private :
+    GLStateCache();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set a capability if it differs from the cached value
+    //----------------------------------------------------------------------------------------------------------------------
+    void setCapability(GLenum _cap, int &_cached, bool _on);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief cached values, -1 (or the empty name) means unknown
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string m_programName;
+    GLint m_program=-1;
+    GLint m_vertexArray=-1;
+    GLint m_arrayBuffer=-1;
+    GLint m_activeTexture=-1;
+    GLint m_texture=-1;
+    int m_blend=-1;
+    int m_cullFace=-1;
+    int m_depthTest=-1;
+    int m_scissorTest=-1;
+    GLint m_blendEquation=-1;
+    GLint m_blendSrc=-1;
+    GLint m_blendDst=-1;
+    GLint m_blendSrcAlpha=-1;
+    GLint m_blendDstAlpha=-1;
+    GLint m_viewport[4]={-1,-1,-1,-1};
+    GLint m_scissor[4]={-1,-1,-1,-1};
+    GLint m_polygonMode=-1;
+    unsigned int m_requested=0;
+    unsigned int m_emitted=0;
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef GPUTIMER_H_
+#define GPUTIMER_H_
+#include <ngl/Types.h>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GPUTimer.h
+/// @brief GL_TIME_ELAPSED queries around the scene and UI passes
+/// @class GPUTimer
+/// @brief each frame is split into named sections, one query each. The queries of a frame are only read back when
+/// the ring comes round to it again (FrameLatency frames later) so asking for the results never waits on the GPU,
+/// a frame that is still in flight by then is dropped and the previous results stay up.
+/// Time elapsed queries cannot nest, begin() ends the open section first.
+//----------------------------------------------------------------------------------------------------------------------
+class GPUTimer
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a section of the last frame that was read back
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Section
+    {
+      std::string name;
+      float ms;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief frames between issuing the queries and reading them back
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr int FrameLatency=4;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief get the singleton, the scene and the ImGui renderer time into the same frame
+    //----------------------------------------------------------------------------------------------------------------------
+    static GPUTimer *instance();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief off by default, begin / end / newFrame do nothing until enabled
+    //----------------------------------------------------------------------------------------------------------------------
+    void setEnabled(bool _on);
+    bool isEnabled() const {return m_enabled;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start a frame, call before the first pass. Collects the oldest frame of the ring and reuses its queries
+    //----------------------------------------------------------------------------------------------------------------------
+    void newFrame();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start timing a section
+    /// @param[in] _name shown in the timing window, copied
+    //----------------------------------------------------------------------------------------------------------------------
+    void begin(const char *_name);
+    void end();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the last frame read back and the sum of its sections in ms
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<Section> &sections() const {return m_sections;}
+    float totalMs() const {return m_totalMs;}
+  private :
+    GPUTimer(){}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the queries of one frame, kept between frames so nothing is allocated once the ring is warm
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Frame
+    {
+      std::vector<GLuint> queries;
+      std::vector<std::string> names;
+      size_t used=0;
+    };
+    Frame m_frames[FrameLatency];
+    int m_current=0;
+    bool m_enabled=false;
+    bool m_open=false;
+    std::vector<Section> m_sections;
+    float m_totalMs=0.0f;
+};
+
+#endif
@@ -3,11 +3,15 @@
 #include <QOpenGLExtraFunctions>
 #include <QObject>
 #include <imgui.h>
+#include <ImDrawCompact.h>
+#include <ImDrawListCache.h>
+#include <ImDrawVertLayout.h>
 #include <memory>
 
 class QMouseEvent;
 class QWheelEvent;
 class QKeyEvent;
+class GLStateCache;
 
 namespace QtImGui {
 
@@ -30,6 +34,27 @@ public:
     bool eventFilter(QObject *watched, QEvent *event);
 
     static ImGuiRenderer *instance();
+    // draw call statistics of the last rendered frame
+    const ImDrawCompactStats &drawStats() const { return m_drawStats; }
+    // how many lists of the last frame were drawn without being uploaded again
+    const ImDrawListCacheStats &listCacheStats() const { return m_listCacheStats; }
+    // upload the font atlas as a single channel GL_R8 texture (default) or as RGBA32
+    void setFontAlpha8(bool enable);
+    // rebuild the font atlas as signed distance fields (ImFontAtlas::TexDistanceField), text then stays sharp at any
+    // io.FontGlobalScale / SetWindowFontScale. Takes effect at the next newFrame
+    void setFontDistanceField(bool enable);
+    // draw the UI into a cached texture that is only redrawn when the draw data changes and blended over the scene
+    void setUiLayer(bool enable);
+    // opt in to the GL 4.3 multi-draw-indirect path, returns false on older contexts
+    bool setMultiDrawIndirect(bool enable);
+    // ImGui::Render() only uploads the frame and works out what changed, for windows that keep their last frame
+    // (QOpenGLWindow::PartialUpdateBlit). Draw it with renderFrame() once whatever is under the UI is drawn
+    void setDeferredRender(bool enable);
+    // the part of the framebuffer the deferred frame changed as a glScissor rect (x, y, w, h), false when nothing
+    // changed. The whole framebuffer when it can't be narrowed down (size changes, user callbacks)
+    bool frameDamage(int out_rect[4]) const;
+    // draw the deferred frame, clip_rect (glScissor x, y, w, h) limits it to part of the framebuffer, may be null
+    void renderFrame(const int *clip_rect);
 
 private:
     ImGuiRenderer() {}
@@ -38,19 +63,76 @@ private:
     void onWheel(QWheelEvent *event);
     void onKeyPressRelease(QKeyEvent *event);
 
+    void setupRenderState(GLStateCache *state, int fb_width, int fb_height, bool indirect);
+    void bindTexture(GLStateCache *state, ImTextureID texture_id, bool indirect);
     void renderDrawList(ImDrawData *draw_data);
+    void drawFrame(GLStateCache *state, const int *clip_rect);
+    void finishFrame();
+    void renderIndirect(GLStateCache *state, int fb_width, int fb_height);
+    void renderCommands(GLStateCache *state, int fb_width, int fb_height, const int *clip_rect);
+    void createLayer(int fb_width, int fb_height);
+    void renderLayer(GLStateCache *state, int fb_width, int fb_height);
+    void compositeLayer(GLStateCache *state, int fb_width, int fb_height, const int *clip_rect);
+    void waitRingFence(int segment);
+    void resizeRingBuffers(int vtx_capacity, int idx_capacity);
+    void uploadDrawData(ImDrawData *draw_data, int vtx_base, int idx_base);
     bool createFontsTexture();
+    void uploadFontRect(int x, int y, int width, int height);
+    void updateFontDistanceField();
+    void setupVertexAttribs(GLuint pos_location, GLuint uv_location, GLuint col_location);
     bool createDeviceObjects();
+    void createIndirectObjects();
 
     std::unique_ptr<WindowWrapper> m_window;
+    ImVector<ImDrawCompactCmd> m_compactCmds;
+    ImDrawCompactStats m_drawStats;
+    // g_VboHandle / g_ElementsHandle hold RingFrames streaming segments followed by a resident region for the lists
+    // that did not change, segments are fenced so we never write what the GPU may still read
+    static const int RingFrames = 3;
+    int          m_ringVtxCapacity = 0, m_ringIdxCapacity = 0;
+    int          m_ringFrame = 0;
+    GLsync       m_ringFences[RingFrames] = { 0, 0, 0 };
+    ImDrawListCache m_listCache;
+    ImVector<ImDrawListSlot> m_listSlots;
+    ImDrawListCacheStats m_listCacheStats;
+    ImVector<ImDrawIndirectCmd> m_indirectCmds;
+    ImVector<ImVec4> m_indirectClipRects;
+    ImVector<ImDrawIndirectRun> m_indirectRuns;
+    bool         m_fontAlpha8 = true;
+    // the atlas holds distance fields, draws sampling it use the SDF program variants
+    bool         m_fontDistanceField = false;
+    // setFontDistanceField() waiting for the next newFrame, -1 for none
+    int          m_fontDistanceFieldRequest = -1;
+    // cached UI layer, premultiplied alpha, composited with a full-screen triangle from gl_VertexID
+    bool         m_useLayer = false;
+    bool         m_layerPass = false;
+    bool         m_layerValid = false;
+    ImU64        m_layerHash = 0;
+    int          m_layerWidth = 0, m_layerHeight = 0;
+    GLuint       m_layerFbo = 0, m_layerTexture = 0, m_layerVaoHandle = 0;
+    int          m_compositeShaderHandle = 0, m_compositeAttribLocationLayer = 0;
+    // setDeferredRender(), the frame ImGui::Render() uploaded waits for renderFrame() at m_fbWidth x m_fbHeight
+    bool         m_deferRender = false;
+    bool         m_framePending = false;
+    bool         m_fullDamage = true;
+    int          m_fbWidth = 0, m_fbHeight = 0;
+    bool         m_indirectSupported = false;
+    bool         m_useIndirect = false;
     double       g_Time = 0.0f;
     bool         g_MousePressed[3] = { false, false, false };
     float        g_MouseWheel = 0.0f;
     GLuint       g_FontTexture = 0;
     int          g_ShaderHandle = 0, g_VertHandle = 0, g_FragHandle = 0;
     int          g_AttribLocationTex = 0, g_AttribLocationProjMtx = 0;
+    int          g_SdfShaderHandle = 0, g_SdfFragHandle = 0;
+    int          g_SdfAttribLocationTex = 0, g_SdfAttribLocationProjMtx = 0;
     int          g_AttribLocationPosition = 0, g_AttribLocationUV = 0, g_AttribLocationColor = 0;
     unsigned int g_VboHandle = 0, g_VaoHandle = 0, g_ElementsHandle = 0;
+    int          g_IndirectShaderHandle = 0, g_IndirectVertHandle = 0, g_IndirectFragHandle = 0;
+    int          g_IndirectAttribLocationTex = 0, g_IndirectAttribLocationProjMtx = 0;
+    int          g_IndirectSdfShaderHandle = 0, g_IndirectSdfFragHandle = 0;
+    int          g_IndirectSdfAttribLocationTex = 0, g_IndirectSdfAttribLocationProjMtx = 0;
+    unsigned int g_IndirectVaoHandle = 0, g_IndirectHandle = 0, g_ClipRectHandle = 0;
 };
 
 }
@@ -139,6 +139,11 @@ private:
     bool showLightControls=true;
     bool showMaterialControls=true;
     void drawIMGUI();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief GPU time of the scene and of each UI list next to the frame time, closing it stops the timer queries
+    //----------------------------------------------------------------------------------------------------------------------
+    bool showTimings=false;
+    void drawTimings();
     std::array<bool,3> m_mouseButtons;
     void setMouseState(QMouseEvent * _event);
     void setLight(const ngl::Vec4 &_position,const ngl::Vec4 &_ambient,const ngl::Vec4 &_specular,const ngl::Vec4 &_diffuse );
@@ -149,6 +154,14 @@ private:
     ngl::Vec4 m_clearColour= {0.5,0.5,0.5,1.0};
     int m_modelID = 0;
     ngl::Mat4 m_localScale;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief wireframe flag, applied in paintGL as the ImGui pass needs GL_FILL
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_wireframe=false;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set when anything the scene pass draws changed, otherwise paintGL only redraws the UI damage
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_sceneChanged=true;
 
 
 
@@ -0,0 +1,63 @@
+#ifndef PROGRAMCACHE_H_
+#define PROGRAMCACHE_H_
+#include <ngl/Types.h>
+#include <cstdint>
+#include <string>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ProgramCache.h
+/// @brief linked shader programs kept on disk between runs
+/// @class ProgramCache
+/// @brief builds ShaderLib programs from a vertex and a fragment file. The first run compiles and links as usual and
+/// writes the glGetProgramBinary output to the cache directory, later runs hand it straight back to glProgramBinary.
+/// Each file is tagged with a hash of both sources and the GL_VENDOR / GL_RENDERER / GL_VERSION strings, an edited
+/// shader or a driver update gives another hash and the program is compiled again. A binary the driver still refuses
+/// (GL_LINK_STATUS false) also falls back to compiling, the program object can still take shaders after that.
+//----------------------------------------------------------------------------------------------------------------------
+class ProgramCache
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief get the singleton, both the ImGui renderer and the scene load through it
+    //----------------------------------------------------------------------------------------------------------------------
+    static ProgramCache *instance();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief where the binaries go, "shadercache" (relative to the working directory like shaders/) by default.
+    /// An empty string turns the cache off and every program is compiled
+    //----------------------------------------------------------------------------------------------------------------------
+    void setDirectory(const std::string &_dir){m_dir=_dir;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create a ShaderLib program and load it from the cache or compile, link and store it. Replaces the
+    /// createShaderProgram / attachShader / loadShaderSource / compileShader / linkProgramObject sequence
+    /// @param[in] _program the ShaderLib program name, also the cache file name
+    /// @param[in] _vertex the name of the vertex shader
+    /// @param[in] _vertexFile the vertex source file
+    /// @param[in] _fragment the name of the fragment shader
+    /// @param[in] _fragmentFile the fragment source file
+    /// @returns true if the program came from the cache
+    //----------------------------------------------------------------------------------------------------------------------
+    bool loadProgram(const std::string &_program, const std::string &_vertex, const std::string &_vertexFile,
+                     const std::string &_fragment, const std::string &_fragmentFile);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief programs loaded from the cache and compiled since the start
+    //----------------------------------------------------------------------------------------------------------------------
+    int hits() const {return m_hits;}
+    int misses() const {return m_misses;}
+  private :
+    ProgramCache(){}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief FNV-1a over the sources and the driver strings
+    //----------------------------------------------------------------------------------------------------------------------
+    uint64_t key(const std::string &_vertex, const std::string &_fragment) const;
+    std::string path(const std::string &_program) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief glProgramBinary from the cache file if its key matches, false when missing, stale or refused
+    //----------------------------------------------------------------------------------------------------------------------
+    bool restore(GLuint _id, const std::string &_program, uint64_t _key) const;
+    void store(GLuint _id, const std::string &_program, uint64_t _key) const;
+    std::string m_dir="shadercache";
+    int m_hits=0;
+    int m_misses=0;
+};
+
+#endif
@@ -2,6 +2,8 @@
 
 class QWidget;
 class QWindow;
+struct ImDrawCompactStats;
+struct ImDrawListCacheStats;
 
 namespace QtImGui {
 
@@ -11,5 +13,14 @@ void initialize(QWidget *window);
 
 void initialize(QWindow *window);
 void newFrame();
+const ImDrawCompactStats &drawStats();
+const ImDrawListCacheStats &listCacheStats();
+void setFontAlpha8(bool enable);
+void setFontDistanceField(bool enable);
+void setUiLayer(bool enable);
+bool setMultiDrawIndirect(bool enable);
+void setDeferredRender(bool enable);
+bool frameDamage(int rect[4]);
+void renderFrame(const int *clipRect);
 
 }
@@ -1,10 +1,15 @@
 #include "ImGuiRenderer.h"
+#include "GLStateCache.h"
+#include "GPUTimer.h"
 #include <QDateTime>
 #include <QGuiApplication>
 #include <QMouseEvent>
 #include <QClipboard>
 #include <QCursor>
 #include <QDebug>
+#include <QOpenGLContext>
+#include <cstring>
+#include <algorithm>
 
 namespace QtImGui {
 
@@ -57,10 +62,149 @@ void ImGuiRenderer::initialize(WindowWrapper *window) {
         g_currentClipboardText = QGuiApplication::clipboard()->text().toUtf8();
         return (const char *)g_currentClipboardText.data();
     };
+    // keep the built font atlas next to imgui.ini, later runs load it instead of rasterizing the fonts again
+    io.Fonts->BuildCacheFilename = "imgui_fonts.bin";
 
     window->installEventFilter(this);
 }
 
+void ImGuiRenderer::setupRenderState(GLStateCache *state, int fb_width, int fb_height, bool indirect)
+{
+    // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled (clipping is done
+    // in the shader on the indirect path)
+    ImGuiIO& io = ImGui::GetIO();
+    state->enableBlend(true);
+    state->blendEquation(GL_FUNC_ADD);
+    if (m_layerPass)
+        state->blendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    else
+        state->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state->enableCullFace(false);
+    state->enableDepthTest(false);
+    state->enableScissorTest(!indirect);
+    state->polygonMode(GL_FILL);
+    state->activeTexture(GL_TEXTURE0);
+
+    // Setup viewport, orthographic projection matrix, vertex positions are in 1 / PosScale() pixels
+    state->viewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height);
+    const float pos_scale = ImDrawVertLayout::PosScale();
+    const float ortho_projection[4][4] =
+    {
+        { 2.0f/(io.DisplaySize.x*pos_scale), 0.0f,                               0.0f, 0.0f },
+        { 0.0f,                              2.0f/(-io.DisplaySize.y*pos_scale), 0.0f, 0.0f },
+        { 0.0f,                              0.0f,                              -1.0f, 0.0f },
+        {-1.0f,                              1.0f,                               0.0f, 1.0f },
+    };
+    if (m_fontDistanceField)
+    {
+        // the variant keeps its own uniforms, so the draw loop only has to switch programs
+        state->useProgram(indirect ? g_IndirectSdfShaderHandle : g_SdfShaderHandle);
+        glUniform1i(indirect ? g_IndirectSdfAttribLocationTex : g_SdfAttribLocationTex, 0);
+        glUniformMatrix4fv(indirect ? g_IndirectSdfAttribLocationProjMtx : g_SdfAttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
+    }
+    if (indirect)
+    {
+        state->useProgram(g_IndirectShaderHandle);
+        glUniform1i(g_IndirectAttribLocationTex, 0);
+        glUniformMatrix4fv(g_IndirectAttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
+        state->bindVertexArray(g_IndirectVaoHandle);
+        return;
+    }
+    state->useProgram(g_ShaderHandle);
+    glUniform1i(g_AttribLocationTex, 0);
+    glUniformMatrix4fv(g_AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
+    state->bindVertexArray(g_VaoHandle);
+}
+
+void ImGuiRenderer::bindTexture(GLStateCache *state, ImTextureID texture_id, bool indirect)
+{
+    // with a distance field atlas the font texture is thresholded by the SDF variant of the program
+    const GLuint texture = (GLuint)(intptr_t)texture_id;
+    state->bindTexture2D(texture);
+    if (!m_fontDistanceField)
+        return;
+    if (texture == g_FontTexture)
+        state->useProgram(indirect ? g_IndirectSdfShaderHandle : g_SdfShaderHandle);
+    else
+        state->useProgram(indirect ? g_IndirectShaderHandle : g_ShaderHandle);
+}
+
+void ImGuiRenderer::renderIndirect(GLStateCache *state, int fb_width, int fb_height)
+{
+    // One glMultiDrawElementsIndirect per run of commands sharing a texture, each draw's clip rect is a per instance
+    // attribute fetched through its baseInstance
+    ImDrawCompactBuildIndirect(m_compactCmds, 0, 0, m_indirectCmds, m_indirectClipRects, m_indirectRuns, &m_drawStats);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, g_IndirectHandle);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)m_indirectCmds.Size * sizeof(ImDrawIndirectCmd), (const GLvoid*)m_indirectCmds.Data, GL_STREAM_DRAW);
+    state->bindArrayBuffer(g_ClipRectHandle);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_indirectClipRects.Size * sizeof(ImVec4), (const GLvoid*)m_indirectClipRects.Data, GL_STREAM_DRAW);
+
+    for (const ImDrawIndirectRun* run = m_indirectRuns.begin(); run != m_indirectRuns.end(); run++)
+    {
+        if (run->UserCmd)
+        {
+            run->UserCmd->UserCmd->UserCallback(run->UserCmd->CmdList, run->UserCmd->UserCmd);
+            // we have no idea what the callback did to GL
+            state->invalidate();
+            setupRenderState(state, fb_width, fb_height, true);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, g_IndirectHandle);
+            continue;
+        }
+        bindTexture(state, run->TextureId, true);
+        // not part of QOpenGLExtraFunctions (ES has no multi draw), call the desktop entry point
+        ::glMultiDrawElementsIndirect(GL_TRIANGLES, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (const GLvoid*)(run->FirstCmd * sizeof(ImDrawIndirectCmd)), run->CmdCount, 0);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void ImGuiRenderer::setFontAlpha8(bool enable)
+{
+    if (enable == m_fontAlpha8)
+        return;
+    m_fontAlpha8 = enable;
+    if (g_FontTexture)
+    {
+        // needs the context current, the atlas pixels are rebuilt as they were freed after the first upload
+        glDeleteTextures(1, &g_FontTexture);
+        ImGui::GetIO().Fonts->TexID = 0;
+        g_FontTexture = 0;
+        createFontsTexture();
+        GLStateCache::instance()->invalidate(GLStateCache::TEXTURE);
+    }
+}
+
+void ImGuiRenderer::setFontDistanceField(bool enable)
+{
+    // the frame being built still looks glyphs up in the current atlas, the next newFrame rebuilds it
+    m_fontDistanceFieldRequest = enable ? 1 : 0;
+}
+
+void ImGuiRenderer::updateFontDistanceField()
+{
+    ImFontAtlas *atlas = ImGui::GetIO().Fonts;
+    const int request = m_fontDistanceFieldRequest;
+    m_fontDistanceFieldRequest = -1;
+    if (request < 0 || (request != 0) == atlas->TexDistanceField)
+        return;
+    atlas->TexDistanceField = request != 0;
+    // the pixels may still be around for glyphs on demand, without them createFontsTexture builds the atlas again
+    atlas->ClearTexData();
+    if (g_FontTexture)
+    {
+        glDeleteTextures(1, &g_FontTexture);
+        atlas->TexID = 0;
+        g_FontTexture = 0;
+        createFontsTexture();
+        GLStateCache::instance()->invalidate(GLStateCache::TEXTURE);
+    }
+}
+
+bool ImGuiRenderer::setMultiDrawIndirect(bool enable)
+{
+    m_useIndirect = enable && m_indirectSupported;
+    return m_useIndirect;
+}
+
 void ImGuiRenderer::renderDrawList(ImDrawData *draw_data)
 {
     // Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer coordinates)
@@ -70,93 +214,334 @@ void ImGuiRenderer::renderDrawList(ImDrawData *draw_data)
     if (fb_width == 0 || fb_height == 0)
         return;
     draw_data->ScaleClipRects(io.DisplayFramebufferScale);
+    // a deferred frame nobody drew (nothing changed) still holds its segment
+    if (m_framePending)
+        finishFrame();
+    m_fullDamage = fb_width != m_fbWidth || fb_height != m_fbHeight;
+    m_fbWidth = fb_width;
+    m_fbHeight = fb_height;
+
+    // Setup render state, the scene asks the same cache for its own state so nothing needs to be queried, backed up or restored here
+    GLStateCache *state = GLStateCache::instance();
+    setupRenderState(state, fb_width, fb_height, m_useIndirect);
+    state->bindArrayBuffer(g_VboHandle);
+
+    // Grow the buffers if this frame does not fit in a segment, then wait until the GPU has finished with the segment we reuse
+    if (draw_data->TotalVtxCount > m_ringVtxCapacity || draw_data->TotalIdxCount > m_ringIdxCapacity)
+    {
+        int vtx_capacity = m_ringVtxCapacity > 0 ? m_ringVtxCapacity : 64 * 1024;
+        int idx_capacity = m_ringIdxCapacity > 0 ? m_ringIdxCapacity : 128 * 1024;
+        while (vtx_capacity < draw_data->TotalVtxCount) vtx_capacity *= 2;
+        while (idx_capacity < draw_data->TotalIdxCount) idx_capacity *= 2;
+        resizeRingBuffers(vtx_capacity, idx_capacity);
+        // the cache forgot where the lists of the last frame were
+        m_fullDamage = true;
+    }
+    waitRingFence(m_ringFrame);
 
-    // Backup GL state
-    GLint last_active_texture; glGetIntegerv(GL_ACTIVE_TEXTURE, &last_active_texture);
-    glActiveTexture(GL_TEXTURE0);
-    GLint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
-    GLint last_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
-    GLint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
-    GLint last_element_array_buffer; glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &last_element_array_buffer);
-    GLint last_vertex_array; glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array);
-    GLint last_blend_src_rgb; glGetIntegerv(GL_BLEND_SRC_RGB, &last_blend_src_rgb);
-    GLint last_blend_dst_rgb; glGetIntegerv(GL_BLEND_DST_RGB, &last_blend_dst_rgb);
-    GLint last_blend_src_alpha; glGetIntegerv(GL_BLEND_SRC_ALPHA, &last_blend_src_alpha);
-    GLint last_blend_dst_alpha; glGetIntegerv(GL_BLEND_DST_ALPHA, &last_blend_dst_alpha);
-    GLint last_blend_equation_rgb; glGetIntegerv(GL_BLEND_EQUATION_RGB, &last_blend_equation_rgb);
-    GLint last_blend_equation_alpha; glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &last_blend_equation_alpha);
-    GLint last_viewport[4]; glGetIntegerv(GL_VIEWPORT, last_viewport);
-    GLint last_scissor_box[4]; glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box);
-    GLboolean last_enable_blend = glIsEnabled(GL_BLEND);
-    GLboolean last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
-    GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
-
-    // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled
-    glEnable(GL_BLEND);
-    glBlendEquation(GL_FUNC_ADD);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_SCISSOR_TEST);
-
-    // Setup viewport, orthographic projection matrix
-    glViewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height);
-    const float ortho_projection[4][4] =
+    // Work out which lists changed since last frame, only those are uploaded, the rest is drawn from where it already is
+    const int vtx_base = m_ringFrame * m_ringVtxCapacity;
+    const int idx_base = m_ringFrame * m_ringIdxCapacity;
+    if (m_listCache.Update(draw_data, io.DisplayFramebufferScale, vtx_base, idx_base, RingFrames * m_ringVtxCapacity, RingFrames * m_ringIdxCapacity, m_ringVtxCapacity, m_ringIdxCapacity, m_listSlots, &m_listCacheStats))
     {
-        { 2.0f/io.DisplaySize.x, 0.0f,                   0.0f, 0.0f },
-        { 0.0f,                  2.0f/-io.DisplaySize.y, 0.0f, 0.0f },
-        { 0.0f,                  0.0f,                  -1.0f, 0.0f },
-        {-1.0f,                  1.0f,                   0.0f, 1.0f },
-    };
-    glUseProgram(g_ShaderHandle);
-    glUniform1i(g_AttribLocationTex, 0);
-    glUniformMatrix4fv(g_AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
-    glBindVertexArray(g_VaoHandle);
+        // the resident region is being recycled, nothing drawn from it may still be in flight
+        for (int i = 0; i < RingFrames; i++)
+            waitRingFence(i);
+    }
+    uploadDrawData(draw_data, vtx_base, idx_base);
 
-    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    // Compact the commands first, this drops redundant texture binds / scissors and merges draws with identical state
+    ImDrawCompactCommands(draw_data, fb_height, m_compactCmds, &m_drawStats, m_listSlots.Data);
+    if (m_deferRender)
     {
-        const ImDrawList* cmd_list = draw_data->CmdLists[n];
-        const ImDrawIdx* idx_buffer_offset = 0;
+        // user callbacks can draw anywhere
+        for (const ImDrawCompactCmd* cmd = m_compactCmds.begin(); cmd != m_compactCmds.end() && !m_fullDamage; cmd++)
+            m_fullDamage = cmd->UserCmd != nullptr;
+        m_framePending = true;
+        return;
+    }
+    drawFrame(state, nullptr);
+}
+
+void ImGuiRenderer::drawFrame(GLStateCache *state, const int *clip_rect)
+{
+    GPUTimer* timer = GPUTimer::instance();
+    if (!m_useLayer)
+    {
+        renderCommands(state, m_fbWidth, m_fbHeight, clip_rect);
+    }
+    else
+    {
+        timer->begin("UI layer");
+        renderLayer(state, m_fbWidth, m_fbHeight);
+        timer->begin("UI composite");
+        compositeLayer(state, m_fbWidth, m_fbHeight, clip_rect);
+    }
+    timer->end();
+    finishFrame();
+}
 
-        glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
-        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
+void ImGuiRenderer::finishFrame()
+{
+    m_ringFences[m_ringFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_ringFrame = (m_ringFrame + 1) % RingFrames;
+    m_framePending = false;
+}
+
+void ImGuiRenderer::setDeferredRender(bool enable)
+{
+    if (!enable && m_framePending)
+        finishFrame();
+    m_deferRender = enable;
+}
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+bool ImGuiRenderer::frameDamage(int out_rect[4]) const
+{
+    if (!m_framePending)
+        return false;
+    if (!m_fullDamage)
+        return m_listCache.DamageScissor(m_fbWidth, m_fbHeight, out_rect);
+    out_rect[0] = out_rect[1] = 0;
+    out_rect[2] = m_fbWidth;
+    out_rect[3] = m_fbHeight;
+    return true;
+}
+
+void ImGuiRenderer::renderFrame(const int *clip_rect)
+{
+    if (!m_framePending)
+        return;
+    // whatever was drawn since ImGui::Render() went through the state cache, so only the UI state needs setting again
+    GLStateCache *state = GLStateCache::instance();
+    setupRenderState(state, m_fbWidth, m_fbHeight, m_useIndirect);
+    state->bindArrayBuffer(g_VboHandle);
+    drawFrame(state, clip_rect);
+}
 
-        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+void ImGuiRenderer::renderCommands(GLStateCache *state, int fb_width, int fb_height, const int *clip_rect)
+{
+    // Draw the compacted commands of the frame, render state has to be set up. clip_rect (glScissor x, y, w, h) limits
+    // drawing to part of the framebuffer, commands outside it are skipped
+    if (m_useIndirect)
+    {
+        // the shader clips each draw, the scissor only has to hold the region
+        if (clip_rect)
+        {
+            state->enableScissorTest(true);
+            state->scissor(clip_rect[0], clip_rect[1], clip_rect[2], clip_rect[3]);
+        }
+        // runs cross list boundaries, the layer pass times itself
+        if (!m_layerPass)
+            GPUTimer::instance()->begin("UI");
+        renderIndirect(state, fb_width, fb_height);
+    }
+    else if (clip_rect)
+    {
+        if (!m_layerPass)
+            GPUTimer::instance()->begin("UI");
+        // skipped commands may have been the ones binding a texture, so let the state cache drop the redundant binds
+        for (const ImDrawCompactCmd* cmd = m_compactCmds.begin(); cmd != m_compactCmds.end(); cmd++)
         {
-            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
-            if (pcmd->UserCallback)
+            const int x1 = std::max(cmd->ClipRect[0], clip_rect[0]);
+            const int y1 = std::max(cmd->ClipRect[1], clip_rect[1]);
+            const int x2 = std::min(cmd->ClipRect[0] + cmd->ClipRect[2], clip_rect[0] + clip_rect[2]);
+            const int y2 = std::min(cmd->ClipRect[1] + cmd->ClipRect[3], clip_rect[1] + clip_rect[3]);
+            if (cmd->UserCmd || x1 >= x2 || y1 >= y2)
+                continue;
+            bindTexture(state, cmd->TextureId, false);
+            state->scissor(x1, y1, x2 - x1, y2 - y1);
+            glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)cmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (const ImDrawIdx*)0 + cmd->IdxOffset, cmd->VtxOffset);
+        }
+    }
+    else
+    {
+        // one timer section per list (draws never merge across lists), the layer pass times itself
+        GPUTimer* timer = GPUTimer::instance();
+        const bool time_lists = timer->isEnabled() && !m_layerPass;
+        const ImDrawList* timed_list = nullptr;
+        for (const ImDrawCompactCmd* cmd = m_compactCmds.begin(); cmd != m_compactCmds.end(); cmd++)
+        {
+            if (time_lists && cmd->CmdList != timed_list)
             {
-                pcmd->UserCallback(cmd_list, pcmd);
+                timed_list = cmd->CmdList;
+                timer->begin(timed_list->_OwnerName ? timed_list->_OwnerName : "UI");
             }
-            else
+            if (cmd->UserCmd)
             {
-                glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->TextureId);
-                glScissor((int)pcmd->ClipRect.x, (int)(fb_height - pcmd->ClipRect.w), (int)(pcmd->ClipRect.z - pcmd->ClipRect.x), (int)(pcmd->ClipRect.w - pcmd->ClipRect.y));
-                glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, idx_buffer_offset);
+                cmd->UserCmd->UserCallback(cmd->CmdList, cmd->UserCmd);
+                // we have no idea what the callback did to GL
+                state->invalidate();
+                setupRenderState(state, fb_width, fb_height, false);
+                state->bindArrayBuffer(g_VboHandle);
+                continue;
             }
-            idx_buffer_offset += pcmd->ElemCount;
+            if (cmd->BindTexture)
+                bindTexture(state, cmd->TextureId, false);
+            if (cmd->SetScissor)
+                state->scissor(cmd->ClipRect[0], cmd->ClipRect[1], cmd->ClipRect[2], cmd->ClipRect[3]);
+            glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)cmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (const ImDrawIdx*)0 + cmd->IdxOffset, cmd->VtxOffset);
         }
     }
+}
+
+void ImGuiRenderer::createLayer(int fb_width, int fb_height)
+{
+    // (Re)create the layer texture / FBO at framebuffer size
+    if (!m_layerFbo)
+    {
+        glGenFramebuffers(1, &m_layerFbo);
+        glGenTextures(1, &m_layerTexture);
+    }
+    GLStateCache::instance()->bindTexture2D(m_layerTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, fb_width, fb_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    GLint last_framebuffer;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &last_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_layerFbo);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_layerTexture, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, last_framebuffer);
+    m_layerWidth = fb_width;
+    m_layerHeight = fb_height;
+    m_layerValid = false;
+}
 
-    // Restore modified GL state
-    glUseProgram(last_program);
-    glBindTexture(GL_TEXTURE_2D, last_texture);
-    glActiveTexture(last_active_texture);
-    glBindVertexArray(last_vertex_array);
-    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, last_element_array_buffer);
-    glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-    glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha);
-    if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-    if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-    if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-    if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
-    glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
-    glScissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]);
+void ImGuiRenderer::renderLayer(GLStateCache *state, int fb_width, int fb_height)
+{
+    // Redraw the part of the layer covered by the windows that changed, the whole layer when it is new or a user
+    // callback (which can draw anything) is present
+    if (fb_width != m_layerWidth || fb_height != m_layerHeight)
+        createLayer(fb_width, fb_height);
+    if (m_layerValid && m_listCache.FrameHash == m_layerHash)
+        return;
+    bool full = !m_layerValid;
+    for (const ImDrawCompactCmd* cmd = m_compactCmds.begin(); cmd != m_compactCmds.end() && !full; cmd++)
+        full = cmd->UserCmd != nullptr;
+    int damage[4] = { 0, 0, fb_width, fb_height };
+    if (!full && !m_listCache.DamageScissor(fb_width, fb_height, damage))
+        full = true;
+
+    // only paid when the UI changes, QOpenGLWindow may not render to framebuffer 0 so ask what is bound
+    GLint last_framebuffer;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &last_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_layerFbo);
+    state->enableScissorTest(!full);
+    if (!full)
+        state->scissor(damage[0], damage[1], damage[2], damage[3]);
+    const GLfloat transparent[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, transparent);
+    m_layerPass = true;
+    setupRenderState(state, fb_width, fb_height, m_useIndirect);
+    state->bindArrayBuffer(g_VboHandle);
+    renderCommands(state, fb_width, fb_height, full ? nullptr : damage);
+    m_layerPass = false;
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, last_framebuffer);
+    m_layerHash = m_listCache.FrameHash;
+    m_layerValid = true;
+}
+
+void ImGuiRenderer::compositeLayer(GLStateCache *state, int fb_width, int fb_height, const int *clip_rect)
+{
+    // Blend the premultiplied layer over whatever is in the framebuffer, or only over clip_rect of it
+    state->enableBlend(true);
+    state->blendEquation(GL_FUNC_ADD);
+    state->blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    state->enableScissorTest(clip_rect != nullptr);
+    if (clip_rect)
+        state->scissor(clip_rect[0], clip_rect[1], clip_rect[2], clip_rect[3]);
+    state->viewport(0, 0, fb_width, fb_height);
+    state->useProgram(m_compositeShaderHandle);
+    glUniform1i(m_compositeAttribLocationLayer, 0);
+    state->activeTexture(GL_TEXTURE0);
+    state->bindTexture2D(m_layerTexture);
+    state->bindVertexArray(m_layerVaoHandle);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void ImGuiRenderer::setUiLayer(bool enable)
+{
+    m_useLayer = enable;
+    m_layerValid = false;
+}
+
+void ImGuiRenderer::waitRingFence(int segment)
+{
+    GLsync &fence = m_ringFences[segment];
+    if (!fence)
+        return;
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+        ;
+    glDeleteSync(fence);
+    fence = 0;
+}
+
+void ImGuiRenderer::resizeRingBuffers(int vtx_capacity, int idx_capacity)
+{
+    // Respecifying the storage keeps the buffer names so the VAOs stay valid and the driver keeps the old storage alive
+    // for frames in flight, the old fences and resident lists are meaningless from now on
+    for (int i = 0; i < RingFrames; i++)
+    {
+        if (m_ringFences[i])
+            glDeleteSync(m_ringFences[i]);
+        m_ringFences[i] = 0;
+    }
+    m_ringVtxCapacity = vtx_capacity;
+    m_ringIdxCapacity = idx_capacity;
+    m_ringFrame = 0;
+    m_listCache.Clear();
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(RingFrames + 1) * vtx_capacity * sizeof(ImDrawVertLayout::Vert), nullptr, GL_STREAM_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(RingFrames + 1) * idx_capacity * sizeof(ImDrawIdx), nullptr, GL_STREAM_DRAW);
+}
+
+void ImGuiRenderer::uploadDrawData(ImDrawData *draw_data, int vtx_base, int idx_base)
+{
+    // Changed lists go to the current segment with one unsynchronized map, newly resident ones to the resident region
+    // which only ever takes writes into space no frame in flight uses
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    const int resident_vtx_base = RingFrames * m_ringVtxCapacity;
+    // each buffer is mapped on its own, only when this frame streams something into it
+    char* vtx_dst = nullptr;
+    char* idx_dst = nullptr;
+    if (m_listCache.StreamVtxCount > 0)
+        vtx_dst = (char*)glMapBufferRange(GL_ARRAY_BUFFER, (GLintptr)vtx_base * sizeof(ImDrawVertLayout::Vert), (GLsizeiptr)m_listCache.StreamVtxCount * sizeof(ImDrawVertLayout::Vert), access);
+    if (m_listCache.StreamIdxCount > 0)
+        idx_dst = (char*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)idx_base * sizeof(ImDrawIdx), (GLsizeiptr)m_listCache.StreamIdxCount * sizeof(ImDrawIdx), access);
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawListSlot &slot = m_listSlots[n];
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        if (!slot.Upload || slot.VtxOffset >= resident_vtx_base)
+            continue;
+        if (cmd_list->VtxBuffer.Size > 0 && vtx_dst)
+            ImDrawVertWrite<ImDrawVertLayout>(vtx_dst + (GLintptr)(slot.VtxOffset - vtx_base) * sizeof(ImDrawVertLayout::Vert), cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size);
+        if (cmd_list->IdxBuffer.Size > 0 && idx_dst)
+            memcpy(idx_dst + (GLintptr)(slot.IdxOffset - idx_base) * sizeof(ImDrawIdx), cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+    }
+    if (vtx_dst)
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    if (idx_dst)
+        glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+
+    // Promotions are rare so each gets its own map
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawListSlot &slot = m_listSlots[n];
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        if (!slot.Upload || slot.VtxOffset < resident_vtx_base)
+            continue;
+        const GLsizeiptr vtx_size = (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVertLayout::Vert);
+        const GLsizeiptr idx_size = (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
+        if (vtx_size > 0)
+        {
+            ImDrawVertWrite<ImDrawVertLayout>(glMapBufferRange(GL_ARRAY_BUFFER, (GLintptr)slot.VtxOffset * sizeof(ImDrawVertLayout::Vert), vtx_size, access), cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        if (idx_size > 0)
+        {
+            memcpy(glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)slot.IdxOffset * sizeof(ImDrawIdx), idx_size, access), cmd_list->IdxBuffer.Data, idx_size);
+            glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+        }
+    }
 }
 
 bool ImGuiRenderer::createFontsTexture()
@@ -165,7 +550,10 @@ bool ImGuiRenderer::createFontsTexture()
     ImGuiIO& io = ImGui::GetIO();
     unsigned char* pixels;
     int width, height;
-    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);   // Load as RGBA 32-bits (75% of the memory is wasted, but default font is so small) because it is more likely to be compatible with user's existing shaders. If your ImTextureId represent a higher-level concept than just a GL texture id, consider calling GetTexDataAsAlpha8() instead to save on GPU memory.
+    if (m_fontAlpha8)
+        io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+    else
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);   // Load as RGBA 32-bits (75% of the memory is wasted, but default font is so small) because it is more likely to be compatible with user's existing shaders.
 
     // Upload texture to graphics system
     GLint last_texture;
@@ -174,10 +562,27 @@ bool ImGuiRenderer::createFontsTexture()
     glBindTexture(GL_TEXTURE_2D, g_FontTexture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    if (m_fontAlpha8)
+    {
+        // A quarter of the memory, the swizzle makes the red channel read back as (1,1,1,alpha) so the shader is unchanged
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_ONE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_ONE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_ONE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    else
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
 
-    // Store our identifier
+    // Store our identifier, the GPU has its copy so the CPU side pixels can go unless glyphs on demand are rendered into them later
     io.Fonts->TexID = (void *)(intptr_t)g_FontTexture;
+    m_fontDistanceField = io.Fonts->TexDistanceField;
+    if (!io.Fonts->HasGlyphsOnDemand())
+        io.Fonts->ClearTexData();
 
     // Restore state
     glBindTexture(GL_TEXTURE_2D, last_texture);
@@ -185,6 +590,41 @@ bool ImGuiRenderer::createFontsTexture()
     return true;
 }
 
+void ImGuiRenderer::uploadFontRect(int x, int y, int width, int height)
+{
+    // the atlas keeps both of its copies up to date, the rectangle is uploaded straight from whichever the texture was made from
+    ImFontAtlas *atlas = ImGui::GetIO().Fonts;
+    GLStateCache *state = GLStateCache::instance();
+    state->activeTexture(GL_TEXTURE0);
+    state->bindTexture2D(g_FontTexture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, atlas->TexWidth);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (m_fontAlpha8)
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RED, GL_UNSIGNED_BYTE, atlas->TexPixelsAlpha8 + y * atlas->TexWidth + x);
+    else
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, atlas->TexPixelsRGBA32 + y * atlas->TexWidth + x);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+// The ring buffers hold ImDrawVertLayout vertices (imconfig.h), not ImDrawVert
+void ImGuiRenderer::setupVertexAttribs(GLuint pos_location, GLuint uv_location, GLuint col_location)
+{
+    const GLuint locations[3] = { pos_location, uv_location, col_location };
+    const ImDrawVertAttrib* attribs = ImDrawVertLayout::Attribs();
+    for (int n = 0; n < 3; n++)
+    {
+        GLenum type = GL_FLOAT;
+        switch (attribs[n].Type)
+        {
+        case ImDrawVertAttribType_Short:            type = GL_SHORT; break;
+        case ImDrawVertAttribType_UnsignedShort:    type = GL_UNSIGNED_SHORT; break;
+        case ImDrawVertAttribType_UnsignedByte:     type = GL_UNSIGNED_BYTE; break;
+        }
+        glVertexAttribPointer(locations[n], attribs[n].Components, type, attribs[n].Normalized ? GL_TRUE : GL_FALSE, sizeof(ImDrawVertLayout::Vert), (GLvoid*)(size_t)attribs[n].Offset);
+    }
+}
+
 bool ImGuiRenderer::createDeviceObjects()
 {
     // Backup GL state
@@ -219,6 +659,23 @@ bool ImGuiRenderer::createDeviceObjects()
         "	Out_Color = Frag_Color * texture( Texture, Frag_UV.st);\n"
         "}\n";
 
+    // variant for a distance field font atlas (ImFontAtlas::TexDistanceField), 128 is the alpha on a glyph outline and
+    // the change of the distance across one pixel keeps the edge a pixel wide at any font scale. The white pixel and
+    // the mouse cursors are flat and come out fully opaque or transparent
+    const GLchar* sdf_fragment_shader =
+        "#version 330\n"
+        "uniform sampler2D Texture;\n"
+        "in vec2 Frag_UV;\n"
+        "in vec4 Frag_Color;\n"
+        "out vec4 Out_Color;\n"
+        "void main()\n"
+        "{\n"
+        "	vec4 texel = texture( Texture, Frag_UV.st);\n"
+        "	float width = max(fwidth(texel.a), 1e-4);\n"
+        "	texel.a = clamp((texel.a - 128.0/255.0) / width + 0.5, 0.0, 1.0);\n"
+        "	Out_Color = Frag_Color * texel;\n"
+        "}\n";
+
     g_ShaderHandle = glCreateProgram();
     g_VertHandle = glCreateShader(GL_VERTEX_SHADER);
     g_FragHandle = glCreateShader(GL_FRAGMENT_SHADER);
@@ -236,32 +693,181 @@ bool ImGuiRenderer::createDeviceObjects()
     g_AttribLocationUV = glGetAttribLocation(g_ShaderHandle, "UV");
     g_AttribLocationColor = glGetAttribLocation(g_ShaderHandle, "Color");
 
+    // shares the vertex shader, linked up front as the atlas can be switched to distance fields at any time
+    g_SdfShaderHandle = glCreateProgram();
+    g_SdfFragHandle = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(g_SdfFragHandle, 1, &sdf_fragment_shader, 0);
+    glCompileShader(g_SdfFragHandle);
+    glAttachShader(g_SdfShaderHandle, g_VertHandle);
+    glAttachShader(g_SdfShaderHandle, g_SdfFragHandle);
+    glBindAttribLocation(g_SdfShaderHandle, g_AttribLocationPosition, "Position");
+    glBindAttribLocation(g_SdfShaderHandle, g_AttribLocationUV, "UV");
+    glBindAttribLocation(g_SdfShaderHandle, g_AttribLocationColor, "Color");
+    glLinkProgram(g_SdfShaderHandle);
+    g_SdfAttribLocationTex = glGetUniformLocation(g_SdfShaderHandle, "Texture");
+    g_SdfAttribLocationProjMtx = glGetUniformLocation(g_SdfShaderHandle, "ProjMtx");
+
     glGenBuffers(1, &g_VboHandle);
     glGenBuffers(1, &g_ElementsHandle);
 
     glGenVertexArrays(1, &g_VaoHandle);
     glBindVertexArray(g_VaoHandle);
     glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
     glEnableVertexAttribArray(g_AttribLocationPosition);
     glEnableVertexAttribArray(g_AttribLocationUV);
     glEnableVertexAttribArray(g_AttribLocationColor);
 
-#define OFFSETOF(TYPE, ELEMENT) ((size_t)&(((TYPE *)0)->ELEMENT))
-    glVertexAttribPointer(g_AttribLocationPosition, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, pos));
-    glVertexAttribPointer(g_AttribLocationUV, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, uv));
-    glVertexAttribPointer(g_AttribLocationColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, col));
-#undef OFFSETOF
+    setupVertexAttribs(g_AttribLocationPosition, g_AttribLocationUV, g_AttribLocationColor);
 
     createFontsTexture();
 
+    // full-screen triangle used to composite the cached UI layer, the vertices come from gl_VertexID so its VAO stays empty
+    const GLchar *composite_vertex_shader =
+        "#version 330\n"
+        "void main()\n"
+        "{\n"
+        "	vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+        "	gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);\n"
+        "}\n";
+
+    const GLchar *composite_fragment_shader =
+        "#version 330\n"
+        "uniform sampler2D Layer;\n"
+        "out vec4 Out_Color;\n"
+        "void main()\n"
+        "{\n"
+        "	Out_Color = texelFetch(Layer, ivec2(gl_FragCoord.xy), 0);\n"
+        "}\n";
+
+    m_compositeShaderHandle = glCreateProgram();
+    GLuint composite_vert = glCreateShader(GL_VERTEX_SHADER);
+    GLuint composite_frag = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(composite_vert, 1, &composite_vertex_shader, 0);
+    glShaderSource(composite_frag, 1, &composite_fragment_shader, 0);
+    glCompileShader(composite_vert);
+    glCompileShader(composite_frag);
+    glAttachShader(m_compositeShaderHandle, composite_vert);
+    glAttachShader(m_compositeShaderHandle, composite_frag);
+    glLinkProgram(m_compositeShaderHandle);
+    // the program keeps them alive
+    glDeleteShader(composite_vert);
+    glDeleteShader(composite_frag);
+    m_compositeAttribLocationLayer = glGetUniformLocation(m_compositeShaderHandle, "Layer");
+    glGenVertexArrays(1, &m_layerVaoHandle);
+
+    // the multi-draw-indirect path needs a desktop GL 4.3 context
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    m_indirectSupported = !context->isOpenGLES() && context->format().version() >= qMakePair(4, 3);
+    if (m_indirectSupported)
+        createIndirectObjects();
+
     // Restore modified GL state
     glBindTexture(GL_TEXTURE_2D, last_texture);
     glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
     glBindVertexArray(last_vertex_array);
+    GLStateCache::instance()->invalidate(GLStateCache::VERTEX_ARRAY);
 
     return true;
 }
 
+void ImGuiRenderer::createIndirectObjects()
+{
+    // Same as the regular program plus a per draw clip rect replacing glScissor, the attribute locations are fixed so
+    // the VAO below doesn't need to query them
+    const GLchar *vertex_shader =
+        "#version 430\n"
+        "uniform mat4 ProjMtx;\n"
+        "layout (location = 0) in vec2 Position;\n"
+        "layout (location = 1) in vec2 UV;\n"
+        "layout (location = 2) in vec4 Color;\n"
+        "layout (location = 3) in vec4 ClipRect;\n"
+        "out vec2 Frag_UV;\n"
+        "out vec4 Frag_Color;\n"
+        "flat out vec4 Frag_ClipRect;\n"
+        "void main()\n"
+        "{\n"
+        "	Frag_UV = UV;\n"
+        "	Frag_Color = Color;\n"
+        "	Frag_ClipRect = ClipRect;\n"
+        "	gl_Position = ProjMtx * vec4(Position.xy,0,1);\n"
+        "}\n";
+
+    const GLchar* fragment_shader =
+        "#version 430\n"
+        "uniform sampler2D Texture;\n"
+        "in vec2 Frag_UV;\n"
+        "in vec4 Frag_Color;\n"
+        "flat in vec4 Frag_ClipRect;\n"
+        "out vec4 Out_Color;\n"
+        "void main()\n"
+        "{\n"
+        "	if (any(lessThan(gl_FragCoord.xy, Frag_ClipRect.xy)) || any(greaterThanEqual(gl_FragCoord.xy, Frag_ClipRect.xy + Frag_ClipRect.zw)))\n"
+        "		discard;\n"
+        "	Out_Color = Frag_Color * texture( Texture, Frag_UV.st);\n"
+        "}\n";
+
+    // distance field variant, the derivatives are taken before the discard as they are undefined once a neighbour of
+    // the quad has been discarded
+    const GLchar* sdf_fragment_shader =
+        "#version 430\n"
+        "uniform sampler2D Texture;\n"
+        "in vec2 Frag_UV;\n"
+        "in vec4 Frag_Color;\n"
+        "flat in vec4 Frag_ClipRect;\n"
+        "out vec4 Out_Color;\n"
+        "void main()\n"
+        "{\n"
+        "	vec4 texel = texture( Texture, Frag_UV.st);\n"
+        "	float width = max(fwidth(texel.a), 1e-4);\n"
+        "	if (any(lessThan(gl_FragCoord.xy, Frag_ClipRect.xy)) || any(greaterThanEqual(gl_FragCoord.xy, Frag_ClipRect.xy + Frag_ClipRect.zw)))\n"
+        "		discard;\n"
+        "	texel.a = clamp((texel.a - 128.0/255.0) / width + 0.5, 0.0, 1.0);\n"
+        "	Out_Color = Frag_Color * texel;\n"
+        "}\n";
+
+    g_IndirectShaderHandle = glCreateProgram();
+    g_IndirectVertHandle = glCreateShader(GL_VERTEX_SHADER);
+    g_IndirectFragHandle = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(g_IndirectVertHandle, 1, &vertex_shader, 0);
+    glShaderSource(g_IndirectFragHandle, 1, &fragment_shader, 0);
+    glCompileShader(g_IndirectVertHandle);
+    glCompileShader(g_IndirectFragHandle);
+    glAttachShader(g_IndirectShaderHandle, g_IndirectVertHandle);
+    glAttachShader(g_IndirectShaderHandle, g_IndirectFragHandle);
+    glLinkProgram(g_IndirectShaderHandle);
+
+    g_IndirectAttribLocationTex = glGetUniformLocation(g_IndirectShaderHandle, "Texture");
+    g_IndirectAttribLocationProjMtx = glGetUniformLocation(g_IndirectShaderHandle, "ProjMtx");
+
+    g_IndirectSdfShaderHandle = glCreateProgram();
+    g_IndirectSdfFragHandle = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(g_IndirectSdfFragHandle, 1, &sdf_fragment_shader, 0);
+    glCompileShader(g_IndirectSdfFragHandle);
+    glAttachShader(g_IndirectSdfShaderHandle, g_IndirectVertHandle);
+    glAttachShader(g_IndirectSdfShaderHandle, g_IndirectSdfFragHandle);
+    glLinkProgram(g_IndirectSdfShaderHandle);
+    g_IndirectSdfAttribLocationTex = glGetUniformLocation(g_IndirectSdfShaderHandle, "Texture");
+    g_IndirectSdfAttribLocationProjMtx = glGetUniformLocation(g_IndirectSdfShaderHandle, "ProjMtx");
+
+    glGenBuffers(1, &g_IndirectHandle);
+    glGenBuffers(1, &g_ClipRectHandle);
+
+    glGenVertexArrays(1, &g_IndirectVaoHandle);
+    glBindVertexArray(g_IndirectVaoHandle);
+    glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glEnableVertexAttribArray(3);
+
+    setupVertexAttribs(0, 1, 2);
+    glBindBuffer(GL_ARRAY_BUFFER, g_ClipRectHandle);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(ImVec4), (GLvoid*)0);
+    glVertexAttribDivisor(3, 1);
+}
+
 void ImGuiRenderer::newFrame()
 {
     if (!g_FontTexture)
@@ -301,6 +907,14 @@ void ImGuiRenderer::newFrame()
     // Hide OS mouse cursor if ImGui is drawing it
     // glfwSetInputMode(g_Window, GLFW_CURSOR, io.MouseDrawCursor ? GLFW_CURSOR_HIDDEN : GLFW_CURSOR_NORMAL);
 
+    // Switch the atlas between two frames so no text of the frame is laid out with the other one's glyphs
+    updateFontDistanceField();
+
+    // Render the glyphs the last frame drew with the fallback, the context is current so they go straight into the texture
+    int x, y, width, height;
+    if (io.Fonts->UpdateGlyphsOnDemand(&x, &y, &width, &height))
+        uploadFontRect(x, y, width, height);
+
     // Start the frame
     ImGui::NewFrame();
 }
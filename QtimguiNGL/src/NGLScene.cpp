@@ -1,4 +1,7 @@
 #include "NGLScene.h"
+#include "GLStateCache.h"
+#include "GPUTimer.h"
+#include "ProgramCache.h"
 #include <QMouseEvent>
 #include <QGuiApplication>
 
@@ -9,6 +12,8 @@
 #include <ngl/Transformation.h>
 #include <QtImGui.h>
 #include <imgui.h>
+#include <ImDrawCompact.h>
+#include <ImDrawListCache.h>
 
 extern bool ColorSelector(const char* pLabel, ngl::Vec4& oRGBA);
 
@@ -21,7 +26,8 @@ const static float INCREMENT=0.01f;
 //----------------------------------------------------------------------------------------------------------------------
 const static float ZOOM=0.1f;
 
-NGLScene::NGLScene()
+// render into an FBO that keeps the last frame, paintGL then only redraws what changed
+NGLScene::NGLScene() : QOpenGLWindow(QOpenGLWindow::PartialUpdateBlit)
 {
   // re-size the widget to that of the parent (in that case the GLFrame passed in on construction)
   m_rotate=false;
@@ -44,12 +50,14 @@ void NGLScene::resizeGL(int _w , int _h)
   m_cam.setShape(45.0f,static_cast<float>(_w)/_h,0.05f,350.0f);
   m_width=static_cast<int>(_w*devicePixelRatio());
   m_height=static_cast<int>(_h*devicePixelRatio());
+  // the FBO holding the last frame is recreated at the new size
+  m_sceneChanged=true;
 }
 
 void NGLScene::setLight(const ngl::Vec4 &_position,const ngl::Vec4 &_ambient,const ngl::Vec4 &_specular,const ngl::Vec4 &_diffuse )
 {
   ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-  shader->use("Phong");
+  GLStateCache::instance()->useProgram("Phong");
   shader->setUniform("light.position",_position);
   shader->setUniform("light.ambient",_ambient);
   shader->setUniform("light.specular",_specular);
@@ -60,7 +68,7 @@ void NGLScene::setLight(const ngl::Vec4 &_position,const ngl::Vec4 &_ambient,con
 void NGLScene::setMaterial(const ngl::Vec4 &_ambient,const ngl::Vec4 &_specular,const ngl::Vec4 &_diffuse, float _specPower )
 {
   ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-  shader->use("Phong");
+  GLStateCache::instance()->useProgram("Phong");
   shader->setUniform("material.ambient",_ambient);
   shader->setUniform("material.specular",_specular);
   shader->setUniform("material.diffuse",_diffuse);
@@ -70,45 +78,27 @@ void NGLScene::setMaterial(const ngl::Vec4 &_ambient,const ngl::Vec4 &_specular,
 void NGLScene::initializeGL()
 {
   QtImGui::initialize(this);
+  // ImGui::Render() only uploads the UI, paintGL draws it once it knows what else has to be redrawn
+  QtImGui::setDeferredRender(true);
 
   // we must call that first before any other GL commands to load and link the
   // gl commands from the lib, if that is not done program will crash
   ngl::NGLInit::instance();
   glClearColor(0.4f, 0.4f, 0.4f, 1.0f);			   // Grey Background
-  // enable depth testing for drawing
-  glEnable(GL_DEPTH_TEST);
+  // enable depth testing for drawing, all state goes through the cache shared with the ImGui renderer
+  GLStateCache *state=GLStateCache::instance();
+  state->enableDepthTest(true);
   // enable multisampling for smoother drawing
 #ifndef USINGIOS_
   glEnable(GL_MULTISAMPLE);
 #endif
-   // now to load the shader and set the values
-  // grab an instance of shader manager
-  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-  // we are creating a shader called Phong to save typos
-  // in the code create some constexpr
+  // load the shader from the binary cache, or compile and link it when the cache is stale
   constexpr auto shaderProgram="Phong";
-  constexpr auto vertexShader="PhongVertex";
-  constexpr auto fragShader="PhongFragment";
-  // create the shader program
-  shader->createShaderProgram(shaderProgram);
-  // now we are going to create empty shaders for Frag and Vert
-  shader->attachShader(vertexShader,ngl::ShaderType::VERTEX);
-  shader->attachShader(fragShader,ngl::ShaderType::FRAGMENT);
-  // attach the source
-  shader->loadShaderSource(vertexShader,"shaders/PhongVertex.glsl");
-  shader->loadShaderSource(fragShader,"shaders/PhongFragment.glsl");
-  // compile the shaders
-  shader->compileShader(vertexShader);
-  shader->compileShader(fragShader);
-  // add them to the program
-  shader->attachShaderToProgram(shaderProgram,vertexShader);
-  shader->attachShaderToProgram(shaderProgram,fragShader);
-
-
-  // now we have associated that data we can link the shader
-  shader->linkProgramObject(shaderProgram);
+  ProgramCache::instance()->loadProgram(shaderProgram,"PhongVertex","shaders/PhongVertex.glsl",
+                                        "PhongFragment","shaders/PhongFragment.glsl");
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
   // and make it active ready to load values
-  (*shader)[shaderProgram]->use();
+  state->useProgram(shaderProgram);
   // the shader will use the currently active material and light0 so set them
   ngl::Material m(ngl::STDMAT::GOLD);
   // load our material values to the shader into the structure material (see Vertex shader)
@@ -147,18 +137,38 @@ void NGLScene::drawIMGUI()
   {
 
       ImGui::Begin("Model");
-      ImGui::SliderFloat3("rotation",m_modelRot.openGL(),-180.0f,180.f);
-      ImGui::SliderFloat3("position",m_modelPosition.openGL(),-10.0f,10.f);
-      ImGui::SliderFloat3("scale",m_modelScale.openGL(),-2.0f,2.f);
+      m_sceneChanged|=ImGui::SliderFloat3("rotation",m_modelRot.openGL(),-180.0f,180.f);
+      m_sceneChanged|=ImGui::SliderFloat3("position",m_modelPosition.openGL(),-10.0f,10.f);
+      m_sceneChanged|=ImGui::SliderFloat3("scale",m_modelScale.openGL(),-2.0f,2.f);
 
       //ImGui::ColorEdit3("clear color", clearColour.openGL());
-      ColorSelector("clear color",m_clearColour);
+      m_sceneChanged|=ColorSelector("clear color",m_clearColour);
       const char* items[]={ "Teapot", "Troll", "Bunny", "Dragon", "Buddah", "Cube" };
-      ImGui::Combo("Model", &m_modelID, items,6);   // Combo using proper array. You can also pass a callback to retrieve array value, no need to create/copy an array just for that.
+      m_sceneChanged|=ImGui::Combo("Model", &m_modelID, items,6);   // Combo using proper array. You can also pass a callback to retrieve array value, no need to create/copy an array just for that.
 
       ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+      ImGui::SameLine();
+      if(ImGui::Checkbox("GPU timings",&showTimings))
+        GPUTimer::instance()->setEnabled(showTimings);
+      const ImDrawCompactStats &drawStats=QtImGui::drawStats();
+      ImGui::Text("UI %d draws for %d commands, %d GL calls saved", drawStats.DrawCalls, drawStats.SourceCmds, drawStats.SavedCalls);
+      const ImDrawListCacheStats &cacheStats=QtImGui::listCacheStats();
+      ImGui::Text("UI lists reused %d/%d (%.0f%%), %d bytes uploaded, %d pixels damaged", cacheStats.Hits, cacheStats.Lists, cacheStats.HitRate()*100.0f, cacheStats.UploadedBytes, cacheStats.DamagedPixels);
+      static bool uiLayer=false;
+      if(ImGui::Checkbox("Cache UI layer",&uiLayer))
+        QtImGui::setUiLayer(uiLayer);
+      static bool multiDrawIndirect=false;
+      if(ImGui::Checkbox("Multi draw indirect",&multiDrawIndirect))
+        multiDrawIndirect=QtImGui::setMultiDrawIndirect(multiDrawIndirect);
+      static bool distanceField=false;
+      if(ImGui::Checkbox("Distance field font",&distanceField))
+        QtImGui::setFontDistanceField(distanceField);
+      ImGui::SameLine();
+      ImGui::SliderFloat("font scale",&ImGui::GetIO().FontGlobalScale,0.5f,4.0f);
       glClearColor(m_clearColour.m_r,m_clearColour.m_g,m_clearColour.m_b,m_clearColour.m_a);
       ImGui::End();
+      if(showTimings)
+        drawTimings();
 
   }
   if(showLightControls)
@@ -168,10 +178,10 @@ void NGLScene::drawIMGUI()
       static ngl::Vec4 specular={1.0f,1.0f,1.0f};
       static ngl::Vec4 diffuse={1.0f,1.0f,1.0f};
       ImGui::Begin("Light");
-      ImGui::SliderFloat3("position",position.openGL(),-10,10);
-      ImGui::ColorEdit3("Ambient", ambient.openGL());
-      ImGui::ColorEdit3("Specular", specular.openGL());
-      ImGui::ColorEdit3("Diffuse", diffuse.openGL());
+      m_sceneChanged|=ImGui::SliderFloat3("position",position.openGL(),-10,10);
+      m_sceneChanged|=ImGui::ColorEdit3("Ambient", ambient.openGL());
+      m_sceneChanged|=ImGui::ColorEdit3("Specular", specular.openGL());
+      m_sceneChanged|=ImGui::ColorEdit3("Diffuse", diffuse.openGL());
       setLight(position,ambient,specular,diffuse);
       ImGui::End();
 
@@ -183,10 +193,10 @@ void NGLScene::drawIMGUI()
       static ngl::Vec4 diffuse={0.75164f,0.60648f,0.22648f};
       static float specPower=51.2f;
       ImGui::Begin("Material");
-      ImGui::ColorEdit3("Ambient", ambient.openGL());
-      ImGui::ColorEdit3("Specular", specular.openGL());
-      ImGui::ColorEdit3("Diffuse", diffuse.openGL());
-      ImGui::SliderFloat("Cos Power", &specPower,0.0f,200.0f);
+      m_sceneChanged|=ImGui::ColorEdit3("Ambient", ambient.openGL());
+      m_sceneChanged|=ImGui::ColorEdit3("Specular", specular.openGL());
+      m_sceneChanged|=ImGui::ColorEdit3("Diffuse", diffuse.openGL());
+      m_sceneChanged|=ImGui::SliderFloat("Cos Power", &specPower,0.0f,200.0f);
       setMaterial(ambient,specular,diffuse,specPower);
 
       ImGui::End();
@@ -196,6 +206,22 @@ void NGLScene::drawIMGUI()
 
 }
 
+void NGLScene::drawTimings()
+{
+  GPUTimer *timer=GPUTimer::instance();
+  ImGui::Begin("Timings",&showTimings,ImGuiWindowFlags_AlwaysAutoResize);
+  const float frameMs=1000.0f/ImGui::GetIO().Framerate;
+  ImGui::Text("frame %.3f ms, GPU %.3f ms (%d frames old)",frameMs,timer->totalMs(),GPUTimer::FrameLatency);
+  // if the GPU work fills most of the frame the CPU ends up waiting for it
+  ImGui::TextUnformatted(timer->totalMs()>0.8f*frameMs ? "GPU bound" : "CPU bound");
+  ImGui::Separator();
+  for(const auto &section : timer->sections())
+    ImGui::Text("%-16s %8.3f ms",section.name.c_str(),section.ms);
+  ImGui::End();
+  if(!showTimings)
+    timer->setEnabled(false);
+}
+
 
 
 void NGLScene::loadMatricesToShader()
@@ -223,13 +249,34 @@ void NGLScene::loadMatricesToShader()
 
 void NGLScene::paintGL()
 {
-  glViewport(0,0,m_width,m_height);
-  // clear the screen and depth buffer
+  // QOpenGLWindow may touch GL state between frames, forgetting is free (no driver queries) and the
+  // requests below then set what the scene needs, the ImGui pass does the same for its own state
+  GLStateCache *state=GLStateCache::instance();
+  GPUTimer *timer=GPUTimer::instance();
+  timer->newFrame();
+  state->invalidate();
+  // the UI decides what the scene looks like this frame, so build (and upload) it first
+  drawIMGUI();
+  // the FBO still holds the last frame, when only the UI changed the scene is redrawn under the damaged
+  // part of it and nothing at all when neither did
+  int damage[4]={0,0,m_width,m_height};
+  const bool partial=!m_sceneChanged;
+  if(partial && !QtImGui::frameDamage(damage))
+    return;
+  m_sceneChanged=false;
+  timer->begin("Scene");
+  state->viewport(0,0,m_width,m_height);
+  state->enableBlend(false);
+  state->enableScissorTest(partial);
+  if(partial)
+    state->scissor(damage[0],damage[1],damage[2],damage[3]);
+  state->enableDepthTest(true);
+  state->polygonMode(m_wireframe ? GL_LINE : GL_FILL);
+  // clear the screen and depth buffer (only the damage when partial, glClear follows the scissor)
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  // grab an instance of the shader manager
-  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-  (*shader)["Phong"]->use();
+  // make the Phong shader active
+  state->useProgram("Phong");
 
   // Rotation based on the mouse position for our global transform
   ngl::Mat4 rotX;
@@ -258,7 +305,10 @@ void NGLScene::paintGL()
       case 5 : m_localScale.scale(1.0f, 1.0f, 1.0f); prim->draw("cube"); break;
 
     }
-  drawIMGUI();
+  // VAOPrimitives binds (and unbinds) its own VAO
+  state->invalidate(GLStateCache::VERTEX_ARRAY);
+  timer->end();
+  QtImGui::renderFrame(partial ? damage : nullptr);
 
 }
 
@@ -378,9 +428,9 @@ void NGLScene::keyPressEvent(QKeyEvent *_event)
   // turn on wirframe rendering
 #ifndef USINGIOS_
 
-  case Qt::Key_W : glPolygonMode(GL_FRONT_AND_BACK,GL_LINE); break;
+  case Qt::Key_W : m_wireframe=true; m_sceneChanged=true; break;
   // turn off wire frame
-  case Qt::Key_S : glPolygonMode(GL_FRONT_AND_BACK,GL_FILL); break;
+  case Qt::Key_S : m_wireframe=false; m_sceneChanged=true; break;
 #endif
   // show full screen
   case Qt::Key_F : showFullScreen(); break;
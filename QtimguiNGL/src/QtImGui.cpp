@@ -75,4 +75,40 @@ void newFrame() {
     ImGuiRenderer::instance()->newFrame();
 }
 
+const ImDrawCompactStats &drawStats() {
+    return ImGuiRenderer::instance()->drawStats();
+}
+
+const ImDrawListCacheStats &listCacheStats() {
+    return ImGuiRenderer::instance()->listCacheStats();
+}
+
+void setFontAlpha8(bool enable) {
+    ImGuiRenderer::instance()->setFontAlpha8(enable);
+}
+
+void setFontDistanceField(bool enable) {
+    ImGuiRenderer::instance()->setFontDistanceField(enable);
+}
+
+void setUiLayer(bool enable) {
+    ImGuiRenderer::instance()->setUiLayer(enable);
+}
+
+bool setMultiDrawIndirect(bool enable) {
+    return ImGuiRenderer::instance()->setMultiDrawIndirect(enable);
+}
+
+void setDeferredRender(bool enable) {
+    ImGuiRenderer::instance()->setDeferredRender(enable);
+}
+
+bool frameDamage(int rect[4]) {
+    return ImGuiRenderer::instance()->frameDamage(rect);
+}
+
+void renderFrame(const int *clipRect) {
+    ImGuiRenderer::instance()->renderFrame(clipRect);
+}
+
 }
@@ -2,13 +2,42 @@
 basic OpenGL demo modified from http://qt-project.org/doc/qt-5.0/qtgui/openglwindow.html
 ****************************************************************************/
 #include <QtGui/QGuiApplication>
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFramebufferObject>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include "NGLScene.h"
+#include "GPUTimer.h"
+#include "ProgramCache.h"
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief render the scene and UI into an FBO without showing the window and print frame times to stdout
+/// @param[in] _format the format used for the window, reused for the offscreen context
+/// @param[in] _frames the number of frames to render before exiting
+//----------------------------------------------------------------------------------------------------------------------
+int runHeadless(const QSurfaceFormat &_format, int _frames);
 
 
 int main(int argc, char **argv)
 {
+  // --headless [frames] renders the same scene and UI offscreen and exits, for CI and timing runs
+  int headlessFrames=0;
+  for(int i=1; i<argc; ++i)
+  {
+    if(std::strcmp(argv[i],"--headless")==0)
+    {
+      headlessFrames=(i+1<argc) ? std::atoi(argv[i+1]) : 0;
+      headlessFrames=headlessFrames>0 ? headlessFrames : 100;
+    }
+  }
+  // no window system is needed for a QOffscreenSurface, -platform or QT_QPA_PLATFORM still override that
+  // (minimalegl with EGL_PLATFORM=surfaceless works on machines without an X server)
+  if(headlessFrames>0 && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM","offscreen");
   QGuiApplication app(argc, argv);
   // create an OpenGL format specifier
   QSurfaceFormat format;
@@ -31,6 +60,8 @@ int main(int argc, char **argv)
   format.setDepthBufferSize(24);
   // set that as the default format for all windows
   QSurfaceFormat::setDefaultFormat(format);
+  if(headlessFrames>0)
+    return runHeadless(format,headlessFrames);
 
   // now we are going to create our scene window
   NGLScene window;
@@ -44,4 +75,50 @@ int main(int argc, char **argv)
   return app.exec();
 }
 
-
+int runHeadless(const QSurfaceFormat &_format, int _frames)
+{
+  constexpr int width=1024;
+  constexpr int height=720;
+  QOffscreenSurface surface;
+  surface.setFormat(_format);
+  surface.create();
+  QOpenGLContext context;
+  context.setFormat(_format);
+  if(!context.create() || !context.makeCurrent(&surface))
+  {
+    std::cerr<<"Unable to create an offscreen OpenGL context\n";
+    return EXIT_FAILURE;
+  }
+  {
+    // the scene and UI draw into this FBO exactly as they would into the window's back buffer
+    QOpenGLFramebufferObject fbo(width,height,QOpenGLFramebufferObject::Depth);
+    fbo.bind();
+    // the window is never shown, QtImGui only reads its size and it never becomes active so there is no mouse
+    NGLScene scene;
+    scene.resize(width,height);
+    scene.initializeGL();
+    scene.resizeGL(width,height);
+    GPUTimer::instance()->setEnabled(true);
+    double total=0.0;
+    double fastest=0.0;
+    double slowest=0.0;
+    for(int frame=0; frame<_frames; ++frame)
+    {
+      auto start=std::chrono::steady_clock::now();
+      scene.paintGL();
+      // wait for the GPU so the time covers the whole frame, not just submitting it
+      context.functions()->glFinish();
+      double ms=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+      // the GPU time printed is from GPUTimer::FrameLatency frames back, 0 until the ring fills
+      std::cout<<"frame "<<frame<<" "<<ms<<" ms gpu "<<GPUTimer::instance()->totalMs()<<" ms\n";
+      total+=ms;
+      fastest=frame==0 ? ms : std::min(fastest,ms);
+      slowest=std::max(slowest,ms);
+    }
+    std::cout<<_frames<<" frames "<<width<<"x"<<height<<" average "<<total/_frames<<" ms min "<<fastest<<" ms max "<<slowest<<" ms\n";
+    std::cout<<"shader programs "<<ProgramCache::instance()->hits()<<" from cache "<<ProgramCache::instance()->misses()<<" compiled\n";
+    fbo.release();
+  }
+  context.doneCurrent();
+  return EXIT_SUCCESS;
+}
@@ -19,6 +19,8 @@ LIBS+=$$system(sdl2-config  --libs)
 message(output from sdl2-config --libs added to LIB=$$LIBS)
 
 macx:LIBS+= $$system(sdl2-config --static-libs)
+# EGL gives the surfaceless context used by --headless
+linux:LIBS+= -lEGL -lpthread
 
 
 # where to put moc auto generated files
@@ -30,7 +32,16 @@ SOURCES+= $$PWD/src/NGLDraw.cpp    \
           $$PWD/../imgui/src/imgui.cpp \
           $$PWD/../imgui/src/imgui_draw.cpp \
           $$PWD/src/ImGUIImpl.cpp \
+          $$PWD/src/GLStateCache.cpp \
+          $$PWD/src/GPUTimer.cpp \
+          $$PWD/src/ProgramCache.cpp \
+          $$PWD/src/RenderThread.cpp \
           $$PWD/../imgui/src/ColourPicker.cpp \
+          $$PWD/../imgui/src/ImDrawCompact.cpp \
+          $$PWD/../imgui/src/ImDrawListCache.cpp \
+          $$PWD/../imgui/src/ImDrawRaster.cpp \
+          $$PWD/../imgui/src/ImDrawSnapshot.cpp \
+          $$PWD/../imgui/src/ImDrawVertLayout.cpp \
           $$PWD/src/main.cpp
 # same for the .h files
 HEADERS+= $$PWD/include/NGLDraw.h \
@@ -40,7 +51,37 @@ HEADERS+= $$PWD/include/NGLDraw.h \
           $$PWD/../imgui/include/imconfig.h \
           $$PWD/../imgui/include/imgui_internal.h \
           $$PWD/../imgui/include/stb_textedit.h \
-          $$PWD/include/ImGUIImpl.h
+          $$PWD/../imgui/include/ImDrawCompact.h \
+          $$PWD/../imgui/include/ImDrawListCache.h \
+          $$PWD/../imgui/include/ImDrawRaster.h \
+          $$PWD/../imgui/include/ImDrawSnapshot.h \
+          $$PWD/../imgui/include/ImDrawVertLayout.h \
+          $$PWD/include/ImGUIImpl.h \
+          $$PWD/include/GLStateCache.h \
+          $$PWD/include/GPUTimer.h \
+          $$PWD/include/ProgramCache.h \
+          $$PWD/include/RenderThread.h
+
+# qmake CONFIG+=prebaked_font bakes the default font atlas into a header at build time so AddFontDefault() skips
+# decompressing and rasterizing ProggyClean. The tool only needs ImGui itself and is built without the define
+prebaked_font {
+	fontbake.target = generated/imgui_default_font_atlas.h
+	fontbake.commands = mkdir -p generated ;
+	fontbake.commands += $$QMAKE_CXX -std=c++11 -O2 -I$$PWD/../imgui/include -o generated/ImFontAtlasBake \
+	                     $$PWD/../imgui/tools/ImFontAtlasBake.cpp $$PWD/../imgui/src/imgui.cpp $$PWD/../imgui/src/imgui_draw.cpp -lpthread ;
+	fontbake.commands += generated/ImFontAtlasBake $$fontbake.target
+	fontbake.depends = $$PWD/../imgui/tools/ImFontAtlasBake.cpp $$PWD/../imgui/src/imgui_draw.cpp
+	QMAKE_EXTRA_TARGETS += fontbake
+	PRE_TARGETDEPS += $$fontbake.target
+	INCLUDEPATH += generated
+	DEFINES += IMGUI_PREBAKED_DEFAULT_FONT
+}
+
+# make polylinebench builds and runs the AddPolyline SIMD / scalar comparison, it is never part of the demo build
+polylinebench.commands = $$QMAKE_CXX -std=c++11 -O2 -I$$PWD/../imgui/include -o ImDrawPolylineBench \
+                         $$PWD/../imgui/tools/ImDrawPolylineBench.cpp $$PWD/../imgui/src/imgui.cpp $$PWD/../imgui/src/imgui_draw.cpp -lpthread ;
+polylinebench.commands += ./ImDrawPolylineBench
+QMAKE_EXTRA_TARGETS += polylinebench
 
 # and add the include dir into the search path for Qt and make
 INCLUDEPATH +=./include
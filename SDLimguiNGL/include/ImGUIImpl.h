@@ -7,12 +7,52 @@
 // https://github.com/ocornut/imgui
 #include <SDL.h>
 #include "imgui.h"
+#include "ImDrawCompact.h"
+#include "ImDrawListCache.h"
+#include "ImDrawRaster.h"
+#include "ImDrawSnapshot.h"
 
 IMGUI_API bool   ImGuiImplSdlInit(SDL_Window* window);
 IMGUI_API void   ImGuiImplSdlShutdown();
 IMGUI_API void   ImGuiImplSdlNewFrame(SDL_Window* window);
 IMGUI_API bool   ImGuiImplSdlProcessEvent(SDL_Event* event);
+// Start a frame without a window (headless runs into an FBO), Init may be given a null window in that case
+IMGUI_API void   ImGuiImplSdlNewFrameHeadless(int width, int height, float delta_time);
+// Init for headless runs without any GL context: ImGui::Render() rasterizes on the CPU (see ImGuiImplSdlGetSoftwareFrame)
+// and the font atlas is never uploaded. Use with ImGuiImplSdlNewFrameHeadless and ImGuiImplSdlShutdown
+IMGUI_API bool   ImGuiImplSdlInitNoGL();
 
 // Use if you want to reset your rendering device without losing ImGui state.
 IMGUI_API void   ImGuiImplSdlInvalidateDeviceObjects();
 IMGUI_API bool   ImGuiImplSdlGL3CreateDeviceObjects();
+// What NewFrame does when the device objects were invalidated, for a thread that owns the context while another one
+// builds the frames (which must be waiting while this runs, the font atlas may be rebuilt)
+IMGUI_API void   ImGuiImplSdlCreateMissingDeviceObjects();
+
+// Render a frame copied with ImDrawSnapshot::Capture() on the thread owning the context. Set io.RenderDrawListsFn to
+// NULL in that case, ImGui::Render() then only builds the draw data for the capture.
+IMGUI_API void   ImGuiImplSdlRenderSnapshot(ImDrawSnapshot& snapshot);
+
+// Draw call statistics of the last rendered frame (GL calls saved by the command compaction etc.)
+IMGUI_API const ImDrawCompactStats& ImGuiImplSdlGetDrawStats();
+// How many lists of the last frame were drawn from GPU memory without being uploaded again
+IMGUI_API const ImDrawListCacheStats& ImGuiImplSdlGetListCacheStats();
+
+// Upload the font atlas as a single channel GL_R8 texture (default) or as RGBA32, needs a current context when switching
+IMGUI_API void   ImGuiImplSdlSetFontAlpha8(bool enable);
+// Rebuild the font atlas as signed distance fields (ImFontAtlas::TexDistanceField), text then stays sharp at any
+// io.FontGlobalScale / SetWindowFontScale. Takes effect at the next ImGuiImplSdlNewFrame, no context needed
+IMGUI_API void   ImGuiImplSdlSetFontDistanceField(bool enable);
+
+// Draw the UI into a cached texture that is only redrawn when the draw data changes and blended over the scene every frame
+// (only the damaged part of the texture is redrawn, the scene and the blend still cover the window as SDL_GL_SwapWindow
+// does not keep the back buffer)
+IMGUI_API void   ImGuiImplSdlSetUiLayer(bool enable);
+
+// Opt in to the GL 4.3 multi-draw-indirect path, returns false (and keeps the regular path) on older contexts
+IMGUI_API bool   ImGuiImplSdlSetMultiDrawIndirect(bool enable);
+
+// Draw the UI with the CPU rasterizer instead of GL (the result is still blended over the scene with GL)
+IMGUI_API void   ImGuiImplSdlSetSoftwareRenderer(bool enable);
+// The last software rendered UI, premultiplied alpha, e.g. for SaveImage()
+IMGUI_API const ImDrawRaster& ImGuiImplSdlGetSoftwareFrame();
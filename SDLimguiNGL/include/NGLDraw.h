@@ -2,8 +2,36 @@
 #define NGLDRAW_H_
 #include <ngl/Mat4.h>
 #include <ngl/Vec3.h>
+#include <ngl/Vec4.h>
 #include <SDL.h>
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief everything the UI and the mouse change about the scene. draw() works from a copy of this so a render thread
+/// can draw one frame while the main thread edits the next, the setters below only ever touch these values
+//----------------------------------------------------------------------------------------------------------------------
+struct SceneParams
+{
+  int spinXFace=0;
+  int spinYFace=0;
+  ngl::Vec3 modelPos;
+  ngl::Vec3 modelRot={0.0f,0.0f,0.0f};
+  ngl::Vec3 modelScale=ngl::Vec3(1.0f,1.0f,1.0f);
+  ngl::Vec3 modelPosition=ngl::Vec3(0.0f,0.0f,0.0f);
+  int modelID=0;
+  bool wireframe=false;
+  int width=1;
+  int height=1;
+  ngl::Vec4 clearColour=ngl::Vec4(0.4f,0.4f,0.4f,1.0f);
+  ngl::Vec4 lightPosition;
+  ngl::Vec4 lightAmbient;
+  ngl::Vec4 lightSpecular;
+  ngl::Vec4 lightDiffuse;
+  ngl::Vec4 materialAmbient;
+  ngl::Vec4 materialSpecular;
+  ngl::Vec4 materialDiffuse;
+  float specPower=1.0f;
+};
+
 class NGLDraw
 {
   public :
@@ -16,23 +44,30 @@ class NGLDraw
     //----------------------------------------------------------------------------------------------------------------------
     ~NGLDraw();
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief resize our screen and set the camera aspect ratio
+    /// @brief resize our screen, the camera aspect ratio follows on the next draw
     /// @param[in] _w the new width
     /// @param[in] _h the new height
     //----------------------------------------------------------------------------------------------------------------------
-    void resize(int _w, int _h);
+    void resize(int _w, int _h){m_params.width=_w; m_params.height=_h;}
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief draw the scene
+    /// @brief draw the scene with the current parameters
     //----------------------------------------------------------------------------------------------------------------------
-    void draw();
-    void setModelRotation(const ngl::Vec3 &_r ){m_modelRot=_r;}
-    void setModelScale(const ngl::Vec3 &_r ){m_modelScale=_r;}
-    void setModelPosition(const ngl::Vec3 &_r ){m_modelPosition=_r;}
-    void setModelID(int _id){m_modelID=_id;}
+    void draw(){draw(m_params);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the scene from a copy of the parameters, the only method (with the ctor / dtor) that uses GL
+    /// @param[in] _params what to draw, see params()
+    //----------------------------------------------------------------------------------------------------------------------
+    void draw(const SceneParams &_params);
+    const SceneParams &params() const {return m_params;}
+    void setModelRotation(const ngl::Vec3 &_r ){m_params.modelRot=_r;}
+    void setModelScale(const ngl::Vec3 &_r ){m_params.modelScale=_r;}
+    void setModelPosition(const ngl::Vec3 &_r ){m_params.modelPosition=_r;}
+    void setModelID(int _id){m_params.modelID=_id;}
     void setLight(const ngl::Vec4 &_position, const ngl::Vec4 &_ambient, const ngl::Vec4 &_specular, const ngl::Vec4 &_diffuse );
     void setMaterial(const ngl::Vec4 &_ambient, const ngl::Vec4 &_specular, const ngl::Vec4 &_diffus, float _specPower );
-    void setWireFrame(bool _w){m_wireframe=_w;}
-    bool getWireFrame() const {return m_wireframe;}
+    void setWireFrame(bool _w){m_params.wireframe=_w;}
+    bool getWireFrame() const {return m_params.wireframe;}
+    void setClearColour(const ngl::Vec4 &_c){m_params.clearColour=_c;}
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief this method is called every time a mouse is moved
     /// @param _event the SDL mouse event structure containing all mouse info
@@ -57,15 +92,11 @@ class NGLDraw
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief method to load transform data to the shaders
     //----------------------------------------------------------------------------------------------------------------------
-    void loadMatricesToShader();
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief used to store the x rotation mouse value
+    void loadMatricesToShader(const SceneParams &_params);
     //----------------------------------------------------------------------------------------------------------------------
-    int m_spinXFace;
+    /// @brief the scene as the UI and mouse left it, draw() only reads it
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief used to store the y rotation mouse value
-    //----------------------------------------------------------------------------------------------------------------------
-    int m_spinYFace;
+    SceneParams m_params;
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief flag to indicate if the mouse button is pressed when dragging
     //----------------------------------------------------------------------------------------------------------------------
@@ -99,19 +130,7 @@ class NGLDraw
     //----------------------------------------------------------------------------------------------------------------------
     ngl::Mat4 m_view;
     ngl::Mat4 m_project;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief the model position for mouse movement
-    //----------------------------------------------------------------------------------------------------------------------
-    ngl::Vec3 m_modelPos;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief a simple light use to illuminate the screen
-    //----------------------------------------------------------------------------------------------------------------------
-    ngl::Vec3 m_modelRot={0.0f,0.0f,0.0f};
-    ngl::Vec3 m_modelScale=ngl::Vec3(1.0f,1.0f,1.0f);
-    ngl::Vec3 m_modelPosition=ngl::Vec3(0.0f,0.0f,0.0f);
-    int m_modelID=0;
     ngl::Mat4 m_localScale;
-    bool m_wireframe=false;
 
 
 };
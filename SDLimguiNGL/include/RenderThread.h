@@ -0,0 +1,93 @@
+#ifndef RENDERTHREAD_H_
+#define RENDERTHREAD_H_
+#include <SDL.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "NGLDraw.h"
+#include "GPUTimer.h"
+#include "ImGUIImpl.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the numbers the UI shows about rendering, copied out by whichever thread renders
+//----------------------------------------------------------------------------------------------------------------------
+struct RenderStats
+{
+  ImDrawCompactStats draw;
+  ImDrawListCacheStats listCache;
+  float softwareMs=0.0f;
+  std::vector<GPUTimer::Section> gpuSections;
+  float gpuTotalMs=0.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief read the backend and GPUTimer, only on the thread that renders
+  //----------------------------------------------------------------------------------------------------------------------
+  void collect();
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file RenderThread.h
+/// @brief render thread for the SDL window loop
+/// @class RenderThread
+/// @brief owns the GL context and draws, uploads and swaps while the main thread handles input and builds the next
+/// frame. The main thread hands each frame over as a copy (ImDrawSnapshot plus SceneParams) into one of two slots,
+/// so it only waits when it is a whole frame ahead. GL work the UI asks for (backend setters that recreate device
+/// objects) goes through runSync() which runs it between two frames.
+//----------------------------------------------------------------------------------------------------------------------
+class RenderThread
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start the thread, the context is released on the calling thread and made current on the new one
+    /// @param[in] _window the window to swap
+    /// @param[in] _context a context of _window current on the calling thread with the device objects created
+    /// @param[in] _ngl the scene, its GL objects are only used from the render thread from now on
+    //----------------------------------------------------------------------------------------------------------------------
+    RenderThread(SDL_Window *_window, SDL_GLContext _context, NGLDraw &_ngl);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief finish the frames handed over, stop and make the context current on the calling thread again
+    //----------------------------------------------------------------------------------------------------------------------
+    ~RenderThread();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copy a frame and queue it, call after ImGui::Render() (with io.RenderDrawListsFn set to null)
+    /// @param[in] _ui ImGui::GetDrawData(), may be null
+    /// @param[in] _scene the scene parameters for the frame
+    //----------------------------------------------------------------------------------------------------------------------
+    void submit(const ImDrawData *_ui, const SceneParams &_scene);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief run _fn with the context current between two frames and wait until it has run
+    //----------------------------------------------------------------------------------------------------------------------
+    void runSync(const std::function<void()> &_fn);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the stats of the last frame rendered
+    //----------------------------------------------------------------------------------------------------------------------
+    RenderStats stats();
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a frame slot, Free (the main thread may fill it), Ready (queued) or Rendering
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Frame
+    {
+      enum State {Free, Ready, Rendering};
+      State state=Free;
+      unsigned int serial=0;
+      ImDrawSnapshot ui;
+      SceneParams scene;
+    };
+    void run();
+    SDL_Window *m_window;
+    SDL_GLContext m_context;
+    NGLDraw &m_ngl;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    Frame m_frames[2];
+    int m_next=0;
+    unsigned int m_serial=0;
+    const std::function<void()> *m_task=nullptr;
+    bool m_quit=false;
+    RenderStats m_stats;
+};
+
+#endif
@@ -0,0 +1,9 @@
+#version 330
+/// @brief the cached UI layer, premultiplied alpha and the same size as the framebuffer
+uniform sampler2D Layer;
+/// @brief our output fragment colour
+layout (location =0) out vec4 fragColour;
+void main()
+{
+  fragColour = texelFetch(Layer, ivec2(gl_FragCoord.xy), 0);
+}
@@ -0,0 +1,14 @@
+#version 430
+uniform sampler2D Texture;
+in vec2 Frag_UV;
+in vec4 Frag_Color;
+flat in vec4 Frag_ClipRect;
+/// @brief our output fragment colour
+layout (location =0) out vec4 fragColour;
+void main()
+{
+  // replaces glScissor, a multi draw can't change the scissor between its draws
+  if(any(lessThan(gl_FragCoord.xy,Frag_ClipRect.xy)) || any(greaterThanEqual(gl_FragCoord.xy,Frag_ClipRect.xy+Frag_ClipRect.zw)))
+    discard;
+  fragColour = Frag_Color * texture( Texture, Frag_UV.st);
+}
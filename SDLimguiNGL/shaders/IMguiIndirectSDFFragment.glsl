@@ -0,0 +1,20 @@
+#version 430
+uniform sampler2D Texture;
+in vec2 Frag_UV;
+in vec4 Frag_Color;
+flat in vec4 Frag_ClipRect;
+/// @brief our output fragment colour
+layout (location =0) out vec4 fragColour;
+/// @brief the font atlas alpha on a glyph outline (ImFontAtlas::TexDistanceField)
+const float OnEdge=128.0/255.0;
+void main()
+{
+  // derivatives first, they are undefined once a neighbour of the quad has been discarded
+  vec4 texel=texture( Texture, Frag_UV.st);
+  float width=max(fwidth(texel.a),1e-4);
+  // replaces glScissor, a multi draw can't change the scissor between its draws
+  if(any(lessThan(gl_FragCoord.xy,Frag_ClipRect.xy)) || any(greaterThanEqual(gl_FragCoord.xy,Frag_ClipRect.xy+Frag_ClipRect.zw)))
+    discard;
+  texel.a=clamp((texel.a-OnEdge)/width+0.5,0.0,1.0);
+  fragColour = Frag_Color * texel;
+}
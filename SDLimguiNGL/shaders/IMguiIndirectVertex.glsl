@@ -0,0 +1,17 @@
+#version 430
+uniform mat4 ProjMtx;
+layout (location = 0) in vec2 Position;
+layout (location = 1) in vec2 UV;
+layout (location = 2) in vec4 Color;
+/// @brief per draw clip rect (x,y,w,h in framebuffer pixels), fetched through the draw's baseInstance
+layout (location = 3) in vec4 ClipRect;
+out vec2 Frag_UV;
+out vec4 Frag_Color;
+flat out vec4 Frag_ClipRect;
+void main()
+{
+    Frag_UV = UV;
+    Frag_Color = Color;
+    Frag_ClipRect = ClipRect;
+    gl_Position = ProjMtx * vec4(Position.xy,0,1);
+}
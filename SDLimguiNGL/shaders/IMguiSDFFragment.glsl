@@ -0,0 +1,17 @@
+#version 330
+uniform sampler2D Texture;
+in vec2 Frag_UV;
+in vec4 Frag_Color;
+/// @brief our output fragment colour
+layout (location =0) out vec4 fragColour;
+/// @brief the font atlas alpha on a glyph outline (ImFontAtlas::TexDistanceField)
+const float OnEdge=128.0/255.0;
+void main()
+{
+  vec4 texel=texture( Texture, Frag_UV.st);
+  // the change of the distance across one pixel keeps the edge a pixel wide at any font scale,
+  // the white pixel and the mouse cursors are flat and come out fully opaque or transparent
+  float width=max(fwidth(texel.a),1e-4);
+  texel.a=clamp((texel.a-OnEdge)/width+0.5,0.0,1.0);
+  fragColour = Frag_Color * texel;
+}
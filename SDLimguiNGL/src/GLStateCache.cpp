@@ -0,0 +1,215 @@
+#include "GLStateCache.h"
+#include <ngl/ShaderLib.h>
+
+GLStateCache *GLStateCache::instance()
+{
+  static GLStateCache s_instance;
+  return &s_instance;
+}
+
+GLStateCache::GLStateCache()
+{
+}
+
+void GLStateCache::invalidate(unsigned int _flags)
+{
+  if(_flags & PROGRAM)
+  {
+    m_program=-1;
+    m_programName.clear();
+  }
+  if(_flags & VERTEX_ARRAY)
+  {
+    m_vertexArray=-1;
+    m_arrayBuffer=-1;
+  }
+  if(_flags & TEXTURE)
+  {
+    m_activeTexture=-1;
+    m_texture=-1;
+  }
+  if(_flags & CAPABILITIES)
+  {
+    m_blend=m_cullFace=m_depthTest=m_scissorTest=-1;
+  }
+  if(_flags & BLEND)
+  {
+    m_blendEquation=m_blendSrc=m_blendDst=m_blendSrcAlpha=m_blendDstAlpha=-1;
+  }
+  if(_flags & VIEWPORT)
+  {
+    m_viewport[0]=-1;
+  }
+  if(_flags & SCISSOR)
+  {
+    m_scissor[0]=-1;
+  }
+  if(_flags & POLYGON_MODE)
+  {
+    m_polygonMode=-1;
+  }
+}
+
+void GLStateCache::useProgram(const std::string &_name)
+{
+  ++m_requested;
+  if(_name == m_programName)
+    return;
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->use(_name);
+  m_programName=_name;
+  m_program=static_cast<GLint>(shader->getProgramID(_name));
+  ++m_emitted;
+}
+
+void GLStateCache::useProgram(GLuint _id)
+{
+  ++m_requested;
+  if(static_cast<GLint>(_id) == m_program && m_programName.empty())
+    return;
+  glUseProgram(_id);
+  // ShaderLib no longer knows what is bound so the next useProgram(name) must go through it
+  m_programName.clear();
+  m_program=static_cast<GLint>(_id);
+  ++m_emitted;
+}
+
+void GLStateCache::bindVertexArray(GLuint _vao)
+{
+  ++m_requested;
+  if(static_cast<GLint>(_vao) == m_vertexArray)
+    return;
+  glBindVertexArray(_vao);
+  m_vertexArray=static_cast<GLint>(_vao);
+  ++m_emitted;
+}
+
+void GLStateCache::bindArrayBuffer(GLuint _buffer)
+{
+  ++m_requested;
+  if(static_cast<GLint>(_buffer) == m_arrayBuffer)
+    return;
+  glBindBuffer(GL_ARRAY_BUFFER,_buffer);
+  m_arrayBuffer=static_cast<GLint>(_buffer);
+  ++m_emitted;
+}
+
+void GLStateCache::activeTexture(GLenum _unit)
+{
+  ++m_requested;
+  if(static_cast<GLint>(_unit) == m_activeTexture)
+    return;
+  glActiveTexture(_unit);
+  m_activeTexture=static_cast<GLint>(_unit);
+  // the texture binding we track belongs to the old unit
+  m_texture=-1;
+  ++m_emitted;
+}
+
+void GLStateCache::bindTexture2D(GLuint _texture)
+{
+  ++m_requested;
+  if(static_cast<GLint>(_texture) == m_texture)
+    return;
+  glBindTexture(GL_TEXTURE_2D,_texture);
+  m_texture=static_cast<GLint>(_texture);
+  ++m_emitted;
+}
+
+void GLStateCache::setCapability(GLenum _cap, int &_cached, bool _on)
+{
+  ++m_requested;
+  if(_cached == static_cast<int>(_on))
+    return;
+  if(_on)
+    glEnable(_cap);
+  else
+    glDisable(_cap);
+  _cached=static_cast<int>(_on);
+  ++m_emitted;
+}
+
+void GLStateCache::enableBlend(bool _on)
+{
+  setCapability(GL_BLEND,m_blend,_on);
+}
+
+void GLStateCache::enableCullFace(bool _on)
+{
+  setCapability(GL_CULL_FACE,m_cullFace,_on);
+}
+
+void GLStateCache::enableDepthTest(bool _on)
+{
+  setCapability(GL_DEPTH_TEST,m_depthTest,_on);
+}
+
+void GLStateCache::enableScissorTest(bool _on)
+{
+  setCapability(GL_SCISSOR_TEST,m_scissorTest,_on);
+}
+
+void GLStateCache::blendEquation(GLenum _mode)
+{
+  ++m_requested;
+  if(static_cast<GLint>(_mode) == m_blendEquation)
+    return;
+  glBlendEquation(_mode);
+  m_blendEquation=static_cast<GLint>(_mode);
+  ++m_emitted;
+}
+
+void GLStateCache::blendFunc(GLenum _src, GLenum _dst)
+{
+  blendFuncSeparate(_src,_dst,_src,_dst);
+}
+
+void GLStateCache::blendFuncSeparate(GLenum _srcRGB, GLenum _dstRGB, GLenum _srcAlpha, GLenum _dstAlpha)
+{
+  ++m_requested;
+  if(static_cast<GLint>(_srcRGB) == m_blendSrc && static_cast<GLint>(_dstRGB) == m_blendDst &&
+     static_cast<GLint>(_srcAlpha) == m_blendSrcAlpha && static_cast<GLint>(_dstAlpha) == m_blendDstAlpha)
+    return;
+  glBlendFuncSeparate(_srcRGB,_dstRGB,_srcAlpha,_dstAlpha);
+  m_blendSrc=static_cast<GLint>(_srcRGB);
+  m_blendDst=static_cast<GLint>(_dstRGB);
+  m_blendSrcAlpha=static_cast<GLint>(_srcAlpha);
+  m_blendDstAlpha=static_cast<GLint>(_dstAlpha);
+  ++m_emitted;
+}
+
+void GLStateCache::viewport(GLint _x, GLint _y, GLsizei _w, GLsizei _h)
+{
+  ++m_requested;
+  if(m_viewport[0] == _x && m_viewport[1] == _y && m_viewport[2] == _w && m_viewport[3] == _h)
+    return;
+  glViewport(_x,_y,_w,_h);
+  m_viewport[0]=_x;
+  m_viewport[1]=_y;
+  m_viewport[2]=_w;
+  m_viewport[3]=_h;
+  ++m_emitted;
+}
+
+void GLStateCache::scissor(GLint _x, GLint _y, GLsizei _w, GLsizei _h)
+{
+  ++m_requested;
+  if(m_scissor[0] == _x && m_scissor[1] == _y && m_scissor[2] == _w && m_scissor[3] == _h)
+    return;
+  glScissor(_x,_y,_w,_h);
+  m_scissor[0]=_x;
+  m_scissor[1]=_y;
+  m_scissor[2]=_w;
+  m_scissor[3]=_h;
+  ++m_emitted;
+}
+
+void GLStateCache::polygonMode(GLenum _mode)
+{
+  ++m_requested;
+  if(static_cast<GLint>(_mode) == m_polygonMode)
+    return;
+  glPolygonMode(GL_FRONT_AND_BACK,_mode);
+  m_polygonMode=static_cast<GLint>(_mode);
+  ++m_emitted;
+}
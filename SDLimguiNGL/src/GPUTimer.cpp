@@ -0,0 +1,76 @@
+#include "GPUTimer.h"
+
+GPUTimer *GPUTimer::instance()
+{
+  static GPUTimer s_instance;
+  return &s_instance;
+}
+
+void GPUTimer::setEnabled(bool _on)
+{
+  if(_on == m_enabled)
+    return;
+  end();
+  m_enabled=_on;
+  // whatever is still in the ring was issued before the switch, don't show it later
+  for(auto &frame : m_frames)
+    frame.used=0;
+  m_sections.clear();
+  m_totalMs=0.0f;
+}
+
+void GPUTimer::newFrame()
+{
+  if(!m_enabled)
+    return;
+  end();
+  m_current=(m_current+1)%FrameLatency;
+  Frame &frame=m_frames[m_current];
+  if(frame.used>0)
+  {
+    // queries complete in order so the last one tells us about the whole frame
+    GLuint available=0;
+    glGetQueryObjectuiv(frame.queries[frame.used-1],GL_QUERY_RESULT_AVAILABLE,&available);
+    if(available)
+    {
+      m_sections.resize(frame.used);
+      m_totalMs=0.0f;
+      for(size_t i=0; i<frame.used; ++i)
+      {
+        GLuint64 ns=0;
+        glGetQueryObjectui64v(frame.queries[i],GL_QUERY_RESULT,&ns);
+        m_sections[i].name=frame.names[i];
+        m_sections[i].ms=static_cast<float>(ns)*1e-6f;
+        m_totalMs+=m_sections[i].ms;
+      }
+    }
+  }
+  frame.used=0;
+}
+
+void GPUTimer::begin(const char *_name)
+{
+  if(!m_enabled)
+    return;
+  end();
+  Frame &frame=m_frames[m_current];
+  if(frame.used == frame.queries.size())
+  {
+    GLuint query;
+    glGenQueries(1,&query);
+    frame.queries.push_back(query);
+    frame.names.emplace_back();
+  }
+  frame.names[frame.used]=_name;
+  glBeginQuery(GL_TIME_ELAPSED,frame.queries[frame.used]);
+  ++frame.used;
+  m_open=true;
+}
+
+void GPUTimer::end()
+{
+  if(!m_open)
+    return;
+  glEndQuery(GL_TIME_ELAPSED);
+  m_open=false;
+}
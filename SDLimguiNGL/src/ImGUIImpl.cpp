@@ -8,113 +8,843 @@
 
 #include "imgui.h"
 #include "ImGUIImpl.h"
+#include "GLStateCache.h"
+#include "GPUTimer.h"
+#include "ProgramCache.h"
+#include "ImDrawCompact.h"
+#include "ImDrawListCache.h"
+#include "ImDrawRaster.h"
+#include "ImDrawSnapshot.h"
+#include "ImDrawVertLayout.h"
 
 // SDL,GL3W
 #include <SDL.h>
 #include <SDL_syswm.h>
 #include <ngl/ShaderLib.h>
+#include <cstring>
+#include <algorithm>
+#include <mutex>
+#include <vector>
 // Data
 static double       g_Time = 0.0f;
 static bool         g_MousePressed[3] = { false, false, false };
 static float        g_MouseWheel = 0.0f;
 static GLuint       g_FontTexture = 0;
+static bool         g_FontAlpha8 = true;
+static bool         g_FontDistanceField = false;   // the atlas holds distance fields, draws sampling it use the SDF program variants
+static bool         g_DistanceFieldPrograms = false;   // the SDF program variants are loaded
+static int          g_FontDistanceFieldRequest = -1;   // ImGuiImplSdlSetFontDistanceField() waiting for the next NewFrame, -1 for none
+static bool         g_ProgramDistanceField = false;    // the bound program is the SDF variant
+static ngl::Mat4    g_ProjMtx;                         // projection of the frame being rendered, set on each program the draws bind
 //static int          g_ShaderHandle = 0, g_VertHandle = 0, g_FragHandle = 0;
 static unsigned int g_VboHandle = 0, g_VaoHandle = 0, g_ElementsHandle = 0;
 
-// This is the main rendering function that you have to implement and provide to ImGui (via setting up 'RenderDrawListsFn' in the ImGuiIO structure)
-// If text or lines are blurry when integrating ImGui in your engine:
-// - in your Render function, try translating your projection matrix by (0.5f,0.5f) or (0.375f,0.375f)
-void ImGui_ImplSdlGL3_RenderDrawLists(ImDrawData* draw_data)
+// Streaming ring used to upload the vertex / index data, g_RingFrames segments each big enough for a whole frame.
+// With GL 4.4 (or ARB_buffer_storage) the buffers are persistently mapped, otherwise the frame is written with an
+// unsynchronized glMapBufferRange. In both cases a fence per segment stops us writing over data the GPU still reads.
+static const int    g_RingFrames = 3;
+static bool         g_RingPersistent = false;
+static int          g_RingVtxCapacity = 0, g_RingIdxCapacity = 0;   // per segment, in vertices / indices
+static int          g_RingFrame = 0;
+static char*        g_RingVtxData = nullptr;
+static char*        g_RingIdxData = nullptr;
+static GLsync       g_RingFences[g_RingFrames] = { 0, 0, 0 };
+
+// Lists that did not change are kept in a resident region of the same buffers after the ring segments (same capacity
+// as a segment) and drawn from there until they change, see ImDrawListCache
+static ImDrawListCache g_ListCache;
+static ImVector<ImDrawListSlot> g_ListSlots;
+static ImDrawListCacheStats g_ListCacheStats;
+
+// Compacted draw commands of the current frame and the statistics of the last one
+static ImVector<ImDrawCompactCmd> g_CompactCmds;
+static ImDrawCompactStats g_DrawStats;
+
+// Optional GL 4.3 multi-draw-indirect path, one glMultiDrawElementsIndirect per run of commands sharing a texture.
+// The clip rect of each draw is a per instance attribute (fetched through the command's baseInstance) tested in the
+// fragment shader, so no glScissor is needed inside a run.
+static bool         g_IndirectSupported = false;
+static bool         g_UseIndirect = false;
+static unsigned int g_IndirectVaoHandle = 0, g_IndirectHandle = 0, g_ClipRectHandle = 0;
+static ImVector<ImDrawIndirectCmd> g_IndirectCmds;
+static ImVector<ImVec4> g_IndirectClipRects;
+static ImVector<ImDrawIndirectRun> g_IndirectRuns;
+
+// Optional cached UI layer: the UI is drawn into a premultiplied alpha texture only when the draw data changes and that
+// texture is composited over the scene with one full-screen triangle every frame
+static bool         g_UseLayer = false;
+static bool         g_LayerPass = false;        // drawing into the layer, blend alpha for premultiplied output
+static GLuint       g_LayerFbo = 0, g_LayerTexture = 0, g_LayerVaoHandle = 0;
+static int          g_LayerWidth = 0, g_LayerHeight = 0;
+static ImU64        g_LayerHash = 0;
+static bool         g_LayerValid = false;
+
+// Optional software renderer: the UI is rasterized on the CPU and uploaded into the layer texture, which is then
+// composited as above. The GL path frees the atlas pixels once uploaded so the rasterizer keeps its own copy.
+static bool         g_UseSoftware = false;
+static bool         g_NoGL = false;            // ImGuiImplSdlInitNoGL(), there is no context and every frame stays in g_SoftRaster
+static ImDrawRaster g_SoftRaster;
+static ImVector<unsigned char> g_SoftFontPixels;
+
+// Atlas rectangles changed by ImFontAtlas::UpdateGlyphsOnDemand(), copied on the thread building the frames and uploaded by the one rendering
+// them. Each waits for the first frame drawn with the new glyphs, with a render thread the frame before can still be using what it replaces.
+// A distance field switch rebuilds the whole atlas, its update then reallocates the texture before copying the pixels.
+struct ImGuiImplSdlFontUpdate
 {
-    // Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer coordinates)
-    ImGuiIO& io = ImGui::GetIO();
-    GLsizei fb_width = GLsizei(io.DisplaySize.x * io.DisplayFramebufferScale.x);
-    GLsizei fb_height = GLsizei(io.DisplaySize.y * io.DisplayFramebufferScale.y);
-    if (fb_width == 0 || fb_height == 0)
+    int                         Frame;
+    int                         X, Y, Width, Height;
+    std::vector<unsigned char>  Pixels;     // alpha, Width * Height
+    bool                        Rebuild;    // whole atlas, Width x Height is the new texture size
+    float                       Spread;     // Rebuild only: distance field spread in pixels, 0.0f for a coverage atlas
+};
+static std::mutex   g_FontUpdatesMutex;
+static std::vector<ImGuiImplSdlFontUpdate> g_FontUpdates;
+static int          g_FontWidth = 0;
+
+// Display size of the frame being rendered, from ImGuiIO or from the snapshot when a render thread draws it
+static ImVec2       g_DisplaySize;
+
+// Context version as major * 10 + minor, e.g. 43 for 4.3
+static int ImGui_ImplSdlGL3_GLVersion()
+{
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    return major * 10 + minor;
+}
+
+static bool ImGui_ImplSdlGL3_HasBufferStorage()
+{
+    if (ImGui_ImplSdlGL3_GLVersion() >= 44)
+        return true;
+    GLint num_extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+    for (GLint i = 0; i < num_extensions; i++)
+        if (strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_buffer_storage") == 0)
+            return true;
+    return false;
+}
+
+static void ImGui_ImplSdlGL3_WaitRingFence(int segment)
+{
+    GLsync& fence = g_RingFences[segment];
+    if (!fence)
         return;
-    draw_data->ScaleClipRects(io.DisplayFramebufferScale);
-
-    // Backup GL state
-    GLint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
-    GLint last_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
-    GLint last_active_texture; glGetIntegerv(GL_ACTIVE_TEXTURE, &last_active_texture);
-    GLint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
-    GLint last_element_array_buffer; glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &last_element_array_buffer);
-    GLint last_vertex_array; glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array);
-    GLint last_blend_src; glGetIntegerv(GL_BLEND_SRC, &last_blend_src);
-    GLint last_blend_dst; glGetIntegerv(GL_BLEND_DST, &last_blend_dst);
-    GLint last_blend_equation_rgb; glGetIntegerv(GL_BLEND_EQUATION_RGB, &last_blend_equation_rgb);
-    GLint last_blend_equation_alpha; glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &last_blend_equation_alpha);
-    GLint last_viewport[4]; glGetIntegerv(GL_VIEWPORT, last_viewport);
-    GLboolean last_enable_blend = glIsEnabled(GL_BLEND);
-    GLboolean last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
-    GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
-
-    // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled
-    glEnable(GL_BLEND);
-    glBlendEquation(GL_FUNC_ADD);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_SCISSOR_TEST);
-    glActiveTexture(GL_TEXTURE0);
-
-    // Setup orthographic projection matrix
-    glViewport(0, 0, fb_width, fb_height);
-    ngl::Mat4 ortho(
-         2.0f/io.DisplaySize.x, 0.0f,                   0.0f, 0.0f,
-         0.0f,                  2.0f/-io.DisplaySize.y, 0.0f, 0.0f,
-         0.0f,                  0.0f,                  -1.0f, 0.0f,
-        -1.0f,                  1.0f,                   0.0f, 1.0f
-    );
-    ngl::ShaderLib *shader = ngl::ShaderLib::instance();
-    shader->use("IMGUI");
-    shader->setUniform("Texture",0);
-    shader->setUniform("ProjMtx",ortho);
-    glBindVertexArray(g_VaoHandle);
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+        ;
+    glDeleteSync(fence);
+    fence = 0;
+}
+
+static void ImGui_ImplSdlGL3_DestroyRingBuffers()
+{
+    for (int i = 0; i < g_RingFrames; i++)
+        ImGui_ImplSdlGL3_WaitRingFence(i);
+    if (g_VboHandle) glDeleteBuffers(1, &g_VboHandle);
+    if (g_ElementsHandle) glDeleteBuffers(1, &g_ElementsHandle);
+    g_VboHandle = g_ElementsHandle = 0;
+    g_RingVtxData = g_RingIdxData = nullptr;
+    g_RingVtxCapacity = g_RingIdxCapacity = 0;
+    g_RingFrame = 0;
+}
 
+static GLenum ImGui_ImplSdlGL3_AttribType(int type)
+{
+    switch (type)
+    {
+    case ImDrawVertAttribType_Short:            return GL_SHORT;
+    case ImDrawVertAttribType_UnsignedShort:    return GL_UNSIGNED_SHORT;
+    case ImDrawVertAttribType_UnsignedByte:     return GL_UNSIGNED_BYTE;
+    default:                                    return GL_FLOAT;
+    }
+}
+
+// Point a VAO at the ring buffers, the element buffer and attribute pointers are VAO state so this is redone on every (re)create.
+// The buffers hold ImDrawVertLayout vertices (imconfig.h), not ImDrawVert.
+static void ImGui_ImplSdlGL3_SetupVertexArray(GLuint vao)
+{
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
+    const ImDrawVertAttrib* attribs = ImDrawVertLayout::Attribs();
+    for (GLuint n = 0; n < 3; n++)
+    {
+        glVertexAttribPointer(n, attribs[n].Components, ImGui_ImplSdlGL3_AttribType(attribs[n].Type), attribs[n].Normalized ? GL_TRUE : GL_FALSE, sizeof(ImDrawVertLayout::Vert), (GLvoid*)(size_t)attribs[n].Offset);
+        glEnableVertexAttribArray(n);
+    }
+}
+
+// (Re)create the ring buffers and hook them up to our VAOs, leaves the last VAO bound.
+// Buffers created with glBufferStorage are immutable so growing always means new buffer objects.
+static void ImGui_ImplSdlGL3_CreateRingBuffers(int vtx_capacity, int idx_capacity)
+{
+    ImGui_ImplSdlGL3_DestroyRingBuffers();
+    g_RingVtxCapacity = vtx_capacity;
+    g_RingIdxCapacity = idx_capacity;
+    const GLsizeiptr vtx_size = (GLsizeiptr)(g_RingFrames + 1) * vtx_capacity * sizeof(ImDrawVertLayout::Vert);
+    const GLsizeiptr idx_size = (GLsizeiptr)(g_RingFrames + 1) * idx_capacity * sizeof(ImDrawIdx);
+    g_ListCache.Clear();
+
+    glGenBuffers(1, &g_VboHandle);
+    glGenBuffers(1, &g_ElementsHandle);
+    glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
+    if (g_RingPersistent)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, vtx_size, nullptr, flags);
+        glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, idx_size, nullptr, flags);
+        g_RingVtxData = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, vtx_size, flags);
+        g_RingIdxData = (char*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, idx_size, flags);
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, vtx_size, nullptr, GL_STREAM_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx_size, nullptr, GL_STREAM_DRAW);
+    }
+
+    ImGui_ImplSdlGL3_SetupVertexArray(g_VaoHandle);
+    if (g_IndirectVaoHandle)
+    {
+        ImGui_ImplSdlGL3_SetupVertexArray(g_IndirectVaoHandle);
+        glBindBuffer(GL_ARRAY_BUFFER, g_ClipRectHandle);
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(ImVec4), (GLvoid*)0);
+        glVertexAttribDivisor(3, 1);
+        glEnableVertexAttribArray(3);
+    }
+}
+
+// Pack every command list of the frame back to back, the draw loop walks the lists in the same order to find its offsets
+// Copy the lists flagged in g_ListSlots, changed lists go to the current segment (vtx_base / idx_base) and newly
+// resident ones to the resident region, which only ever takes writes into space no frame in flight uses
+static void ImGui_ImplSdlGL3_UploadDrawData(const ImDrawData* draw_data, int vtx_base, int idx_base)
+{
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    const int resident_vtx_base = g_RingFrames * g_RingVtxCapacity;
+    // Without persistent mapping each buffer is mapped on its own, only when this frame streams something into it
+    char* stream_vtx = NULL;
+    char* stream_idx = NULL;
+    const bool map_vtx = !g_RingPersistent && g_ListCache.StreamVtxCount > 0;
+    const bool map_idx = !g_RingPersistent && g_ListCache.StreamIdxCount > 0;
+    if (g_RingPersistent)
+    {
+        stream_vtx = g_RingVtxData + (GLintptr)vtx_base * sizeof(ImDrawVertLayout::Vert);
+        stream_idx = g_RingIdxData + (GLintptr)idx_base * sizeof(ImDrawIdx);
+    }
+    if (map_vtx)
+        stream_vtx = (char*)glMapBufferRange(GL_ARRAY_BUFFER, (GLintptr)vtx_base * sizeof(ImDrawVertLayout::Vert), (GLsizeiptr)g_ListCache.StreamVtxCount * sizeof(ImDrawVertLayout::Vert), access);
+    if (map_idx)
+        stream_idx = (char*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)idx_base * sizeof(ImDrawIdx), (GLsizeiptr)g_ListCache.StreamIdxCount * sizeof(ImDrawIdx), access);
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawListSlot& slot = g_ListSlots[n];
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        if (!slot.Upload || slot.VtxOffset >= resident_vtx_base)
+            continue;
+        if (cmd_list->VtxBuffer.Size > 0 && stream_vtx)
+            ImDrawVertWrite<ImDrawVertLayout>(stream_vtx + (GLintptr)(slot.VtxOffset - vtx_base) * sizeof(ImDrawVertLayout::Vert), cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size);
+        if (cmd_list->IdxBuffer.Size > 0 && stream_idx)
+            memcpy(stream_idx + (GLintptr)(slot.IdxOffset - idx_base) * sizeof(ImDrawIdx), cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+    }
+    if (map_vtx)
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    if (map_idx)
+        glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+
+    // Promotions are rare so each gets its own map when the buffers are not persistent
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
+        const ImDrawListSlot& slot = g_ListSlots[n];
         const ImDrawList* cmd_list = draw_data->CmdLists[n];
-        const ImDrawIdx* idx_buffer_offset = 0;
+        if (!slot.Upload || slot.VtxOffset < resident_vtx_base)
+            continue;
+        const GLintptr vtx_start = (GLintptr)slot.VtxOffset * sizeof(ImDrawVertLayout::Vert);
+        const GLintptr idx_start = (GLintptr)slot.IdxOffset * sizeof(ImDrawIdx);
+        const GLsizeiptr vtx_size = (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVertLayout::Vert);
+        const GLsizeiptr idx_size = (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
+        if (g_RingPersistent)
+        {
+            ImDrawVertWrite<ImDrawVertLayout>(g_RingVtxData + vtx_start, cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size);
+            memcpy(g_RingIdxData + idx_start, cmd_list->IdxBuffer.Data, idx_size);
+        }
+        else
+        {
+            if (vtx_size > 0)
+            {
+                ImDrawVertWrite<ImDrawVertLayout>(glMapBufferRange(GL_ARRAY_BUFFER, vtx_start, vtx_size, access), cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size);
+                glUnmapBuffer(GL_ARRAY_BUFFER);
+            }
+            if (idx_size > 0)
+            {
+                memcpy(glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, idx_start, idx_size, access), cmd_list->IdxBuffer.Data, idx_size);
+                glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+            }
+        }
+    }
+}
+
+// Point the bound program at texture unit 0 and the frame's projection, each program variant keeps its own uniforms
+static void ImGui_ImplSdlGL3_SetProgramUniforms()
+{
+    ngl::ShaderLib *shader = ngl::ShaderLib::instance();
+    shader->setUniform("Texture",0);
+    shader->setUniform("ProjMtx",g_ProjMtx);
+}
+
+// Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled (clipping is done in the
+// shader on the indirect path)
+static void ImGui_ImplSdlGL3_SetupRenderState(GLStateCache* state, GLsizei fb_width, GLsizei fb_height, bool indirect)
+{
+    state->enableBlend(true);
+    state->blendEquation(GL_FUNC_ADD);
+    if (g_LayerPass)
+        state->blendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    else
+        state->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state->enableCullFace(false);
+    state->enableDepthTest(false);
+    state->enableScissorTest(!indirect);
+    state->polygonMode(GL_FILL);
+    state->activeTexture(GL_TEXTURE0);
+
+    // Setup orthographic projection matrix, vertex positions are in 1 / PosScale() pixels
+    state->viewport(0, 0, fb_width, fb_height);
+    const float pos_scale = ImDrawVertLayout::PosScale();
+    g_ProjMtx = ngl::Mat4(
+         2.0f/(g_DisplaySize.x*pos_scale),  0.0f,                               0.0f, 0.0f,
+         0.0f,                              2.0f/(-g_DisplaySize.y*pos_scale),  0.0f, 0.0f,
+         0.0f,                              0.0f,                              -1.0f, 0.0f,
+        -1.0f,                              1.0f,                               0.0f, 1.0f
+    );
+    state->useProgram(indirect ? "IMGUIIndirect" : "IMGUI");
+    g_ProgramDistanceField = false;
+    ImGui_ImplSdlGL3_SetProgramUniforms();
+    state->bindVertexArray(indirect ? g_IndirectVaoHandle : g_VaoHandle);
+}
+
+// Bind the texture of a draw, with a distance field atlas the font texture is thresholded by the SDF variant of the program
+static void ImGui_ImplSdlGL3_BindTexture(GLStateCache* state, ImTextureID texture_id, bool indirect)
+{
+    const GLuint texture = (GLuint)(intptr_t)texture_id;
+    state->bindTexture2D(texture);
+    const bool distance_field = g_FontDistanceField && texture == g_FontTexture;
+    if (distance_field == g_ProgramDistanceField)
+        return;
+    if (distance_field)
+        state->useProgram(indirect ? "IMGUIIndirectSDF" : "IMGUISDF");
+    else
+        state->useProgram(indirect ? "IMGUIIndirect" : "IMGUI");
+    g_ProgramDistanceField = distance_field;
+    ImGui_ImplSdlGL3_SetProgramUniforms();
+}
+
+// Submit the compacted commands with one glMultiDrawElementsIndirect per texture run
+static void ImGui_ImplSdlGL3_RenderIndirect(GLStateCache* state, GLsizei fb_width, GLsizei fb_height)
+{
+    ImDrawCompactBuildIndirect(g_CompactCmds, 0, 0, g_IndirectCmds, g_IndirectClipRects, g_IndirectRuns, &g_DrawStats);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, g_IndirectHandle);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)g_IndirectCmds.Size * sizeof(ImDrawIndirectCmd), (const GLvoid*)g_IndirectCmds.Data, GL_STREAM_DRAW);
+    state->bindArrayBuffer(g_ClipRectHandle);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)g_IndirectClipRects.Size * sizeof(ImVec4), (const GLvoid*)g_IndirectClipRects.Data, GL_STREAM_DRAW);
+
+    for (const ImDrawIndirectRun* run = g_IndirectRuns.begin(); run != g_IndirectRuns.end(); run++)
+    {
+        if (run->UserCmd)
+        {
+            run->UserCmd->UserCmd->UserCallback(run->UserCmd->CmdList, run->UserCmd->UserCmd);
+            // we have no idea what the callback did to GL
+            state->invalidate();
+            ImGui_ImplSdlGL3_SetupRenderState(state, fb_width, fb_height, true);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, g_IndirectHandle);
+            continue;
+        }
+        ImGui_ImplSdlGL3_BindTexture(state, run->TextureId, true);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (const GLvoid*)(run->FirstCmd * sizeof(ImDrawIndirectCmd)), run->CmdCount, 0);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
 
-        glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
-        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.size() * sizeof(ImDrawVert), (GLvoid*)&cmd_list->VtxBuffer.front(), GL_STREAM_DRAW);
+// Draw the compacted commands of the frame, render state has to be set up. clip_rect (glScissor x, y, w, h) limits
+// drawing to part of the framebuffer, commands outside it are skipped
+static void ImGui_ImplSdlGL3_RenderCommands(GLStateCache* state, GLsizei fb_width, GLsizei fb_height, const int* clip_rect)
+{
+    if (g_UseIndirect)
+    {
+        // the shader clips each draw, the scissor only has to hold the region
+        if (clip_rect)
+        {
+            state->enableScissorTest(true);
+            state->scissor(clip_rect[0], clip_rect[1], clip_rect[2], clip_rect[3]);
+        }
+        // runs cross list boundaries, the layer pass times itself
+        if (!g_LayerPass)
+            GPUTimer::instance()->begin("UI");
+        ImGui_ImplSdlGL3_RenderIndirect(state, fb_width, fb_height);
+    }
+    else if (clip_rect)
+    {
+        // skipped commands may have been the ones binding a texture, so let the state cache drop the redundant binds
+        for (const ImDrawCompactCmd* cmd = g_CompactCmds.begin(); cmd != g_CompactCmds.end(); cmd++)
+        {
+            const int x1 = std::max(cmd->ClipRect[0], clip_rect[0]);
+            const int y1 = std::max(cmd->ClipRect[1], clip_rect[1]);
+            const int x2 = std::min(cmd->ClipRect[0] + cmd->ClipRect[2], clip_rect[0] + clip_rect[2]);
+            const int y2 = std::min(cmd->ClipRect[1] + cmd->ClipRect[3], clip_rect[1] + clip_rect[3]);
+            if (cmd->UserCmd || x1 >= x2 || y1 >= y2)
+                continue;
+            ImGui_ImplSdlGL3_BindTexture(state, cmd->TextureId, false);
+            state->scissor(x1, y1, x2 - x1, y2 - y1);
+            glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)cmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (const ImDrawIdx*)0 + cmd->IdxOffset, cmd->VtxOffset);
+        }
+    }
+    else
+    {
+        // one timer section per list (draws never merge across lists), the layer pass times itself
+        GPUTimer* timer = GPUTimer::instance();
+        const bool time_lists = timer->isEnabled() && !g_LayerPass;
+        const ImDrawList* timed_list = NULL;
+        for (const ImDrawCompactCmd* cmd = g_CompactCmds.begin(); cmd != g_CompactCmds.end(); cmd++)
+        {
+            if (time_lists && cmd->CmdList != timed_list)
+            {
+                timed_list = cmd->CmdList;
+                timer->begin(timed_list->_OwnerName ? timed_list->_OwnerName : "UI");
+            }
+            if (cmd->UserCmd)
+            {
+                cmd->UserCmd->UserCallback(cmd->CmdList, cmd->UserCmd);
+                // we have no idea what the callback did to GL
+                state->invalidate();
+                ImGui_ImplSdlGL3_SetupRenderState(state, fb_width, fb_height, false);
+                state->bindArrayBuffer(g_VboHandle);
+                continue;
+            }
+            if (cmd->BindTexture)
+                ImGui_ImplSdlGL3_BindTexture(state, cmd->TextureId, false);
+            if (cmd->SetScissor)
+                state->scissor(cmd->ClipRect[0], cmd->ClipRect[1], cmd->ClipRect[2], cmd->ClipRect[3]);
+            glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)cmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (const ImDrawIdx*)0 + cmd->IdxOffset, cmd->VtxOffset);
+        }
+    }
+}
+
+// (Re)create the layer texture / FBO at framebuffer size
+static void ImGui_ImplSdlGL3_CreateLayer(GLsizei fb_width, GLsizei fb_height)
+{
+    if (!g_LayerFbo)
+    {
+        glGenFramebuffers(1, &g_LayerFbo);
+        glGenTextures(1, &g_LayerTexture);
+    }
+    GLStateCache::instance()->bindTexture2D(g_LayerTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, fb_width, fb_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    GLint last_framebuffer;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &last_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_LayerFbo);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, g_LayerTexture, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, last_framebuffer);
+    g_LayerWidth = fb_width;
+    g_LayerHeight = fb_height;
+    g_LayerValid = false;
+}
+
+static void ImGui_ImplSdlGL3_DestroyLayer()
+{
+    if (g_LayerFbo) glDeleteFramebuffers(1, &g_LayerFbo);
+    if (g_LayerTexture) glDeleteTextures(1, &g_LayerTexture);
+    g_LayerFbo = g_LayerTexture = 0;
+    g_LayerWidth = g_LayerHeight = 0;
+    g_LayerValid = false;
+}
+
+// Redraw the part of the layer covered by the windows that changed, the whole layer when it is new or a user callback
+// (which can draw anything) is present
+static void ImGui_ImplSdlGL3_RenderLayer(GLStateCache* state, GLsizei fb_width, GLsizei fb_height)
+{
+    if (fb_width != g_LayerWidth || fb_height != g_LayerHeight)
+        ImGui_ImplSdlGL3_CreateLayer(fb_width, fb_height);
+    if (g_LayerValid && g_ListCache.FrameHash == g_LayerHash)
+        return;
+    bool full = !g_LayerValid;
+    for (const ImDrawCompactCmd* cmd = g_CompactCmds.begin(); cmd != g_CompactCmds.end() && !full; cmd++)
+        full = cmd->UserCmd != NULL;
+    int damage[4] = { 0, 0, fb_width, fb_height };
+    if (!full && !g_ListCache.DamageScissor(fb_width, fb_height, damage))
+        full = true;
+
+    // only paid when the UI changes, so the target framebuffer is simply queried
+    GLint last_framebuffer;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &last_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_LayerFbo);
+    state->enableScissorTest(!full);
+    if (!full)
+        state->scissor(damage[0], damage[1], damage[2], damage[3]);
+    const GLfloat transparent[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, transparent);
+    g_LayerPass = true;
+    ImGui_ImplSdlGL3_SetupRenderState(state, fb_width, fb_height, g_UseIndirect);
+    state->bindArrayBuffer(g_VboHandle);
+    ImGui_ImplSdlGL3_RenderCommands(state, fb_width, fb_height, full ? nullptr : damage);
+    g_LayerPass = false;
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, last_framebuffer);
+    g_LayerHash = g_ListCache.FrameHash;
+    g_LayerValid = true;
+}
+
+// Blend the premultiplied layer over whatever is in the framebuffer
+static void ImGui_ImplSdlGL3_CompositeLayer(GLStateCache* state, GLsizei fb_width, GLsizei fb_height)
+{
+    state->enableBlend(true);
+    state->blendEquation(GL_FUNC_ADD);
+    state->blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    state->enableScissorTest(false);
+    state->viewport(0, 0, fb_width, fb_height);
+    state->useProgram("IMGUIComposite");
+    ngl::ShaderLib::instance()->setUniform("Layer",0);
+    state->activeTexture(GL_TEXTURE0);
+    state->bindTexture2D(g_LayerTexture);
+    state->bindVertexArray(g_LayerVaoHandle);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+// Software path, the CPU draws the UI and GL only uploads and blends the result
+static void ImGui_ImplSdlSoft_RenderDrawData(ImDrawData* draw_data, const ImVec2& display_size, const ImVec2& fb_scale)
+{
+    GLsizei fb_width = GLsizei(display_size.x * fb_scale.x);
+    GLsizei fb_height = GLsizei(display_size.y * fb_scale.y);
+    if (fb_width == 0 || fb_height == 0)
+        return;
+    // GL textures start with the bottom row
+    g_SoftRaster.FlipY = true;
+    g_SoftRaster.Render(draw_data, display_size, fb_scale);
+
+    GLStateCache *state = GLStateCache::instance();
+    GPUTimer::instance()->begin("UI upload");
+    if (fb_width != g_LayerWidth || fb_height != g_LayerHeight)
+        ImGui_ImplSdlGL3_CreateLayer(fb_width, fb_height);
+    state->activeTexture(GL_TEXTURE0);
+    state->bindTexture2D(g_LayerTexture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, g_SoftRaster.Stride);
+#ifdef IMGUI_USE_BGRA_PACKED_COLOR
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, fb_width, fb_height, GL_BGRA, GL_UNSIGNED_BYTE, g_SoftRaster.Pixels.Data);
+#else
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, fb_width, fb_height, GL_RGBA, GL_UNSIGNED_BYTE, g_SoftRaster.Pixels.Data);
+#endif
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    // the layer holds the software frame now, a later GL layer pass has to redraw it all
+    g_LayerValid = false;
+    GPUTimer::instance()->begin("UI composite");
+    ImGui_ImplSdlGL3_CompositeLayer(state, fb_width, fb_height);
+    GPUTimer::instance()->end();
+}
+
+// The SDF variants of the programs, for a distance field font atlas
+static void ImGui_ImplSdlGL3_LoadDistanceFieldPrograms()
+{
+    if (g_DistanceFieldPrograms)
+        return;
+    ProgramCache* cache = ProgramCache::instance();
+    cache->loadProgram("IMGUISDF","IMGUIVertex","shaders/IMguiVertex.glsl","IMGUISDFFragment","shaders/IMguiSDFFragment.glsl");
+    if (g_IndirectSupported)
+        cache->loadProgram("IMGUIIndirectSDF","IMGUIIndirectVertex","shaders/IMguiIndirectVertex.glsl",
+                           "IMGUIIndirectSDFFragment","shaders/IMguiIndirectSDFFragment.glsl");
+    g_DistanceFieldPrograms = true;
+    // ShaderLib has switched program behind the state cache
+    GLStateCache::instance()->invalidate(GLStateCache::PROGRAM);
+}
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.size() * sizeof(ImDrawIdx), (GLvoid*)&cmd_list->IdxBuffer.front(), GL_STREAM_DRAW);
+// Upload the font updates made up to 'frame', into the texture and the rasterizer's copy of the atlas
+static void ImGui_ImplSdlGL3_UploadFontUpdates(int frame)
+{
+    std::lock_guard<std::mutex> lock(g_FontUpdatesMutex);
+    size_t count = 0;
+    for (; count < g_FontUpdates.size() && g_FontUpdates[count].Frame <= frame; count++)
+    {
+        const ImGuiImplSdlFontUpdate& update = g_FontUpdates[count];
+        const size_t pixels = update.Pixels.size();
+        std::vector<ImU32> rgba;
+        if (!g_FontAlpha8)
+        {
+            rgba.resize(pixels);
+            for (size_t i = 0; i < pixels; i++)
+                rgba[i] = IM_COL32(255, 255, 255, update.Pixels[i]);
+        }
+        // without a context only the rasterizer's copy is updated, a distance field switch rebuilds it whole instead
+        if (!g_NoGL)
+        {
+            GLStateCache *state = GLStateCache::instance();
+            state->activeTexture(GL_TEXTURE0);
+            state->bindTexture2D(g_FontTexture);
+            if (update.Rebuild)
+            {
+                // same texture name, so commands recorded before the switch need no change and the frames before it are already drawn
+                if (update.Spread > 0.0f)
+                    ImGui_ImplSdlGL3_LoadDistanceFieldPrograms();
+                if (g_FontAlpha8)
+                    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, update.Width, update.Height, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+                else
+                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, update.Width, update.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+                g_FontWidth = update.Width;
+                g_FontDistanceField = update.Spread > 0.0f;
+                if (g_SoftFontPixels.Size > 0)
+                {
+                    g_SoftFontPixels.resize(update.Width * update.Height * (g_FontAlpha8 ? 1 : 4));
+                    g_SoftRaster.SetTexture((ImTextureID)(intptr_t)g_FontTexture, g_SoftFontPixels.Data, update.Width, update.Height, g_FontAlpha8 ? 1 : 4, update.Spread);
+                }
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            if (g_FontAlpha8)
+                glTexSubImage2D(GL_TEXTURE_2D, 0, update.X, update.Y, update.Width, update.Height, GL_RED, GL_UNSIGNED_BYTE, update.Pixels.data());
+            else
+                glTexSubImage2D(GL_TEXTURE_2D, 0, update.X, update.Y, update.Width, update.Height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
 
-        for (const ImDrawCmd* pcmd = cmd_list->CmdBuffer.begin(); pcmd != cmd_list->CmdBuffer.end(); pcmd++)
+        if (g_SoftFontPixels.Size > 0)
         {
-          if (pcmd->UserCallback)
-          {
-            pcmd->UserCallback(cmd_list, pcmd);
-          }
-          else
-          {
-            glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->TextureId);
-            glScissor((int)pcmd->ClipRect.x, (int)(fb_height - pcmd->ClipRect.w), (int)(pcmd->ClipRect.z - pcmd->ClipRect.x), (int)(pcmd->ClipRect.w - pcmd->ClipRect.y));
-            glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, idx_buffer_offset);
-          }
-         idx_buffer_offset += pcmd->ElemCount;
+            const size_t bytes_per_pixel = g_FontAlpha8 ? 1 : 4;
+            const unsigned char* src = g_FontAlpha8 ? update.Pixels.data() : (const unsigned char*)rgba.data();
+            for (int y = 0; y < update.Height; y++)
+                memcpy(g_SoftFontPixels.Data + ((size_t)(update.Y + y) * g_FontWidth + update.X) * bytes_per_pixel,
+                       src + (size_t)(y * update.Width) * bytes_per_pixel, (size_t)update.Width * bytes_per_pixel);
         }
     }
+    g_FontUpdates.erase(g_FontUpdates.begin(), g_FontUpdates.begin() + count);
+}
+
+// What ImGui_ImplSdlGL3_CreateFontsTexture() does without a context: the atlas only goes to the rasterizer, which just
+// needs a TexID no other texture uses
+static void ImGui_ImplSdlSoft_CreateFontsTexture()
+{
+    ImGuiIO& io = ImGui::GetIO();
+    unsigned char* pixels;
+    int width, height;
+    if (g_FontAlpha8)
+        io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+    else
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    const int bytes_per_pixel = g_FontAlpha8 ? 1 : 4;
+    g_SoftFontPixels.resize(width * height * bytes_per_pixel);
+    memcpy(g_SoftFontPixels.Data, pixels, (size_t)g_SoftFontPixels.Size);
+    io.Fonts->TexID = (void *)&g_SoftFontPixels;
+    g_FontWidth = width;
+    g_FontDistanceField = io.Fonts->TexDistanceField;
+    {
+        std::lock_guard<std::mutex> lock(g_FontUpdatesMutex);
+        g_FontUpdates.clear();
+    }
+    const float spread = io.Fonts->TexDistanceField ? (float)std::max(io.Fonts->TexDistanceFieldSpread, 1) : 0.0f;
+    g_SoftRaster.SetTexture(io.Fonts->TexID, g_SoftFontPixels.Data, width, height, bytes_per_pixel, spread);
+    if (!io.Fonts->HasGlyphsOnDemand())
+        io.Fonts->ClearTexData();
+}
+
+// Render the glyphs the last frame asked for, on the thread building the frames before ImGui::NewFrame()
+static void ImGui_ImplSdlGL3_UpdateGlyphsOnDemand()
+{
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    ImGuiImplSdlFontUpdate update;
+    if (!atlas->UpdateGlyphsOnDemand(&update.X, &update.Y, &update.Width, &update.Height))
+        return;
+    // the frame about to start is the first one looking the new glyphs up
+    update.Frame = ImGui::GetFrameCount() + 1;
+    update.Rebuild = false;
+    update.Spread = 0.0f;
+    update.Pixels.resize((size_t)(update.Width * update.Height));
+    for (int y = 0; y < update.Height; y++)
+        memcpy(&update.Pixels[(size_t)(y * update.Width)], atlas->TexPixelsAlpha8 + (update.Y + y) * atlas->TexWidth + update.X, (size_t)update.Width);
+    std::lock_guard<std::mutex> lock(g_FontUpdatesMutex);
+    g_FontUpdates.push_back(std::move(update));
+}
+
+// Carry out ImGuiImplSdlSetFontDistanceField() between two frames. The atlas is built again here and its pixels replace the
+// texture when the render side reaches the frame, snapshots taken before still draw with the glyphs they looked up.
+static void ImGui_ImplSdlGL3_UpdateFontDistanceField()
+{
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    const int request = g_FontDistanceFieldRequest;
+    g_FontDistanceFieldRequest = -1;
+    if (request < 0 || (request != 0) == atlas->TexDistanceField)
+        return;
+    atlas->TexDistanceField = request != 0;
+    // the pixels may still be around for glyphs on demand, without a texture yet creating it builds the atlas
+    atlas->ClearTexData();
+    if (g_NoGL)
+    {
+        // the frame before is already rasterized, nothing else holds on to the old atlas
+        ImGui_ImplSdlSoft_CreateFontsTexture();
+        return;
+    }
+    if (!g_FontTexture)
+        return;
+    ImGuiImplSdlFontUpdate update;
+    unsigned char* pixels;
+    atlas->GetTexDataAsAlpha8(&pixels, &update.Width, &update.Height);
+    update.Frame = ImGui::GetFrameCount() + 1;
+    update.X = update.Y = 0;
+    update.Rebuild = true;
+    update.Spread = atlas->TexDistanceField ? (float)std::max(atlas->TexDistanceFieldSpread, 1) : 0.0f;
+    update.Pixels.assign(pixels, pixels + (size_t)(update.Width * update.Height));
+    if (!atlas->HasGlyphsOnDemand())
+        atlas->ClearTexData();
+    std::lock_guard<std::mutex> lock(g_FontUpdatesMutex);
+    g_FontUpdates.push_back(std::move(update));
+}
+
+// No context at all, the frame stays in g_SoftRaster top row first for ImGuiImplSdlGetSoftwareFrame()
+static void ImGui_ImplSdlSoft_RenderDrawListsNoGL(ImDrawData* draw_data)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    ImGui_ImplSdlGL3_UploadFontUpdates(ImGui::GetFrameCount());
+    g_SoftRaster.FlipY = false;
+    g_SoftRaster.Render(draw_data, io.DisplaySize, io.DisplayFramebufferScale);
+}
+
+static void ImGui_ImplSdlSoft_RenderDrawLists(ImDrawData* draw_data)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    ImGui_ImplSdlGL3_UploadFontUpdates(ImGui::GetFrameCount());
+    ImGui_ImplSdlSoft_RenderDrawData(draw_data, io.DisplaySize, io.DisplayFramebufferScale);
+}
+
+// This is the main rendering function that you have to implement and provide to ImGui (via setting up 'RenderDrawListsFn' in the ImGuiIO structure)
+// If text or lines are blurry when integrating ImGui in your engine:
+// - in your Render function, try translating your projection matrix by (0.5f,0.5f) or (0.375f,0.375f)
+static void ImGui_ImplSdlGL3_RenderDrawData(ImDrawData* draw_data, const ImVec2& display_size, const ImVec2& fb_scale)
+{
+    // Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer coordinates)
+    GLsizei fb_width = GLsizei(display_size.x * fb_scale.x);
+    GLsizei fb_height = GLsizei(display_size.y * fb_scale.y);
+    if (fb_width == 0 || fb_height == 0)
+        return;
+    g_DisplaySize = display_size;
+    draw_data->ScaleClipRects(fb_scale);
+
+    // Setup render state, the scene asks the same cache for its own state so nothing needs to be queried, backed up or restored here
+    GLStateCache *state = GLStateCache::instance();
+    ImGui_ImplSdlGL3_SetupRenderState(state, fb_width, fb_height, g_UseIndirect);
+
+    // Grow the ring if this frame does not fit in a segment, then wait until the GPU has finished with the segment we reuse
+    if (draw_data->TotalVtxCount > g_RingVtxCapacity || draw_data->TotalIdxCount > g_RingIdxCapacity)
+    {
+        int vtx_capacity = g_RingVtxCapacity, idx_capacity = g_RingIdxCapacity;
+        while (vtx_capacity < draw_data->TotalVtxCount) vtx_capacity *= 2;
+        while (idx_capacity < draw_data->TotalIdxCount) idx_capacity *= 2;
+        ImGui_ImplSdlGL3_CreateRingBuffers(vtx_capacity, idx_capacity);
+        state->invalidate(GLStateCache::VERTEX_ARRAY);
+        state->bindVertexArray(g_UseIndirect ? g_IndirectVaoHandle : g_VaoHandle);
+    }
+    ImGui_ImplSdlGL3_WaitRingFence(g_RingFrame);
+    state->bindArrayBuffer(g_VboHandle);
+
+    // Work out which lists changed since last frame, only those are uploaded, the rest is drawn from where it already is
+    const int vtx_base = g_RingFrame * g_RingVtxCapacity;
+    const int idx_base = g_RingFrame * g_RingIdxCapacity;
+    if (g_ListCache.Update(draw_data, fb_scale, vtx_base, idx_base, g_RingFrames * g_RingVtxCapacity, g_RingFrames * g_RingIdxCapacity, g_RingVtxCapacity, g_RingIdxCapacity, g_ListSlots, &g_ListCacheStats))
+    {
+        // the resident region is being recycled, nothing drawn from it may still be in flight
+        for (int i = 0; i < g_RingFrames; i++)
+            ImGui_ImplSdlGL3_WaitRingFence(i);
+    }
+    ImGui_ImplSdlGL3_UploadDrawData(draw_data, vtx_base, idx_base);
+
+    // Compact the commands first, this drops redundant texture binds / scissors and merges draws with identical state
+    ImDrawCompactCommands(draw_data, fb_height, g_CompactCmds, &g_DrawStats, g_ListSlots.Data);
+    GPUTimer* timer = GPUTimer::instance();
+    if (!g_UseLayer)
+    {
+        ImGui_ImplSdlGL3_RenderCommands(state, fb_width, fb_height, nullptr);
+    }
+    else
+    {
+        timer->begin("UI layer");
+        ImGui_ImplSdlGL3_RenderLayer(state, fb_width, fb_height);
+        timer->begin("UI composite");
+        ImGui_ImplSdlGL3_CompositeLayer(state, fb_width, fb_height);
+    }
+    timer->end();
+    g_RingFences[g_RingFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    g_RingFrame = (g_RingFrame + 1) % g_RingFrames;
+}
+
+void ImGui_ImplSdlGL3_RenderDrawLists(ImDrawData* draw_data)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    ImGui_ImplSdlGL3_UploadFontUpdates(ImGui::GetFrameCount());
+    ImGui_ImplSdlGL3_RenderDrawData(draw_data, io.DisplaySize, io.DisplayFramebufferScale);
+}
 
-    // Restore modified GL state
-    glUseProgram(last_program);
-    glActiveTexture(last_active_texture);
-   // glBindTexture(GL_TEXTURE_2D, last_texture);
-    glBindVertexArray(last_vertex_array);
-    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, last_element_array_buffer);
-    glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-    glBlendFunc(last_blend_src, last_blend_dst);
-    if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-    if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-    if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-    if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
-    glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
+void ImGuiImplSdlRenderSnapshot(ImDrawSnapshot& snapshot)
+{
+    ImGui_ImplSdlGL3_UploadFontUpdates(snapshot.FrameCount);
+    if (g_UseSoftware)
+        ImGui_ImplSdlSoft_RenderDrawData(&snapshot.DrawData, snapshot.DisplaySize, snapshot.FramebufferScale);
+    else
+        ImGui_ImplSdlGL3_RenderDrawData(&snapshot.DrawData, snapshot.DisplaySize, snapshot.FramebufferScale);
+}
+
+const ImDrawCompactStats& ImGuiImplSdlGetDrawStats()
+{
+    return g_DrawStats;
+}
+
+void ImGuiImplSdlSetFontAlpha8(bool enable)
+{
+    if (enable == g_FontAlpha8)
+        return;
+    g_FontAlpha8 = enable;
+    // the next ImGuiImplSdlNewFrame recreates the font texture in the new format
+    if (g_NoGL)
+        g_SoftFontPixels.clear();
+    if (g_FontTexture)
+        ImGuiImplSdlInvalidateDeviceObjects();
+}
+
+void ImGuiImplSdlSetFontDistanceField(bool enable)
+{
+    // the frame being built still looks glyphs up in the current atlas, the next ImGuiImplSdlNewFrame rebuilds it
+    g_FontDistanceFieldRequest = enable ? 1 : 0;
+}
+
+const ImDrawListCacheStats& ImGuiImplSdlGetListCacheStats()
+{
+    return g_ListCacheStats;
+}
+
+void ImGuiImplSdlSetUiLayer(bool enable)
+{
+    g_UseLayer = enable;
+    g_LayerValid = false;
+}
+
+bool ImGuiImplSdlSetMultiDrawIndirect(bool enable)
+{
+    g_UseIndirect = enable && g_IndirectSupported;
+    return g_UseIndirect;
+}
+
+void ImGuiImplSdlSetSoftwareRenderer(bool enable)
+{
+    // without a context the rasterizer is all there is
+    if (enable == g_UseSoftware || g_NoGL)
+        return;
+    g_UseSoftware = enable;
+    // no RenderDrawListsFn when the frames go through ImGuiImplSdlRenderSnapshot()
+    ImGuiIO& io = ImGui::GetIO();
+    if (io.RenderDrawListsFn)
+        io.RenderDrawListsFn = enable ? ImGui_ImplSdlSoft_RenderDrawLists : ImGui_ImplSdlGL3_RenderDrawLists;
+    if (!enable)
+        g_SoftFontPixels.clear();
+    // the next ImGuiImplSdlNewFrame recreates the font texture, keeping a copy of the atlas for the rasterizer
+    if (g_FontTexture)
+        ImGuiImplSdlInvalidateDeviceObjects();
+}
+
+const ImDrawRaster& ImGuiImplSdlGetSoftwareFrame()
+{
+    return g_SoftRaster;
 }
 
 static const char* ImGui_ImplSdlGL3_GetClipboardText(void *)
@@ -174,7 +904,10 @@ void ImGui_ImplSdlGL3_CreateFontsTexture()
     ImGuiIO& io = ImGui::GetIO();
     unsigned char* pixels;
     int width, height;
-    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);   // Load as RGBA 32-bits for OpenGL3 demo because it is more likely to be compatible with user's existing shader.
+    if (g_FontAlpha8)
+        io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+    else
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);   // Load as RGBA 32-bits for OpenGL3 demo because it is more likely to be compatible with user's existing shader.
 
     // Upload texture to graphics system
     GLint last_texture;
@@ -183,10 +916,41 @@ void ImGui_ImplSdlGL3_CreateFontsTexture()
     glBindTexture(GL_TEXTURE_2D, g_FontTexture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    if (g_FontAlpha8)
+    {
+        // A quarter of the memory, the swizzle makes the red channel read back as (1,1,1,alpha) so the shader is unchanged
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_ONE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_ONE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_ONE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    else
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
 
-    // Store our identifier
+    // Store our identifier, the GPU has its copy so the CPU side pixels can go (they are rebuilt if the device objects are recreated).
+    // Glyphs on demand are rendered into them later, then they stay. The texture has every update made so far, none is pending.
     io.Fonts->TexID = (void *)(intptr_t)g_FontTexture;
+    g_FontWidth = width;
+    g_FontDistanceField = io.Fonts->TexDistanceField;
+    {
+        std::lock_guard<std::mutex> lock(g_FontUpdatesMutex);
+        g_FontUpdates.clear();
+    }
+    if (g_UseSoftware)
+    {
+        const int bytes_per_pixel = g_FontAlpha8 ? 1 : 4;
+        g_SoftFontPixels.resize(width * height * bytes_per_pixel);
+        memcpy(g_SoftFontPixels.Data, pixels, (size_t)g_SoftFontPixels.Size);
+        const float spread = io.Fonts->TexDistanceField ? (float)std::max(io.Fonts->TexDistanceFieldSpread, 1) : 0.0f;
+        g_SoftRaster.SetTexture(io.Fonts->TexID, g_SoftFontPixels.Data, width, height, bytes_per_pixel, spread);
+    }
+    if (!io.Fonts->HasGlyphsOnDemand())
+        io.Fonts->ClearTexData();
 
     // Restore state
     glBindTexture(GL_TEXTURE_2D, last_texture);
@@ -202,63 +966,61 @@ bool ImGuiImplSdlGL3CreateDeviceObjects()
   // now to load the shader and set the values
   // grab an instance of shader manager
   ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-  // we are creating a shader called Phong here we create some
-  // aliases as constexpr to avoid typos later
+  // the programs come from the binary cache when the sources and driver are unchanged since the last run
+  ProgramCache *cache=ProgramCache::instance();
   constexpr auto ShaderName="IMGUI";
-  constexpr auto VertexName="IMGUIVertex";
-  constexpr auto FragmentName="IMGUIFragment";
-
-  shader->createShaderProgram(ShaderName);
-  // now we are going to create empty shaders for Frag and Vert
-  shader->attachShader(VertexName,ngl::ShaderType::VERTEX);
-  shader->attachShader(FragmentName,ngl::ShaderType::FRAGMENT);
-  // attach the source
-  shader->loadShaderSource(VertexName,"shaders/IMguiVertex.glsl");
-  shader->loadShaderSource(FragmentName,"shaders/IMguiFragment.glsl");
-  // compile the shaders
-  shader->compileShader(VertexName);
-  shader->compileShader(FragmentName);
-  // add them to the program
-  shader->attachShaderToProgram(ShaderName,VertexName);
-  shader->attachShaderToProgram(ShaderName,FragmentName);
-
-  // now we have associated this data we can link the shader
-  shader->linkProgramObject(ShaderName);
+  cache->loadProgram(ShaderName,"IMGUIVertex","shaders/IMguiVertex.glsl","IMGUIFragment","shaders/IMguiFragment.glsl");
   // and make it active ready to load values
   (*shader)[ShaderName]->use();
 
-  glGenBuffers(1, &g_VboHandle);
-  glGenBuffers(1, &g_ElementsHandle);
+  // the multi-draw-indirect program and buffers need GL 4.3
+  g_IndirectSupported = ImGui_ImplSdlGL3_GLVersion() >= 43;
+  if (g_IndirectSupported)
+  {
+    cache->loadProgram("IMGUIIndirect","IMGUIIndirectVertex","shaders/IMguiIndirectVertex.glsl",
+                       "IMGUIIndirectFragment","shaders/IMguiIndirectFragment.glsl");
+    glGenVertexArrays(1, &g_IndirectVaoHandle);
+    glGenBuffers(1, &g_IndirectHandle);
+    glGenBuffers(1, &g_ClipRectHandle);
+  }
+  // a distance field font atlas is drawn with variants thresholding its alpha, loaded when first needed
+  g_DistanceFieldPrograms=false;
+  if (ImGui::GetIO().Fonts->TexDistanceField)
+    ImGui_ImplSdlGL3_LoadDistanceFieldPrograms();
+
+  // full-screen triangle used to composite the cached UI layer, the vertices come from gl_VertexID so its VAO stays empty
+  cache->loadProgram("IMGUIComposite","IMGUICompositeVertex","shaders/IMguiCompositeVertex.glsl",
+                     "IMGUICompositeFragment","shaders/IMguiCompositeFragment.glsl");
+  glGenVertexArrays(1, &g_LayerVaoHandle);
 
   glGenVertexArrays(1, &g_VaoHandle);
-  glBindVertexArray(g_VaoHandle);
-  glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
-
-  #define OFFSETOF(TYPE, ELEMENT) ((size_t)&(((TYPE *)0)->ELEMENT))
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, pos));
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, uv));
-    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, col));
-  #undef OFFSETOF
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  glEnableVertexAttribArray(2);
+  // start with room for 64K vertices a frame, the ring grows on demand
+  g_RingPersistent = ImGui_ImplSdlGL3_HasBufferStorage();
+  ImGui_ImplSdlGL3_CreateRingBuffers(64 * 1024, 128 * 1024);
 
   ImGui_ImplSdlGL3_CreateFontsTexture();
 
-  // Restore modified GL state
+  // Restore modified GL state, ShaderLib has switched program so the state cache has to forget it
   glBindTexture(GL_TEXTURE_2D, last_texture);
   glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
   glBindVertexArray(last_vertex_array);
+  GLStateCache::instance()->invalidate(GLStateCache::PROGRAM);
 
   return true;
 }
 
 void    ImGuiImplSdlInvalidateDeviceObjects()
 {
+    ImGui_ImplSdlGL3_DestroyRingBuffers();
     if (g_VaoHandle) glDeleteVertexArrays(1, &g_VaoHandle);
-    if (g_VboHandle) glDeleteBuffers(1, &g_VboHandle);
-    if (g_ElementsHandle) glDeleteBuffers(1, &g_ElementsHandle);
-    g_VaoHandle = g_VboHandle = g_ElementsHandle = 0;
+    if (g_IndirectVaoHandle) glDeleteVertexArrays(1, &g_IndirectVaoHandle);
+    if (g_IndirectHandle) glDeleteBuffers(1, &g_IndirectHandle);
+    if (g_ClipRectHandle) glDeleteBuffers(1, &g_ClipRectHandle);
+    g_VaoHandle = g_IndirectVaoHandle = g_IndirectHandle = g_ClipRectHandle = 0;
+    if (g_LayerVaoHandle) glDeleteVertexArrays(1, &g_LayerVaoHandle);
+    g_LayerVaoHandle = 0;
+    ImGui_ImplSdlGL3_DestroyLayer();
+    GLStateCache::instance()->invalidate(GLStateCache::VERTEX_ARRAY | GLStateCache::TEXTURE);
     if (g_FontTexture)
     {
         glDeleteTextures(1, &g_FontTexture);
@@ -293,6 +1055,8 @@ bool    ImGuiImplSdlInit(SDL_Window* window)
     io.RenderDrawListsFn = ImGui_ImplSdlGL3_RenderDrawLists;   // Alternatively you can set this to NULL and call ImGui::GetDrawData() after ImGui::Render() to get the same ImDrawData pointer.
     io.SetClipboardTextFn = ImGui_ImplSdlGL3_SetClipboardText;
     io.GetClipboardTextFn = ImGui_ImplSdlGL3_GetClipboardText;
+    // keep the built font atlas next to imgui.ini, later runs load it instead of rasterizing the fonts again
+    io.Fonts->BuildCacheFilename = "imgui_fonts.bin";
 
 #ifdef _WIN32
     SDL_SysWMinfo wmInfo;
@@ -306,9 +1070,25 @@ bool    ImGuiImplSdlInit(SDL_Window* window)
     return true;
 }
 
+bool    ImGuiImplSdlInitNoGL()
+{
+    ImGuiImplSdlInit(NULL);
+    g_NoGL = true;
+    g_UseSoftware = true;
+    ImGui::GetIO().RenderDrawListsFn = ImGui_ImplSdlSoft_RenderDrawListsNoGL;
+    return true;
+}
+
+void ImGuiImplSdlCreateMissingDeviceObjects()
+{
+    if (!g_FontTexture)
+        ImGuiImplSdlGL3CreateDeviceObjects();
+}
+
 void ImGuiImplSdlShutdown()
 {
-    ImGuiImplSdlInvalidateDeviceObjects();
+    if (!g_NoGL)
+        ImGuiImplSdlInvalidateDeviceObjects();
     ImGui::Shutdown();
 }
 
@@ -352,5 +1132,35 @@ void ImGuiImplSdlNewFrame(SDL_Window* window)
     SDL_ShowCursor(io.MouseDrawCursor ? 0 : 1);
 
     // Start the frame
+    ImGui_ImplSdlGL3_UpdateFontDistanceField();
+    ImGui_ImplSdlGL3_UpdateGlyphsOnDemand();
+    ImGui::NewFrame();
+}
+
+void ImGuiImplSdlNewFrameHeadless(int width, int height, float delta_time)
+{
+    if (g_NoGL)
+    {
+        if (g_SoftFontPixels.Size == 0)
+            ImGui_ImplSdlSoft_CreateFontsTexture();
+    }
+    else if (!g_FontTexture)
+    {
+        ImGuiImplSdlGL3CreateDeviceObjects();
+    }
+
+    ImGuiIO& io = ImGui::GetIO();
+
+    // No window to query, the caller renders into a framebuffer of this size with a fixed time step so runs repeat
+    io.DisplaySize = ImVec2((float)width, (float)height);
+    io.DisplayFramebufferScale = ImVec2(1.0f, 1.0f);
+    io.DeltaTime = delta_time;
+    io.MousePos = ImVec2(-1, -1);
+    io.MouseDown[0] = io.MouseDown[1] = io.MouseDown[2] = false;
+    io.MouseWheel = 0.0f;
+
+    // Start the frame
+    ImGui_ImplSdlGL3_UpdateFontDistanceField();
+    ImGui_ImplSdlGL3_UpdateGlyphsOnDemand();
     ImGui::NewFrame();
 }
@@ -1,4 +1,7 @@
 #include "NGLDraw.h"
+#include "GLStateCache.h"
+#include "GPUTimer.h"
+#include "ProgramCache.h"
 #include <ngl/ShaderLib.h>
 #include <ngl/NGLInit.h>
 #include <ngl/Transformation.h>
@@ -9,40 +12,16 @@ const static float ZOOM=0.05f;
 NGLDraw::NGLDraw()
 {
   m_rotate=false;
-  // mouse rotation values set to 0
-  m_spinXFace=0;
-  m_spinYFace=0;
-
-  glClearColor(0.4f, 0.4f, 0.4f, 1.0f);			   // Grey Background
-  // enable depth testing for drawing
-  glEnable(GL_DEPTH_TEST);
-   // now to load the shader and set the values
-  // grab an instance of shader manager
-  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-  // we are creating a shader called Phong here we create some
-  // aliases as constexpr to avoid typos later
+  // enable depth testing for drawing, all state goes through the cache shared with the ImGui renderer
+  GLStateCache *state=GLStateCache::instance();
+  state->enableDepthTest(true);
+  // load the shader from the binary cache, or compile and link it when the cache is stale
   constexpr auto ShaderName="Phong";
-  constexpr auto VertexName="PhongVertex";
-  constexpr auto FragmentName="PhongFragment";
-
-  shader->createShaderProgram(ShaderName);
-  // now we are going to create empty shaders for Frag and Vert
-  shader->attachShader(VertexName,ngl::ShaderType::VERTEX);
-  shader->attachShader(FragmentName,ngl::ShaderType::FRAGMENT);
-  // attach the source
-  shader->loadShaderSource(VertexName,"shaders/PhongVertex.glsl");
-  shader->loadShaderSource(FragmentName,"shaders/PhongFragment.glsl");
-  // compile the shaders
-  shader->compileShader(VertexName);
-  shader->compileShader(FragmentName);
-  // add them to the program
-  shader->attachShaderToProgram(ShaderName,VertexName);
-  shader->attachShaderToProgram(ShaderName,FragmentName);
-
-  // now we have associated this data we can link the shader
-  shader->linkProgramObject(ShaderName);
+  ProgramCache::instance()->loadProgram(ShaderName,"PhongVertex","shaders/PhongVertex.glsl",
+                                        "PhongFragment","shaders/PhongFragment.glsl");
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
   // and make it active ready to load values
-  (*shader)[ShaderName]->use();
+  state->useProgram(ShaderName);
   // Now we will create a basic Camera from the graphics library
   // This is a static camera so it only needs to be set once
   // First create Values for the camera position
@@ -55,6 +34,7 @@ NGLDraw::NGLDraw()
   // The final two are near and far clipping planes of 0.5 and 10
   m_project=ngl::perspective(45.0f,720.0f/576.0f,0.05f,350.0f);
   shader->setUniform("viewerPos",from);
+  // the light and material are uploaded by draw()
   setLight(ngl::Vec4(-2.0f,5.0f,2.0f),ngl::Vec4::zero(),ngl::Vec4(1.0f,1.0f,1.0f),ngl::Vec4(1.0f,1.0f,1.0f));
 
   setMaterial({0.274725f,0.1995f,0.0745f},{0.628281f, 0.555802f,0.3666065f},{0.75164f,0.60648f,0.22648f},51.2f);
@@ -66,45 +46,53 @@ NGLDraw::~NGLDraw()
   std::cout<<"Shutting down NGL, removing VAO's and Shaders\n";
 }
 
-void NGLDraw::resize(int _w, int _h)
-{
-  glViewport(0,0,_w,_h);
-  // now set the camera size values as the screen size has changed
-  m_project=ngl::perspective(45.0f,static_cast<float>(_w)/_h,0.05f,350.0f);
-}
-
-void NGLDraw::draw()
+void NGLDraw::draw(const SceneParams &_params)
 {
+  // the ImGui pass leaves its own state behind so ask for ours, the cache only emits what differs
+  GLStateCache *state=GLStateCache::instance();
+  GPUTimer::instance()->begin("Scene");
+  state->viewport(0,0,_params.width,_params.height);
+  // set the camera size values as the screen size may have changed
+  m_project=ngl::perspective(45.0f,static_cast<float>(_params.width)/_params.height,0.05f,350.0f);
+  glClearColor(_params.clearColour.m_r,_params.clearColour.m_g,_params.clearColour.m_b,_params.clearColour.m_a);
+  state->enableBlend(false);
+  state->enableScissorTest(false);
+  state->enableDepthTest(true);
   // clear the screen and depth buffer
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  // grab an instance of the shader manager
+  // make the Phong shader active
+  state->useProgram("Phong");
   ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-  (*shader)["Phong"]->use();
+  shader->setUniform("light.position",_params.lightPosition);
+  shader->setUniform("light.ambient",_params.lightAmbient);
+  shader->setUniform("light.specular",_params.lightSpecular);
+  shader->setUniform("light.diffuse",_params.lightDiffuse);
+  shader->setUniform("material.ambient",_params.materialAmbient);
+  shader->setUniform("material.specular",_params.materialSpecular);
+  shader->setUniform("material.diffuse",_params.materialDiffuse);
+  shader->setUniform("material.shininess",_params.specPower);
 
   // Rotation based on the mouse position for our global transform
   ngl::Transformation trans;
   ngl::Mat4 rotX;
   ngl::Mat4 rotY;
   // create the rotation matrices
-  rotX.rotateX(m_spinXFace);
-  rotY.rotateY(m_spinYFace);
+  rotX.rotateX(_params.spinXFace);
+  rotY.rotateY(_params.spinYFace);
   // multiply the rotations
   m_mouseGlobalTX=rotY*rotX;
   // add the translations
-  m_mouseGlobalTX.m_m[3][0] = m_modelPos.m_x;
-  m_mouseGlobalTX.m_m[3][1] = m_modelPos.m_y;
-  m_mouseGlobalTX.m_m[3][2] = m_modelPos.m_z;
+  m_mouseGlobalTX.m_m[3][0] = _params.modelPos.m_x;
+  m_mouseGlobalTX.m_m[3][1] = _params.modelPos.m_y;
+  m_mouseGlobalTX.m_m[3][2] = _params.modelPos.m_z;
 
    // get the VBO instance and draw the built in teapot
   ngl::VAOPrimitives *prim=ngl::VAOPrimitives::instance();
   // draw
-  loadMatricesToShader();
-  if(m_wireframe)
-    glPolygonMode(GL_FRONT_AND_BACK,GL_LINE);
-  else
-    glPolygonMode(GL_FRONT_AND_BACK,GL_FILL);
-  switch(m_modelID)
+  loadMatricesToShader(_params);
+  state->polygonMode(_params.wireframe ? GL_LINE : GL_FILL);
+  switch(_params.modelID)
    {
     case 0 : m_localScale.scale(1.0f, 1.0f, 1.0f); prim->draw("teapot"); break;
     case 1 : m_localScale.scale(1.0f, 1.0f, 1.0f); prim->draw("troll"); break;
@@ -114,10 +102,12 @@ void NGLDraw::draw()
     case 5 : m_localScale.scale(1.0f, 1.0f, 1.0f); prim->draw("cube"); break;
 
   }
-  glPolygonMode(GL_FRONT_AND_BACK,GL_FILL);
+  // VAOPrimitives binds (and unbinds) its own VAO
+  state->invalidate(GLStateCache::VERTEX_ARRAY);
+  GPUTimer::instance()->end();
 }
 
-void NGLDraw::loadMatricesToShader()
+void NGLDraw::loadMatricesToShader(const SceneParams &_params)
 {
   ngl::ShaderLib *shader=ngl::ShaderLib::instance();
 
@@ -126,9 +116,9 @@ void NGLDraw::loadMatricesToShader()
   ngl::Mat3 normalMatrix;
   ngl::Mat4 M;
   ngl::Transformation t;
-  t.setRotation(m_modelRot);
-  t.setPosition(m_modelPosition);
-  t.setScale(m_modelScale);
+  t.setRotation(_params.modelRot);
+  t.setPosition(_params.modelPosition);
+  t.setScale(_params.modelScale);
   M=m_mouseGlobalTX*t.getMatrix()*m_localScale;
   MV=  m_view*M;
   MVP= m_project*MV;
@@ -142,23 +132,18 @@ void NGLDraw::loadMatricesToShader()
 
 void NGLDraw::setLight(const ngl::Vec4 &_position,const ngl::Vec4 &_ambient,const ngl::Vec4 &_specular,const ngl::Vec4 &_diffuse )
 {
-  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-  shader->use("Phong");
-  shader->setUniform("light.position",_position);
-  shader->setUniform("light.ambient",_ambient);
-  shader->setUniform("light.specular",_specular);
-  shader->setUniform("light.diffuse",_diffuse);
-
+  m_params.lightPosition=_position;
+  m_params.lightAmbient=_ambient;
+  m_params.lightSpecular=_specular;
+  m_params.lightDiffuse=_diffuse;
 }
 
 void NGLDraw::setMaterial(const ngl::Vec4 &_ambient,const ngl::Vec4 &_specular,const ngl::Vec4 &_diffuse, float _specPower )
 {
-  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-  shader->use("Phong");
-  shader->setUniform("material.ambient",_ambient);
-  shader->setUniform("material.specular",_specular);
-  shader->setUniform("material.diffuse",_diffuse);
-  shader->setUniform("material.shininess",_specPower);
+  m_params.materialAmbient=_ambient;
+  m_params.materialSpecular=_specular;
+  m_params.materialDiffuse=_diffuse;
+  m_params.specPower=_specPower;
 }
 
 
@@ -169,8 +154,8 @@ void NGLDraw::mouseMoveEvent (const SDL_MouseMotionEvent &_event)
   {
     int diffx=_event.x-m_origX;
     int diffy=_event.y-m_origY;
-    m_spinXFace += (float) 0.5f * diffy;
-    m_spinYFace += (float) 0.5f * diffx;
+    m_params.spinXFace += (float) 0.5f * diffy;
+    m_params.spinYFace += (float) 0.5f * diffx;
     m_origX = _event.x;
     m_origY = _event.y;
 
@@ -182,8 +167,8 @@ void NGLDraw::mouseMoveEvent (const SDL_MouseMotionEvent &_event)
     int diffY = (int)(_event.y - m_origYPos);
     m_origXPos=_event.x;
     m_origYPos=_event.y;
-    m_modelPos.m_x += INCREMENT * diffX;
-    m_modelPos.m_y -= INCREMENT * diffY;
+    m_params.modelPos.m_x += INCREMENT * diffX;
+    m_params.modelPos.m_y -= INCREMENT * diffY;
   }
 }
 
@@ -231,21 +216,21 @@ void NGLDraw::wheelEvent(const SDL_MouseWheelEvent &_event)
   // check the diff of the wheel position (0 means no change)
   if(_event.y > 0)
   {
-    m_modelPos.m_z+=ZOOM;
+    m_params.modelPos.m_z+=ZOOM;
   }
   else if(_event.y <0 )
   {
-    m_modelPos.m_z-=ZOOM;
+    m_params.modelPos.m_z-=ZOOM;
   }
 
   // check the diff of the wheel position (0 means no change)
   if(_event.x > 0)
   {
-    m_modelPos.m_x-=ZOOM;
+    m_params.modelPos.m_x-=ZOOM;
   }
   else if(_event.x <0 )
   {
-    m_modelPos.m_x+=ZOOM;
+    m_params.modelPos.m_x+=ZOOM;
   }
 }
 //----------------------------------------------------------------------------------------------------------------------
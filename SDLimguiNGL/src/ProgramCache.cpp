@@ -0,0 +1,179 @@
+#include "ProgramCache.h"
+#include <ngl/ShaderLib.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <sys/stat.h>
+#ifdef _WIN32
+  #include <direct.h>
+#endif
+
+namespace
+{
+  // bumped whenever the layout below changes so old files read as stale
+  constexpr uint32_t Magic=0x314d4750; // "PGM1"
+
+  struct Header
+  {
+    uint32_t magic;
+    uint32_t format;
+    uint64_t key;
+    uint64_t length;
+  };
+
+  bool readFile(const std::string &_name, std::string &o_text)
+  {
+    std::ifstream file(_name,std::ios::in | std::ios::binary);
+    if(!file)
+      return false;
+    std::ostringstream text;
+    text<<file.rdbuf();
+    o_text=text.str();
+    return true;
+  }
+
+  uint64_t fnv1a(uint64_t _hash, const char *_data, size_t _size)
+  {
+    for(size_t i=0; i<_size; ++i)
+    {
+      _hash^=static_cast<unsigned char>(_data[i]);
+      _hash*=0x100000001b3ull;
+    }
+    return _hash;
+  }
+
+  bool binarySupported()
+  {
+    // some drivers expose the entry points but no format, nothing stored would ever load
+    GLint formats=0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS,&formats);
+    return formats > 0;
+  }
+}
+
+ProgramCache *ProgramCache::instance()
+{
+  static ProgramCache s_instance;
+  return &s_instance;
+}
+
+bool ProgramCache::loadProgram(const std::string &_program, const std::string &_vertex, const std::string &_vertexFile,
+                               const std::string &_fragment, const std::string &_fragmentFile)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->createShaderProgram(_program);
+  GLuint id=shader->getProgramID(_program);
+
+  std::string vertexSource;
+  std::string fragmentSource;
+  bool cached=!m_dir.empty() && binarySupported() &&
+              readFile(_vertexFile,vertexSource) && readFile(_fragmentFile,fragmentSource);
+  uint64_t hash=cached ? key(vertexSource,fragmentSource) : 0;
+  if(cached && restore(id,_program,hash))
+  {
+    // glProgramBinary skips linkProgramObject so ShaderLib has to look the uniforms up itself
+    shader->autoRegisterUniforms(_program);
+    ++m_hits;
+    return true;
+  }
+
+  ++m_misses;
+  shader->attachShader(_vertex,ngl::ShaderType::VERTEX);
+  shader->attachShader(_fragment,ngl::ShaderType::FRAGMENT);
+  if(cached)
+  {
+    // the sources are already in memory, no need for ShaderLib to read them again
+    shader->loadShaderSourceFromString(_vertex,vertexSource);
+    shader->loadShaderSourceFromString(_fragment,fragmentSource);
+    glProgramParameteri(id,GL_PROGRAM_BINARY_RETRIEVABLE_HINT,GL_TRUE);
+  }
+  else
+  {
+    shader->loadShaderSource(_vertex,_vertexFile);
+    shader->loadShaderSource(_fragment,_fragmentFile);
+  }
+  shader->compileShader(_vertex);
+  shader->compileShader(_fragment);
+  shader->attachShaderToProgram(_program,_vertex);
+  shader->attachShaderToProgram(_program,_fragment);
+  shader->linkProgramObject(_program);
+  if(cached)
+    store(id,_program,hash);
+  return false;
+}
+
+uint64_t ProgramCache::key(const std::string &_vertex, const std::string &_fragment) const
+{
+  uint64_t hash=0xcbf29ce484222325ull;
+  // the terminating nulls keep "ab"+"c" apart from "a"+"bc"
+  hash=fnv1a(hash,_vertex.c_str(),_vertex.size()+1);
+  hash=fnv1a(hash,_fragment.c_str(),_fragment.size()+1);
+  for(GLenum name : {GL_VENDOR,GL_RENDERER,GL_VERSION})
+  {
+    const char *text=reinterpret_cast<const char *>(glGetString(name));
+    if(text)
+      hash=fnv1a(hash,text,strlen(text)+1);
+  }
+  return hash;
+}
+
+std::string ProgramCache::path(const std::string &_program) const
+{
+  return m_dir+"/"+_program+".bin";
+}
+
+bool ProgramCache::restore(GLuint _id, const std::string &_program, uint64_t _key) const
+{
+  std::ifstream file(path(_program),std::ios::in | std::ios::binary);
+  Header header;
+  if(!file.read(reinterpret_cast<char *>(&header),sizeof(Header)))
+    return false;
+  if(header.magic != Magic || header.key != _key || header.length == 0 || header.length > (1u<<30))
+    return false;
+  std::vector<char> binary(header.length);
+  if(!file.read(binary.data(),static_cast<std::streamsize>(binary.size())))
+    return false;
+
+  glProgramBinary(_id,header.format,binary.data(),static_cast<GLsizei>(binary.size()));
+  GLint linked=GL_FALSE;
+  glGetProgramiv(_id,GL_LINK_STATUS,&linked);
+  return linked == GL_TRUE;
+}
+
+void ProgramCache::store(GLuint _id, const std::string &_program, uint64_t _key) const
+{
+  GLint linked=GL_FALSE;
+  GLint length=0;
+  glGetProgramiv(_id,GL_LINK_STATUS,&linked);
+  glGetProgramiv(_id,GL_PROGRAM_BINARY_LENGTH,&length);
+  if(linked != GL_TRUE || length <= 0)
+    return;
+  std::vector<char> binary(static_cast<size_t>(length));
+  GLenum format=0;
+  glGetProgramBinary(_id,length,&length,&format,binary.data());
+
+#ifdef _WIN32
+  _mkdir(m_dir.c_str());
+#else
+  mkdir(m_dir.c_str(),0755);
+#endif
+  // written to the side and renamed so a run killed half way never leaves a truncated binary behind
+  std::string name=path(_program);
+  std::string temp=name+".tmp";
+  {
+    std::ofstream file(temp,std::ios::out | std::ios::binary | std::ios::trunc);
+    Header header={Magic,format,_key,static_cast<uint64_t>(length)};
+    file.write(reinterpret_cast<const char *>(&header),sizeof(Header));
+    file.write(binary.data(),length);
+    if(!file)
+    {
+      file.close();
+      std::remove(temp.c_str());
+      return;
+    }
+  }
+  std::remove(name.c_str());
+  std::rename(temp.c_str(),name.c_str());
+}
@@ -0,0 +1,111 @@
+#include "RenderThread.h"
+
+void RenderStats::collect()
+{
+  draw=ImGuiImplSdlGetDrawStats();
+  listCache=ImGuiImplSdlGetListCacheStats();
+  softwareMs=ImGuiImplSdlGetSoftwareFrame().RenderTime;
+  GPUTimer *timer=GPUTimer::instance();
+  gpuSections=timer->sections();
+  gpuTotalMs=timer->totalMs();
+}
+
+RenderThread::RenderThread(SDL_Window *_window, SDL_GLContext _context, NGLDraw &_ngl) :
+  m_window(_window), m_context(_context), m_ngl(_ngl)
+{
+  // a context can only be current on one thread at a time
+  SDL_GL_MakeCurrent(m_window,nullptr);
+  m_thread=std::thread(&RenderThread::run,this);
+}
+
+RenderThread::~RenderThread()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_quit=true;
+  }
+  m_changed.notify_all();
+  m_thread.join();
+  SDL_GL_MakeCurrent(m_window,m_context);
+}
+
+void RenderThread::submit(const ImDrawData *_ui, const SceneParams &_scene)
+{
+  Frame &frame=m_frames[m_next];
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock,[&frame]{return frame.state==Frame::Free;});
+  }
+  // the render thread never touches a free slot so the copy needs no lock
+  frame.ui.Capture(_ui);
+  frame.scene=_scene;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    frame.state=Frame::Ready;
+    frame.serial=m_serial++;
+  }
+  m_changed.notify_all();
+  m_next^=1;
+}
+
+void RenderThread::runSync(const std::function<void()> &_fn)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_task=&_fn;
+  m_changed.notify_all();
+  m_changed.wait(lock,[this]{return m_task==nullptr;});
+}
+
+RenderStats RenderThread::stats()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void RenderThread::run()
+{
+  SDL_GL_MakeCurrent(m_window,m_context);
+  RenderStats collected;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for(;;)
+  {
+    Frame *next=nullptr;
+    m_changed.wait(lock,[this,&next]
+    {
+      // the older of the two slots goes first when the main thread got a whole frame ahead
+      next=nullptr;
+      for(auto &frame : m_frames)
+        if(frame.state==Frame::Ready && (!next || frame.serial-next->serial > 0x80000000u))
+          next=&frame;
+      return m_task || next || m_quit;
+    });
+    if(m_task)
+    {
+      // the main thread waits in runSync, nothing of ImGui is in use
+      (*m_task)();
+      // a setter may have dropped the device objects, NewFrame on the main thread must find them recreated
+      ImGuiImplSdlCreateMissingDeviceObjects();
+      m_task=nullptr;
+      m_changed.notify_all();
+      continue;
+    }
+    if(!next)
+      break;
+    next->state=Frame::Rendering;
+    lock.unlock();
+
+    GPUTimer::instance()->newFrame();
+    m_ngl.draw(next->scene);
+    ImGuiImplSdlRenderSnapshot(next->ui);
+    // vsync waits happen here now, the main thread keeps taking input
+    SDL_GL_SwapWindow(m_window);
+    collected.collect();
+
+    lock.lock();
+    next->state=Frame::Free;
+    m_stats=collected;
+    m_changed.notify_all();
+  }
+  lock.unlock();
+  SDL_GL_MakeCurrent(m_window,nullptr);
+}
@@ -1,12 +1,24 @@
 #include <SDL.h>
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include "NGLDraw.h"
 #include <ngl/NGLInit.h>
 #include <ngl/Vec4.h>
 #include <array>
 #include <imgui.h>
 #include "ImGUIImpl.h"
+#include "GPUTimer.h"
+#include "ProgramCache.h"
+#include "RenderThread.h"
+#ifdef __linux__
+  #include <EGL/egl.h>
+  #include <EGL/eglext.h>
+#endif
 extern bool ColorSelector(const char* pLabel, ngl::Vec4& oRGBA);
 
 /// @brief function to quit SDL with error message
@@ -16,10 +28,58 @@ void SDLErrorExit(const std::string &_msg);
 /// @brief initialize SDL OpenGL context
 SDL_GLContext createOpenGLContext( SDL_Window *window);
 
+/// @brief build the Model, Light and Material windows, shared by the window and headless loops
+/// @param[in] _ngl the scene the windows edit, null when there is no GL context to draw it
+/// @param[in] _stats the last frame rendered, from the render thread when there is one
+void drawUI(NGLDraw *_ngl, bool _showModel, bool _showLight, bool _showMaterial, const RenderStats &_stats);
 
+/// @brief GPU time of the scene and of each UI list next to the frame time, closing it stops the timer queries
+void drawTimings(bool *_open, const RenderStats &_stats);
 
-int main()
+/// @brief the render thread of the window loop, null when GL is used from the main thread
+static RenderThread *g_renderThread=nullptr;
+
+/// @brief run GL work the UI asks for on the thread that owns the context
+void runOnGL(const std::function<void()> &_fn)
 {
+  if(g_renderThread)
+    g_renderThread->runSync(_fn);
+  else
+    _fn();
+}
+
+/// @brief render into an FBO with a surfaceless EGL context (no display needed) and print frame times to stdout
+/// @param[in] _frames the number of frames to render before exiting
+int runHeadless(int _frames);
+
+/// @brief build the UI without any GL context, rasterize it on the CPU and save the last frame
+/// @param[in] _frames the number of frames to render before exiting
+/// @param[in] _image the file the last frame is written to, a .pam name keeps the alpha channel
+int runSoftwareHeadless(int _frames, const char *_image);
+
+
+int main(int argc, char **argv)
+{
+  // --headless [frames] renders the same scene and UI offscreen and exits, for CI and timing runs
+  // --software-headless [frames] [image] only rasterizes the UI on the CPU, no GL or display at all
+  // --single-thread keeps GL on the main thread instead of handing the frames to a render thread
+  bool useRenderThread=true;
+  for(int i=1; i<argc; ++i)
+  {
+    if(std::strcmp(argv[i],"--headless")==0)
+    {
+      int frames=(i+1<argc) ? std::atoi(argv[i+1]) : 0;
+      return runHeadless(frames>0 ? frames : 100);
+    }
+    if(std::strcmp(argv[i],"--software-headless")==0)
+    {
+      int frames=(i+1<argc) ? std::atoi(argv[i+1]) : 0;
+      const char *image=(i+2<argc) ? argv[i+2] : "ui.ppm";
+      return runSoftwareHeadless(frames>0 ? frames : 100,image);
+    }
+    if(std::strcmp(argv[i],"--single-thread")==0)
+      useRenderThread=false;
+  }
 
   // Initialize SDL's Video subsystem
   if (SDL_Init(SDL_INIT_VIDEO) < 0 )
@@ -84,74 +144,30 @@ int main()
   bool showLightControls=true;
   bool showMaterialControls=true;
 
+  std::unique_ptr<RenderThread> renderThread;
+  if(useRenderThread)
+  {
+    // ImGui::Render() now only builds the draw data, the render thread draws a copy of it
+    io.RenderDrawListsFn=nullptr;
+    // NewFrame would create these with the context current on the wrong thread
+    ImGuiImplSdlCreateMissingDeviceObjects();
+    renderThread.reset(new RenderThread(window,glContext,ngl));
+    g_renderThread=renderThread.get();
+  }
+  RenderStats stats;
+
   while(!quit)
   {
+    if(renderThread)
+      stats=renderThread->stats();
+    else
+      stats.collect();
 
     while ( SDL_PollEvent(&event) )
     {
       ImGuiImplSdlProcessEvent(&event);
       ImGuiImplSdlNewFrame(window);
-      if(showModelControls)
-      {
-          static ngl::Vec3 rot(0,0,0);
-          static ngl::Vec3 pos(0,0,0);
-          static ngl::Vec3 scale(1,1,1);
-          static ngl::Vec4 clearColour= {0.5,0.5,0.5,1.0};
-
-          ImGui::Begin("Model");
-          ImGui::SliderFloat3("rotation",rot.openGL(),-180.0f,180.f);
-          ImGui::SliderFloat3("position",pos.openGL(),-10.0f,10.f);
-          ImGui::SliderFloat3("scale",scale.openGL(),-2.0f,2.f);
-
-          //ImGui::ColorEdit3("clear color", clearColour.openGL());
-          ColorSelector("clear color",clearColour);
-          const char* items[]={ "Teapot", "Troll", "Bunny", "Dragon", "Buddah", "Cube" };
-          static int modelID = 0;
-          ImGui::Combo("Model", &modelID, items,6);   // Combo using proper array. You can also pass a callback to retrieve array value, no need to create/copy an array just for that.
-          bool wireframe=ngl.getWireFrame();
-          ImGui::Checkbox("Wireframe",&wireframe);
-          ngl.setWireFrame(wireframe);
-          ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
-          glClearColor(clearColour.m_r,clearColour.m_g,clearColour.m_b,clearColour.m_a);
-          ngl.setModelRotation(rot);
-          ngl.setModelPosition(pos);
-          ngl.setModelScale(scale);
-          ngl.setModelID(modelID);
-
-          ImGui::End();
-
-      }
-      if(showLightControls)
-      {
-          static ngl::Vec4 position={-2.0f,5.0f,2.0f};
-          static ngl::Vec4 ambient={0.0f,0.0f,0.0f};
-          static ngl::Vec4 specular={1.0f,1.0f,1.0f};
-          static ngl::Vec4 diffuse={1.0f,1.0f,1.0f};
-          ImGui::Begin("Light");
-          ImGui::SliderFloat3("position",position.openGL(),-10,10);
-          ColorSelector("Ambient", ambient);
-          ColorSelector("Specular", specular);
-          ColorSelector("Diffuse", diffuse);
-          ngl.setLight(position,ambient,specular,diffuse);
-          ImGui::End();
-
-      }
-      if(showMaterialControls)
-      {
-          static ngl::Vec4 ambient={0.274725f,0.1995f,0.0745f};
-          static ngl::Vec4 specular={0.628281f, 0.555802f,0.3666065f};
-          static ngl::Vec4 diffuse={0.75164f,0.60648f,0.22648f};
-          static float specPower=51.2f;
-          ImGui::Begin("Material");
-          ColorSelector("Ambient", ambient);
-          ColorSelector("Specular", specular);
-          ColorSelector("Diffuse", diffuse);
-          ImGui::SliderFloat("Cos Power", &specPower,0.0f,200.0f);
-
-          ngl.setMaterial(ambient,specular,diffuse,specPower);
-          ImGui::End();
-
-      }
+      drawUI(&ngl,showModelControls,showLightControls,showMaterialControls,stats);
 
 
       if(!io.WantCaptureMouse)
@@ -185,7 +201,7 @@ int main()
             case SDLK_s : ngl.setWireFrame(false); break;
             case SDLK_f :
             SDL_SetWindowFullscreen(window,SDL_TRUE);
-            glViewport(0,0,rect.w,rect.h);
+            ngl.resize(rect.w,rect.h);
             break;
             case SDLK_m : showModelControls^=true; break;
 
@@ -199,14 +215,26 @@ int main()
       } // end of not want from IO
     } // end of poll events
 
-    // now we draw ngl
-    ngl.draw();
-    ImGui::Render();
-
-    // swap the buffers
-    SDL_GL_SwapWindow(window);
-
+    if(renderThread)
+    {
+      // hand the frame over, this only waits when the render thread is still busy with the previous two
+      ImGui::Render();
+      renderThread->submit(ImGui::GetDrawData(),ngl.params());
+    }
+    else
+    {
+      // now we draw ngl
+      GPUTimer::instance()->newFrame();
+      ngl.draw();
+      ImGui::Render();
+
+      // swap the buffers
+      SDL_GL_SwapWindow(window);
+    }
   }
+  // the context is current on this thread again for the shutdown
+  g_renderThread=nullptr;
+  renderThread.reset();
  ImGuiImplSdlShutdown();
   // now tidy up and exit SDL
  SDL_Quit();
@@ -247,6 +275,267 @@ SDL_GLContext createOpenGLContext(SDL_Window *window)
 
 }
 
+void drawUI(NGLDraw *_ngl, bool _showModel, bool _showLight, bool _showMaterial, const RenderStats &_stats)
+{
+  if(_showModel)
+  {
+      static ngl::Vec3 rot(0,0,0);
+      static ngl::Vec3 pos(0,0,0);
+      static ngl::Vec3 scale(1,1,1);
+      static ngl::Vec4 clearColour= {0.5,0.5,0.5,1.0};
+
+      ImGui::Begin("Model");
+      ImGui::SliderFloat3("rotation",rot.openGL(),-180.0f,180.f);
+      ImGui::SliderFloat3("position",pos.openGL(),-10.0f,10.f);
+      ImGui::SliderFloat3("scale",scale.openGL(),-2.0f,2.f);
+
+      //ImGui::ColorEdit3("clear color", clearColour.openGL());
+      ColorSelector("clear color",clearColour);
+      const char* items[]={ "Teapot", "Troll", "Bunny", "Dragon", "Buddah", "Cube" };
+      static int modelID = 0;
+      ImGui::Combo("Model", &modelID, items,6);   // Combo using proper array. You can also pass a callback to retrieve array value, no need to create/copy an array just for that.
+      bool wireframe=_ngl ? _ngl->getWireFrame() : false;
+      ImGui::Checkbox("Wireframe",&wireframe);
+      if(_ngl)
+        _ngl->setWireFrame(wireframe);
+      ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+      static bool showTimings=false;
+      ImGui::SameLine();
+      if(ImGui::Checkbox("GPU timings",&showTimings))
+        runOnGL([]{GPUTimer::instance()->setEnabled(showTimings);});
+      const ImDrawCompactStats &drawStats=_stats.draw;
+      ImGui::Text("UI %d draws for %d commands, %d GL calls saved", drawStats.DrawCalls, drawStats.SourceCmds, drawStats.SavedCalls);
+      const ImDrawListCacheStats &cacheStats=_stats.listCache;
+      ImGui::Text("UI lists reused %d/%d (%.0f%%), %d bytes uploaded, %d pixels damaged", cacheStats.Hits, cacheStats.Lists, cacheStats.HitRate()*100.0f, cacheStats.UploadedBytes, cacheStats.DamagedPixels);
+      static bool uiLayer=false;
+      if(ImGui::Checkbox("Cache UI layer",&uiLayer))
+        runOnGL([]{ImGuiImplSdlSetUiLayer(uiLayer);});
+      static bool multiDrawIndirect=false;
+      if(ImGui::Checkbox("Multi draw indirect",&multiDrawIndirect))
+        runOnGL([]{multiDrawIndirect=ImGuiImplSdlSetMultiDrawIndirect(multiDrawIndirect);});
+      static bool softwareUI=false;
+      if(ImGui::Checkbox("Software UI",&softwareUI))
+        runOnGL([]{ImGuiImplSdlSetSoftwareRenderer(softwareUI);});
+      if(softwareUI)
+      {
+        ImGui::SameLine();
+        ImGui::Text("%.2f ms", _stats.softwareMs);
+      }
+      static bool distanceField=false;
+      if(ImGui::Checkbox("Distance field font",&distanceField))
+        ImGuiImplSdlSetFontDistanceField(distanceField);
+      ImGui::SameLine();
+      ImGui::SliderFloat("font scale",&ImGui::GetIO().FontGlobalScale,0.5f,4.0f);
+      if(_ngl)
+      {
+        _ngl->setClearColour(clearColour);
+        _ngl->setModelRotation(rot);
+        _ngl->setModelPosition(pos);
+        _ngl->setModelScale(scale);
+        _ngl->setModelID(modelID);
+      }
+
+      ImGui::End();
+      if(showTimings)
+        drawTimings(&showTimings,_stats);
+
+  }
+  if(_showLight)
+  {
+      static ngl::Vec4 position={-2.0f,5.0f,2.0f};
+      static ngl::Vec4 ambient={0.0f,0.0f,0.0f};
+      static ngl::Vec4 specular={1.0f,1.0f,1.0f};
+      static ngl::Vec4 diffuse={1.0f,1.0f,1.0f};
+      ImGui::Begin("Light");
+      ImGui::SliderFloat3("position",position.openGL(),-10,10);
+      ColorSelector("Ambient", ambient);
+      ColorSelector("Specular", specular);
+      ColorSelector("Diffuse", diffuse);
+      if(_ngl)
+        _ngl->setLight(position,ambient,specular,diffuse);
+      ImGui::End();
+
+  }
+  if(_showMaterial)
+  {
+      static ngl::Vec4 ambient={0.274725f,0.1995f,0.0745f};
+      static ngl::Vec4 specular={0.628281f, 0.555802f,0.3666065f};
+      static ngl::Vec4 diffuse={0.75164f,0.60648f,0.22648f};
+      static float specPower=51.2f;
+      ImGui::Begin("Material");
+      ColorSelector("Ambient", ambient);
+      ColorSelector("Specular", specular);
+      ColorSelector("Diffuse", diffuse);
+      ImGui::SliderFloat("Cos Power", &specPower,0.0f,200.0f);
+
+      if(_ngl)
+        _ngl->setMaterial(ambient,specular,diffuse,specPower);
+      ImGui::End();
+
+  }
+}
+
+int runHeadless(int _frames)
+{
+#ifdef __linux__
+  constexpr int width=1024;
+  constexpr int height=720;
+  // prefer Mesa's surfaceless platform as it needs no X or Wayland server, else take the default display
+  EGLDisplay display=EGL_NO_DISPLAY;
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+  auto getPlatformDisplay=reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if(getPlatformDisplay)
+    display=getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,EGL_DEFAULT_DISPLAY,nullptr);
+#endif
+  if(display==EGL_NO_DISPLAY)
+    display=eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  EGLint major,minor;
+  if(display==EGL_NO_DISPLAY || !eglInitialize(display,&major,&minor))
+  {
+    std::cerr<<"Unable to initialize EGL\n";
+    return EXIT_FAILURE;
+  }
+  eglBindAPI(EGL_OPENGL_API);
+  const EGLint configAttribs[]={ EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+  EGLConfig config;
+  EGLint numConfigs=0;
+  // same version and profile as createOpenGLContext so the headless run takes the same code paths
+  const EGLint contextAttribs[]={ EGL_CONTEXT_MAJOR_VERSION, 4,
+                                  EGL_CONTEXT_MINOR_VERSION, 2,
+                                  EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                  EGL_NONE };
+  EGLContext context=EGL_NO_CONTEXT;
+  if(eglChooseConfig(display,configAttribs,&config,1,&numConfigs) && numConfigs>0)
+    context=eglCreateContext(display,config,EGL_NO_CONTEXT,contextAttribs);
+  // there is no surface at all, the scene and UI draw into the FBO below
+  if(context==EGL_NO_CONTEXT || !eglMakeCurrent(display,EGL_NO_SURFACE,EGL_NO_SURFACE,context))
+  {
+    std::cerr<<"Unable to create a surfaceless OpenGL 4.2 context\n";
+    eglTerminate(display);
+    return EXIT_FAILURE;
+  }
+  ngl::NGLInit::instance();
+
+  GLuint fbo,colour,depth;
+  glGenRenderbuffers(1,&colour);
+  glBindRenderbuffer(GL_RENDERBUFFER,colour);
+  glRenderbufferStorage(GL_RENDERBUFFER,GL_RGBA8,width,height);
+  glGenRenderbuffers(1,&depth);
+  glBindRenderbuffer(GL_RENDERBUFFER,depth);
+  glRenderbufferStorage(GL_RENDERBUFFER,GL_DEPTH_COMPONENT24,width,height);
+  glGenFramebuffers(1,&fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER,fbo);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER,GL_COLOR_ATTACHMENT0,GL_RENDERBUFFER,colour);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER,GL_DEPTH_ATTACHMENT,GL_RENDERBUFFER,depth);
+  int status=EXIT_SUCCESS;
+  if(glCheckFramebufferStatus(GL_FRAMEBUFFER)!=GL_FRAMEBUFFER_COMPLETE)
+  {
+    std::cerr<<"Headless framebuffer is incomplete\n";
+    status=EXIT_FAILURE;
+  }
+  else
+  {
+    ImGuiImplSdlInit(nullptr);
+    GPUTimer::instance()->setEnabled(true);
+    RenderStats stats;
+    {
+      NGLDraw ngl;
+      ngl.resize(width,height);
+      double total=0.0;
+      double fastest=0.0;
+      double slowest=0.0;
+      for(int frame=0; frame<_frames; ++frame)
+      {
+        auto start=std::chrono::steady_clock::now();
+        // fixed time step so every run builds exactly the same UI
+        ImGuiImplSdlNewFrameHeadless(width,height,1.0f/60.0f);
+        stats.collect();
+        drawUI(&ngl,true,true,true,stats);
+        GPUTimer::instance()->newFrame();
+        ngl.draw();
+        ImGui::Render();
+        // wait for the GPU so the time covers the whole frame, not just submitting it
+        glFinish();
+        double ms=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+        // the GPU time printed is from GPUTimer::FrameLatency frames back, 0 until the ring fills
+        std::cout<<"frame "<<frame<<" "<<ms<<" ms gpu "<<GPUTimer::instance()->totalMs()<<" ms\n";
+        total+=ms;
+        fastest=frame==0 ? ms : std::min(fastest,ms);
+        slowest=std::max(slowest,ms);
+      }
+      std::cout<<_frames<<" frames "<<width<<"x"<<height<<" average "<<total/_frames<<" ms min "<<fastest<<" ms max "<<slowest<<" ms\n";
+      std::cout<<"shader programs "<<ProgramCache::instance()->hits()<<" from cache "<<ProgramCache::instance()->misses()<<" compiled\n";
+    }
+    ImGuiImplSdlShutdown();
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER,0);
+  glDeleteFramebuffers(1,&fbo);
+  glDeleteRenderbuffers(1,&colour);
+  glDeleteRenderbuffers(1,&depth);
+  eglMakeCurrent(display,EGL_NO_SURFACE,EGL_NO_SURFACE,EGL_NO_CONTEXT);
+  eglDestroyContext(display,context);
+  eglTerminate(display);
+  return status;
+#else
+  (void)_frames;
+  std::cerr<<"--headless needs a surfaceless EGL context which is only set up on Linux\n";
+  return EXIT_FAILURE;
+#endif
+}
+
+int runSoftwareHeadless(int _frames, const char *_image)
+{
+  constexpr int width=1024;
+  constexpr int height=720;
+  // no SDL_Init and no context, the font atlas and every frame only ever live in the binding's ImDrawRaster
+  ImGuiImplSdlInitNoGL();
+  RenderStats stats;
+  double total=0.0;
+  double fastest=0.0;
+  double slowest=0.0;
+  for(int frame=0; frame<_frames; ++frame)
+  {
+    auto start=std::chrono::steady_clock::now();
+    // fixed time step so every run builds exactly the same UI
+    ImGuiImplSdlNewFrameHeadless(width,height,1.0f/60.0f);
+    drawUI(nullptr,true,true,true,stats);
+    ImGui::Render();
+    stats.softwareMs=ImGuiImplSdlGetSoftwareFrame().RenderTime;
+    double ms=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+    std::cout<<"frame "<<frame<<" "<<ms<<" ms raster "<<stats.softwareMs<<" ms\n";
+    total+=ms;
+    fastest=frame==0 ? ms : std::min(fastest,ms);
+    slowest=std::max(slowest,ms);
+  }
+  std::cout<<_frames<<" frames "<<width<<"x"<<height<<" average "<<total/_frames<<" ms min "<<fastest<<" ms max "<<slowest<<" ms\n";
+  const size_t length=std::strlen(_image);
+  const bool withAlpha=length>=4 && std::strcmp(_image+length-4,".pam")==0;
+  int status=EXIT_SUCCESS;
+  if(!ImGuiImplSdlGetSoftwareFrame().SaveImage(_image,withAlpha))
+  {
+    std::cerr<<"Unable to write "<<_image<<"\n";
+    status=EXIT_FAILURE;
+  }
+  ImGuiImplSdlShutdown();
+  return status;
+}
+
+void drawTimings(bool *_open, const RenderStats &_stats)
+{
+  ImGui::Begin("Timings",_open,ImGuiWindowFlags_AlwaysAutoResize);
+  const float frameMs=1000.0f/ImGui::GetIO().Framerate;
+  ImGui::Text("frame %.3f ms, GPU %.3f ms (%d frames old)",frameMs,_stats.gpuTotalMs,GPUTimer::FrameLatency);
+  // if the GPU work fills most of the frame the CPU ends up waiting for it
+  ImGui::TextUnformatted(_stats.gpuTotalMs>0.8f*frameMs ? "GPU bound" : "CPU bound");
+  ImGui::Separator();
+  for(const auto &section : _stats.gpuSections)
+    ImGui::Text("%-16s %8.3f ms",section.name.c_str(),section.ms);
+  ImGui::End();
+  if(!*_open)
+    runOnGL([]{GPUTimer::instance()->setEnabled(false);});
+}
+
 void SDLErrorExit(const std::string &_msg)
 {
   std::cerr<<_msg<<"\n";
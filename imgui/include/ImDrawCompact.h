@@ -0,0 +1,68 @@
+// Draw command compaction shared by the SDL and Qt OpenGL3 bindings.
+// Turns the ImDrawCmd lists of a frame into one flat array laid out for a single vertex/index upload of the whole
+// ImDrawData (lists packed back to back), merges consecutive commands with identical state and contiguous index
+// ranges, and flags which commands actually need a texture bind or a scissor so the backend can skip the rest.
+#pragma once
+#include "imgui.h"
+
+struct ImDrawCompactCmd
+{
+    ImTextureID         TextureId;
+    int                 ClipRect[4];        // glScissor() x, y, width, height in framebuffer pixels
+    unsigned int        IdxOffset;          // first index in the frame wide index buffer
+    unsigned int        ElemCount;
+    int                 VtxOffset;          // base vertex in the frame wide vertex buffer
+    bool                BindTexture;        // TextureId differs from the previous draw
+    bool                SetScissor;         // ClipRect differs from the previous draw
+    const ImDrawList*   CmdList;            // source list, passed to user callbacks
+    const ImDrawCmd*    UserCmd;            // != NULL for a user callback, all other fields but CmdList are unused
+};
+
+// Where a list of the frame sits in the backend's buffers when the lists are not simply packed back to back
+struct ImDrawListSlot
+{
+    int                 VtxOffset;          // absolute base vertex / first index of the list
+    int                 IdxOffset;
+    bool                Upload;             // the list has to be copied there this frame, false when reused as is
+};
+
+struct ImDrawCompactStats
+{
+    int                 SourceCmds;         // ImDrawCmd entries in the frame (callbacks included)
+    int                 DrawCalls;          // draws left after merging
+    int                 TextureBinds;
+    int                 Scissors;
+    int                 SavedCalls;         // GL calls removed compared to bind + scissor + draw for every non-empty ImDrawCmd
+
+    ImDrawCompactStats() { SourceCmds = DrawCalls = TextureBinds = Scissors = SavedCalls = 0; }
+};
+
+// Build out_cmds from draw_data, fb_height flips ClipRect to GL's bottom-left scissor origin.
+// Call after ScaleClipRects(). stats may be NULL, slots (one per list, see ImDrawListCache) replaces the packed layout.
+IMGUI_API void ImDrawCompactCommands(const ImDrawData* draw_data, int fb_height, ImVector<ImDrawCompactCmd>& out_cmds, ImDrawCompactStats* stats, const ImDrawListSlot* slots = NULL);
+
+// Multi-draw-indirect submission (GL 4.3): consecutive compacted commands sharing a texture become one run that is
+// drawn with a single glMultiDrawElementsIndirect, clipping moves to the shader as the scissor cannot change inside a run.
+
+// Same layout as GL's DrawElementsIndirectCommand
+struct ImDrawIndirectCmd
+{
+    unsigned int        Count;
+    unsigned int        InstanceCount;
+    unsigned int        FirstIndex;
+    int                 BaseVertex;
+    unsigned int        BaseInstance;       // index of the draw, used to fetch its clip rect as a per instance attribute
+};
+
+struct ImDrawIndirectRun
+{
+    ImTextureID         TextureId;
+    int                 FirstCmd;           // first entry in the indirect command array
+    int                 CmdCount;
+    const ImDrawCompactCmd* UserCmd;        // != NULL for a user callback, the run then has no commands
+};
+
+// Build the indirect commands, per draw clip rects (x, y, width, height in framebuffer pixels) and runs from the output of
+// ImDrawCompactCommands(). vtx_base / idx_base are added to every command for backends that upload into a larger buffer.
+// stats (may be NULL) is updated to count a run as one bind + one draw and no scissor.
+IMGUI_API void ImDrawCompactBuildIndirect(const ImVector<ImDrawCompactCmd>& cmds, int vtx_base, int idx_base, ImVector<ImDrawIndirectCmd>& out_cmds, ImVector<ImVec4>& out_clips, ImVector<ImDrawIndirectRun>& out_runs, ImDrawCompactStats* stats);
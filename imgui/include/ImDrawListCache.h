@@ -0,0 +1,65 @@
+// Frame to frame reuse of ImDrawList vertex / index data shared by the SDL and Qt OpenGL3 bindings.
+// Every list is hashed after ImGui::Render(), a list whose data matched the previous frame is copied once into a
+// resident region of the backend's buffers and drawn from there while it stays unchanged, so an idle UI uploads
+// nothing. Lists that change every frame go to the backend's streaming region as before.
+// Each list is one window, so comparing a list's commands and bounds with the previous frame also gives the rectangle
+// of the framebuffer that actually changed (Damage) for backends that can redraw part of the UI.
+#pragma once
+#include "imgui.h"
+#include "ImDrawCompact.h"
+
+struct ImDrawListCacheStats
+{
+    int                 Lists;              // lists in the frame
+    int                 Hits;               // lists drawn from the resident region without any upload
+    int                 UploadedBytes;
+    int                 ReusedBytes;
+    int                 DamagedPixels;      // area of ImDrawListCache::Damage
+
+    ImDrawListCacheStats() { Lists = Hits = UploadedBytes = ReusedBytes = DamagedPixels = 0; }
+    float               HitRate() const { return Lists > 0 ? (float)Hits / (float)Lists : 0.0f; }
+};
+
+struct ImDrawListCache
+{
+    struct Entry
+    {
+        const void*         Id;             // the list's _OwnerName, the list itself when it has none
+        ImU64               Hash;           // vertex / index data, decides reuse
+        ImU64               DrawHash;       // data plus commands, decides damage
+        ImVec4              Bounds;         // union of the command clip rects, framebuffer pixels (x1, y1, x2, y2)
+        int                 Index;          // position in the draw order
+        int                 VtxOffset;      // resident offsets, only valid when Resident
+        int                 IdxOffset;
+        int                 VtxCount;
+        int                 IdxCount;
+        bool                Resident;
+        bool                Seen;
+    };
+
+    ImVector<Entry>     Entries;
+    int                 ResidentVtxUsed;    // bump allocator over the resident region, in vertices / indices
+    int                 ResidentIdxUsed;
+    bool                ResetPending;       // the region filled up with dead lists, recycle it next frame
+    int                 StreamVtxCount;     // vertices / indices this frame writes to the streaming region
+    int                 StreamIdxCount;
+    ImU64               FrameHash;          // every list plus its commands, equal between two frames that render the same
+    ImVec4              Damage;             // union of the bounds of lists that changed, moved in the draw order, appeared
+                                            // or went away (old and new bounds), x1 >= x2 when nothing changed
+
+    ImDrawListCache() { Clear(); }
+
+    // The backend lost its buffers (e.g. they were grown), forget every resident list.
+    IMGUI_API void      Clear();
+
+    // Damage as a glScissor() rect (x, y, width, height, bottom-left origin) clamped to the framebuffer, false when empty.
+    IMGUI_API bool      DamageScissor(int fb_width, int fb_height, int out_rect[4]) const;
+
+    // Decide where every list of draw_data lives this frame. Lists are matched to the previous frame by the window that
+    // owns them, so copies of the lists (ImDrawSnapshot) match as well. fb_scale is what ScaleClipRects() was given.
+    // out_slots gets absolute vertex / index offsets: stream lists are packed from stream_vtx_base / stream_idx_base,
+    // resident ones sit in [resident_vtx_base, + resident_vtx_capacity).
+    // Returns true when the resident region is recycled this frame, the backend must then wait until the GPU is done
+    // with every earlier frame before writing. stats may be NULL.
+    IMGUI_API bool      Update(const ImDrawData* draw_data, const ImVec2& fb_scale, int stream_vtx_base, int stream_idx_base, int resident_vtx_base, int resident_idx_base, int resident_vtx_capacity, int resident_idx_capacity, ImVector<ImDrawListSlot>& out_slots, ImDrawListCacheStats* stats);
+};
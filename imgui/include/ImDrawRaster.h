@@ -0,0 +1,57 @@
+// CPU rasterizer for ImDrawData, needs no GL at all (thumbnails, golden images on CI machines, headless runs).
+// Triangles are snapped to 1/16 pixel, clipped to their ClipRect and binned into screen tiles, then the tiles are
+// shared between worker threads. Each tile walks its triangles in submission order a span per row (exact edge
+// functions with a top-left fill rule so quads sharing a diagonal never blend twice) and shades 4 pixels at a time
+// with SSE2. Blending matches the GL bindings: rgb uses SRC_ALPHA / ONE_MINUS_SRC_ALPHA and alpha ONE /
+// ONE_MINUS_SRC_ALPHA, so rendering over a transparent clear gives a premultiplied image.
+// Textures are sampled nearest, which is exact for the font atlas drawn at 1:1. A distance field atlas
+// (ImFontAtlas::TexDistanceField) is thresholded with an edge as wide as a screen pixel at the scale it is drawn.
+#pragma once
+#include "imgui.h"
+
+struct ImDrawRasterTri;
+
+struct ImDrawRasterTexture
+{
+    ImTextureID             Id;
+    const unsigned char*    Pixels;         // not owned, must outlive Render()
+    int                     Width;
+    int                     Height;
+    int                     BytesPerPixel;  // 1 (GetTexDataAsAlpha8, white with alpha) or 4 (GetTexDataAsRGBA32)
+    float                   DistanceFieldSpread;    // 0, or the alpha is a signed distance field, ImFontAtlas::TexDistanceFieldSpread
+};
+
+struct ImDrawRaster
+{
+    ImVector<ImU32>     Pixels;             // IM_COL32 layout (R in the low byte), Stride pixels per row
+    int                 Width;
+    int                 Height;
+    int                 Stride;             // Width rounded up to 4
+    ImU32               ClearColor;         // written to every pixel before the draw lists
+    bool                FlipY;              // store the bottom row first, as glTexImage2D / glReadPixels expect
+    int                 Threads;            // 0 = one per hardware thread
+    float               RenderTime;         // ms spent in the last Render()
+    ImVector<ImDrawRasterTexture> Textures;
+
+    // Per frame work, kept to avoid reallocating every frame
+    ImVector<ImDrawRasterTri> Tris;         // clipped and set up triangles in submission order
+    ImVector<int>       TileStart;          // counting sort of triangle indices by tile, TileTris[TileStart[t]..TileStart[t+1]]
+    ImVector<int>       TileTris;
+
+    ImDrawRaster() { Width = Height = Stride = 0; ClearColor = 0; FlipY = false; Threads = 0; RenderTime = 0.0f; }
+
+    // Register the pixels the commands with this ImTextureID sample. Commands whose texture is unknown draw untextured.
+    IMGUI_API void      SetTexture(ImTextureID id, const unsigned char* pixels, int width, int height, int bytes_per_pixel, float distance_field_spread = 0.0f);
+    IMGUI_API void      Resize(int width, int height);
+    ImU32*              Row(int y)              { return Pixels.Data + (size_t)(FlipY ? Height - 1 - y : y) * Stride; }
+    const ImU32*        Row(int y) const        { return Pixels.Data + (size_t)(FlipY ? Height - 1 - y : y) * Stride; }
+
+    // Rasterize the frame, the target is resized to DisplaySize * DisplayFramebufferScale first.
+    // Usable directly as io.RenderDrawListsFn through a binding that owns an ImDrawRaster.
+    IMGUI_API void      Render(ImDrawData* draw_data);
+    // Same with the sizes given, for a render thread that must not read ImGuiIO (see ImDrawSnapshot)
+    IMGUI_API void      Render(ImDrawData* draw_data, const ImVec2& display_size, const ImVec2& fb_scale);
+
+    // Binary PPM (rgb) or PAM (rgba) of the target, for golden images. Returns false if the file can't be written.
+    IMGUI_API bool      SaveImage(const char* filename, bool with_alpha) const;
+};
@@ -0,0 +1,183 @@
+// 4-wide float helpers for the ImDrawList tessellation loops: SSE2 on x86, NEON on AArch64, 4 plain floats elsewhere or
+// with IMGUI_DISABLE_SIMD. Only operations IEEE rounds exactly (add, sub, mul, div, sqrt, min/max, select, truncation) are exposed,
+// so a loop written with them produces the same bits as the scalar code it replaces.
+// ImVec2 arrays are read and written 4 points at a time and split into x and y registers on the way, a rect held as
+// (x1, y1, x2, y2) next to its (u1, v1, u2, v2) gives its 4 vertices without going through scalars.
+// On x86 kernels may also have an 8-wide AVX2 version, compiled for that target alone and picked at runtime with
+// ImDrawSimdHasAvx2() (CPUID), so the binary still runs on SSE2-only machines.
+#pragma once
+#include "imgui.h"
+
+#if !defined(IMGUI_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define IMDRAWSIMD_SSE2
+typedef __m128 ImSimd4f;
+#elif !defined(IMGUI_DISABLE_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define IMDRAWSIMD_NEON
+typedef float32x4_t ImSimd4f;
+#else
+#include <math.h>
+struct ImSimd4f { float v[4]; };
+#endif
+
+#if defined(IMDRAWSIMD_SSE2) && (defined(__GNUC__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define IMDRAWSIMD_AVX2
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define IMDRAWSIMD_AVX2_TARGET
+#else
+#include <cpuid.h>
+#define IMDRAWSIMD_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+// AVX2 instructions and an OS saving the YMM registers, checked once
+static inline bool ImDrawSimdDetectAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)   // OSXSAVE, AVX
+        return false;
+    if ((_xgetbv(0) & 6) != 6)                                      // XMM and YMM state enabled
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;                               // AVX2
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, NULL) < 7)
+        return false;
+    __cpuid(1, eax, ebx, ecx, edx);
+    if ((ecx & (1u << 27)) == 0 || (ecx & (1u << 28)) == 0)
+        return false;
+    unsigned int xcr0_lo, xcr0_hi;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 6) != 6)
+        return false;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (ebx & (1u << 5)) != 0;
+#endif
+}
+static inline bool      ImDrawSimdHasAvx2()                                 { static const bool has_avx2 = ImDrawSimdDetectAvx2(); return has_avx2; }
+#else
+static inline bool      ImDrawSimdHasAvx2()                                 { return false; }
+#endif
+
+#if defined(IMDRAWSIMD_SSE2)
+
+static inline ImSimd4f  ImSimd4fSet1(float f)                               { return _mm_set1_ps(f); }
+static inline ImSimd4f  ImSimd4fSet(float a, float b, float c, float d)     { return _mm_setr_ps(a, b, c, d); }
+static inline ImSimd4f  ImSimd4fAdd(ImSimd4f a, ImSimd4f b)                 { return _mm_add_ps(a, b); }
+static inline ImSimd4f  ImSimd4fSub(ImSimd4f a, ImSimd4f b)                 { return _mm_sub_ps(a, b); }
+static inline ImSimd4f  ImSimd4fMul(ImSimd4f a, ImSimd4f b)                 { return _mm_mul_ps(a, b); }
+static inline ImSimd4f  ImSimd4fDiv(ImSimd4f a, ImSimd4f b)                 { return _mm_div_ps(a, b); }
+static inline ImSimd4f  ImSimd4fSqrt(ImSimd4f a)                            { return _mm_sqrt_ps(a); }
+static inline ImSimd4f  ImSimd4fMin(ImSimd4f a, ImSimd4f b)                 { return _mm_min_ps(a, b); }
+static inline ImSimd4f  ImSimd4fMax(ImSimd4f a, ImSimd4f b)                 { return _mm_max_ps(a, b); }
+static inline ImSimd4f  ImSimd4fNeg(ImSimd4f a)                             { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+// a > b ? if_true : if_false per lane
+static inline ImSimd4f  ImSimd4fSelectGt(ImSimd4f a, ImSimd4f b, ImSimd4f if_true, ImSimd4f if_false) { const __m128 m = _mm_cmpgt_ps(a, b); return _mm_or_ps(_mm_and_ps(m, if_true), _mm_andnot_ps(m, if_false)); }
+static inline void      ImSimd4fLoad2(const ImVec2* p, ImSimd4f* x, ImSimd4f* y)
+{
+    const __m128 a = _mm_loadu_ps(&p[0].x), b = _mm_loadu_ps(&p[2].x);
+    *x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    *y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+static inline void      ImSimd4fStore2(ImVec2* p, ImSimd4f x, ImSimd4f y)   { _mm_storeu_ps(&p[0].x, _mm_unpacklo_ps(x, y)); _mm_storeu_ps(&p[2].x, _mm_unpackhi_ps(x, y)); }
+static inline ImSimd4f  ImSimd4fLoad(const float* p)                        { return _mm_loadu_ps(p); }
+static inline void      ImSimd4fStore(float* p, ImSimd4f a)                 { _mm_storeu_ps(p, a); }
+// (a2, a3, a0, a1)
+static inline ImSimd4f  ImSimd4fSwapHalves(ImSimd4f a)                      { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 0, 3, 2)); }
+// bit n set when a[n] > b[n]
+static inline int       ImSimd4fMaskGt(ImSimd4f a, ImSimd4f b)              { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)); }
+// (x, y, u, v) of the corners of pos = (x1, y1, x2, y2), uv = (u1, v1, u2, v2), in PrimRectUV() order
+static inline void      ImSimd4fRectCorners(ImSimd4f pos, ImSimd4f uv, ImSimd4f* out)
+{
+    out[0] = _mm_movelh_ps(pos, uv);
+    out[1] = _mm_shuffle_ps(pos, uv, _MM_SHUFFLE(1, 2, 1, 2));
+    out[2] = _mm_movehl_ps(uv, pos);
+    out[3] = _mm_shuffle_ps(pos, uv, _MM_SHUFFLE(3, 0, 3, 0));
+}
+// (int) conversion, rounding toward zero
+static inline void      ImSimd4fStoreInt(int* p, ImSimd4f a)                { _mm_storeu_si128((__m128i*)p, _mm_cvttps_epi32(a)); }
+
+#elif defined(IMDRAWSIMD_NEON)
+
+static inline ImSimd4f  ImSimd4fSet1(float f)                               { return vdupq_n_f32(f); }
+static inline ImSimd4f  ImSimd4fSet(float a, float b, float c, float d)     { const float v[4] = { a, b, c, d }; return vld1q_f32(v); }
+static inline ImSimd4f  ImSimd4fAdd(ImSimd4f a, ImSimd4f b)                 { return vaddq_f32(a, b); }
+static inline ImSimd4f  ImSimd4fSub(ImSimd4f a, ImSimd4f b)                 { return vsubq_f32(a, b); }
+static inline ImSimd4f  ImSimd4fMul(ImSimd4f a, ImSimd4f b)                 { return vmulq_f32(a, b); }
+static inline ImSimd4f  ImSimd4fDiv(ImSimd4f a, ImSimd4f b)                 { return vdivq_f32(a, b); }
+static inline ImSimd4f  ImSimd4fSqrt(ImSimd4f a)                            { return vsqrtq_f32(a); }
+static inline ImSimd4f  ImSimd4fMin(ImSimd4f a, ImSimd4f b)                 { return vminq_f32(a, b); }
+static inline ImSimd4f  ImSimd4fMax(ImSimd4f a, ImSimd4f b)                 { return vmaxq_f32(a, b); }
+static inline ImSimd4f  ImSimd4fNeg(ImSimd4f a)                             { return vnegq_f32(a); }
+static inline ImSimd4f  ImSimd4fSelectGt(ImSimd4f a, ImSimd4f b, ImSimd4f if_true, ImSimd4f if_false) { return vbslq_f32(vcgtq_f32(a, b), if_true, if_false); }
+static inline void      ImSimd4fLoad2(const ImVec2* p, ImSimd4f* x, ImSimd4f* y) { const float32x4x2_t v = vld2q_f32(&p[0].x); *x = v.val[0]; *y = v.val[1]; }
+static inline void      ImSimd4fStore2(ImVec2* p, ImSimd4f x, ImSimd4f y)   { float32x4x2_t v; v.val[0] = x; v.val[1] = y; vst2q_f32(&p[0].x, v); }
+static inline ImSimd4f  ImSimd4fLoad(const float* p)                        { return vld1q_f32(p); }
+static inline void      ImSimd4fStore(float* p, ImSimd4f a)                 { vst1q_f32(p, a); }
+static inline ImSimd4f  ImSimd4fSwapHalves(ImSimd4f a)                      { return vextq_f32(a, a, 2); }
+static inline int       ImSimd4fMaskGt(ImSimd4f a, ImSimd4f b)              { static const uint32_t bits[4] = { 1, 2, 4, 8 }; return (int)vaddvq_u32(vandq_u32(vcgtq_f32(a, b), vld1q_u32(bits))); }
+static inline void      ImSimd4fRectCorners(ImSimd4f pos, ImSimd4f uv, ImSimd4f* out)
+{
+    const float32x2_t pos_lo = vget_low_f32(pos), pos_hi = vget_high_f32(pos), uv_lo = vget_low_f32(uv), uv_hi = vget_high_f32(uv);
+    out[0] = vcombine_f32(pos_lo, uv_lo);
+    out[1] = vcombine_f32(vset_lane_f32(vget_lane_f32(pos_hi, 0), pos_lo, 0), vset_lane_f32(vget_lane_f32(uv_hi, 0), uv_lo, 0));
+    out[2] = vcombine_f32(pos_hi, uv_hi);
+    out[3] = vcombine_f32(vset_lane_f32(vget_lane_f32(pos_lo, 0), pos_hi, 0), vset_lane_f32(vget_lane_f32(uv_lo, 0), uv_hi, 0));
+}
+static inline void      ImSimd4fStoreInt(int* p, ImSimd4f a)                { vst1q_s32(p, vcvtq_s32_f32(a)); }
+
+#else
+
+// Written out lane by lane, loops over the 4 floats are not always unrolled and keep the struct in memory
+static inline ImSimd4f  ImSimd4fSet(float a, float b, float c, float d)     { ImSimd4f r; r.v[0] = a; r.v[1] = b; r.v[2] = c; r.v[3] = d; return r; }
+static inline ImSimd4f  ImSimd4fSet1(float f)                               { return ImSimd4fSet(f, f, f, f); }
+static inline ImSimd4f  ImSimd4fAdd(ImSimd4f a, ImSimd4f b)                 { a.v[0] += b.v[0]; a.v[1] += b.v[1]; a.v[2] += b.v[2]; a.v[3] += b.v[3]; return a; }
+static inline ImSimd4f  ImSimd4fSub(ImSimd4f a, ImSimd4f b)                 { a.v[0] -= b.v[0]; a.v[1] -= b.v[1]; a.v[2] -= b.v[2]; a.v[3] -= b.v[3]; return a; }
+static inline ImSimd4f  ImSimd4fMul(ImSimd4f a, ImSimd4f b)                 { a.v[0] *= b.v[0]; a.v[1] *= b.v[1]; a.v[2] *= b.v[2]; a.v[3] *= b.v[3]; return a; }
+static inline ImSimd4f  ImSimd4fDiv(ImSimd4f a, ImSimd4f b)                 { a.v[0] /= b.v[0]; a.v[1] /= b.v[1]; a.v[2] /= b.v[2]; a.v[3] /= b.v[3]; return a; }
+static inline ImSimd4f  ImSimd4fSqrt(ImSimd4f a)                            { a.v[0] = sqrtf(a.v[0]); a.v[1] = sqrtf(a.v[1]); a.v[2] = sqrtf(a.v[2]); a.v[3] = sqrtf(a.v[3]); return a; }
+static inline ImSimd4f  ImSimd4fMin(ImSimd4f a, ImSimd4f b)                 { a.v[0] = a.v[0] < b.v[0] ? a.v[0] : b.v[0]; a.v[1] = a.v[1] < b.v[1] ? a.v[1] : b.v[1]; a.v[2] = a.v[2] < b.v[2] ? a.v[2] : b.v[2]; a.v[3] = a.v[3] < b.v[3] ? a.v[3] : b.v[3]; return a; }
+static inline ImSimd4f  ImSimd4fMax(ImSimd4f a, ImSimd4f b)                 { a.v[0] = a.v[0] > b.v[0] ? a.v[0] : b.v[0]; a.v[1] = a.v[1] > b.v[1] ? a.v[1] : b.v[1]; a.v[2] = a.v[2] > b.v[2] ? a.v[2] : b.v[2]; a.v[3] = a.v[3] > b.v[3] ? a.v[3] : b.v[3]; return a; }
+static inline ImSimd4f  ImSimd4fNeg(ImSimd4f a)                             { a.v[0] = -a.v[0]; a.v[1] = -a.v[1]; a.v[2] = -a.v[2]; a.v[3] = -a.v[3]; return a; }
+static inline ImSimd4f  ImSimd4fSelectGt(ImSimd4f a, ImSimd4f b, ImSimd4f if_true, ImSimd4f if_false) { if_true.v[0] = a.v[0] > b.v[0] ? if_true.v[0] : if_false.v[0]; if_true.v[1] = a.v[1] > b.v[1] ? if_true.v[1] : if_false.v[1]; if_true.v[2] = a.v[2] > b.v[2] ? if_true.v[2] : if_false.v[2]; if_true.v[3] = a.v[3] > b.v[3] ? if_true.v[3] : if_false.v[3]; return if_true; }
+static inline void      ImSimd4fLoad2(const ImVec2* p, ImSimd4f* x, ImSimd4f* y) { *x = ImSimd4fSet(p[0].x, p[1].x, p[2].x, p[3].x); *y = ImSimd4fSet(p[0].y, p[1].y, p[2].y, p[3].y); }
+static inline void      ImSimd4fStore2(ImVec2* p, ImSimd4f x, ImSimd4f y)   { p[0].x = x.v[0]; p[0].y = y.v[0]; p[1].x = x.v[1]; p[1].y = y.v[1]; p[2].x = x.v[2]; p[2].y = y.v[2]; p[3].x = x.v[3]; p[3].y = y.v[3]; }
+static inline ImSimd4f  ImSimd4fLoad(const float* p)                        { return ImSimd4fSet(p[0], p[1], p[2], p[3]); }
+static inline void      ImSimd4fStore(float* p, ImSimd4f a)                 { p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3]; }
+static inline ImSimd4f  ImSimd4fSwapHalves(ImSimd4f a)                      { return ImSimd4fSet(a.v[2], a.v[3], a.v[0], a.v[1]); }
+static inline int       ImSimd4fMaskGt(ImSimd4f a, ImSimd4f b)              { return (a.v[0] > b.v[0]) | ((a.v[1] > b.v[1]) << 1) | ((a.v[2] > b.v[2]) << 2) | ((a.v[3] > b.v[3]) << 3); }
+static inline void      ImSimd4fRectCorners(ImSimd4f pos, ImSimd4f uv, ImSimd4f* out)
+{
+    out[0] = ImSimd4fSet(pos.v[0], pos.v[1], uv.v[0], uv.v[1]);
+    out[1] = ImSimd4fSet(pos.v[2], pos.v[1], uv.v[2], uv.v[1]);
+    out[2] = ImSimd4fSet(pos.v[2], pos.v[3], uv.v[2], uv.v[3]);
+    out[3] = ImSimd4fSet(pos.v[0], pos.v[3], uv.v[0], uv.v[3]);
+}
+static inline void      ImSimd4fStoreInt(int* p, ImSimd4f a)                { p[0] = (int)a.v[0]; p[1] = (int)a.v[1]; p[2] = (int)a.v[2]; p[3] = (int)a.v[3]; }
+
+#endif
+
+// Number of bytes from s on (up to s_end) in 32..127: printable ASCII, each its own codepoint with no UTF-8 decoding. Checked 16 at a time.
+static inline int       ImDrawSimdCountPrintableAscii(const char* s, const char* s_end)
+{
+    const char* p = s;
+#if defined(IMDRAWSIMD_SSE2)
+    const __m128i before_space = _mm_set1_epi8(31);
+    while (s_end - p >= 16 && _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_loadu_si128((const __m128i*)p), before_space)) == 0xFFFF)
+        p += 16;
+#elif defined(IMDRAWSIMD_NEON)
+    while (s_end - p >= 16 && vminvq_s8(vld1q_s8((const int8_t*)p)) > 31)
+        p += 16;
+#endif
+    while (p < s_end && (signed char)*p > 31)
+        p++;
+    return (int)(p - s);
+}
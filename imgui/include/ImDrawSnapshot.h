@@ -0,0 +1,25 @@
+// Deep copy of a frame's ImDrawData for backends that render on another thread.
+// ImDrawData points into ImGui's own lists which the next NewFrame() rewrites, so a render thread must work from a
+// copy. The copied lists are kept from frame to frame and only grow, once warm a capture is a few memcpy and no
+// allocation. Each copy keeps the _OwnerName of its source, which is what ImDrawListCache matches lists by.
+// The display size, framebuffer scale and frame number are captured too as the render side must not read ImGuiIO.
+#pragma once
+#include "imgui.h"
+
+struct ImDrawSnapshot
+{
+    ImDrawData              DrawData;           // CmdLists points at Lists, valid until the next Capture()
+    ImVector<ImDrawList*>   Lists;              // never shrinks so the lists keep their buffers
+    ImVector<ImDrawList*>   CmdLists;           // the first DrawData.CmdListsCount entries of Lists
+    ImVec2                  DisplaySize;        // io.DisplaySize / io.DisplayFramebufferScale at capture
+    ImVec2                  FramebufferScale;
+    int                     FrameCount;         // ImGui::GetFrameCount() at capture, texture updates made for a later frame must wait
+
+    ImDrawSnapshot() { DisplaySize = ImVec2(0.0f, 0.0f); FramebufferScale = ImVec2(1.0f, 1.0f); FrameCount = 0; }
+    ~ImDrawSnapshot() { Clear(); }
+
+    // Copy draw_data (may be NULL for an empty frame). Call on the thread that owns the ImGui context, after
+    // ImGui::Render(). User callbacks are copied as is and will run wherever the snapshot is rendered.
+    IMGUI_API void          Capture(const ImDrawData* draw_data);
+    IMGUI_API void          Clear();
+};
@@ -0,0 +1,85 @@
+// Vertex layouts the SDL and Qt OpenGL3 bindings upload, IMGUI_DRAWVERT_LAYOUT in imconfig.h picks one at build time.
+// ImDrawList always builds the 20 bytes ImDrawVert (float positions and UVs), the bindings convert every list with
+// ImDrawVertWrite<ImDrawVertLayout>() while copying it into their vertex buffer and describe the attributes with
+// ImDrawVertLayout::Attribs(). Positions of a layout are in 1 / PosScale() pixels, the projection matrix scales them back.
+#pragma once
+#include "imgui.h"
+#include <stddef.h>
+#include <string.h>
+
+enum ImDrawVertAttribType_
+{
+    ImDrawVertAttribType_Float,
+    ImDrawVertAttribType_Short,
+    ImDrawVertAttribType_UnsignedShort,
+    ImDrawVertAttribType_UnsignedByte
+};
+
+// One glVertexAttribPointer() worth of description
+struct ImDrawVertAttrib
+{
+    int                 Components;
+    int                 Type;               // ImDrawVertAttribType_
+    bool                Normalized;
+    int                 Offset;
+};
+
+// 20 bytes, ImDrawVert as ImDrawList built it
+struct ImDrawVertLayoutFloat
+{
+    typedef ImDrawVert  Vert;
+
+    static float        PosScale()          { return 1.0f; }
+    static const ImDrawVertAttrib* Attribs()    // position, uv, color
+    {
+        static const ImDrawVertAttrib attribs[3] =
+        {
+            { 2, ImDrawVertAttribType_Float, false, (int)offsetof(ImDrawVert, pos) },
+            { 2, ImDrawVertAttribType_Float, false, (int)offsetof(ImDrawVert, uv) },
+            { 4, ImDrawVertAttribType_UnsignedByte, true, (int)offsetof(ImDrawVert, col) },
+        };
+        return attribs;
+    }
+    static void         Write(Vert* dst, const ImDrawVert* src, int count) { memcpy(dst, src, (size_t)count * sizeof(Vert)); }
+};
+
+// 12 bytes: positions as int16 in 1/8 pixels (-4096 to 4096 pixels), UVs as unorm16 and the packed color.
+// Out of range values are clamped, so UIs larger than 4096 pixels and images drawn with UVs outside 0..1 (repeating
+// textures) need the float layout.
+#define IM_DRAWVERT_COMPACT_POS_FRAC_BITS   3
+struct ImDrawVertCompact
+{
+    short               pos[2];
+    unsigned short      uv[2];
+    ImU32               col;
+};
+
+struct ImDrawVertLayoutCompact
+{
+    typedef ImDrawVertCompact Vert;
+
+    static float        PosScale()          { return (float)(1 << IM_DRAWVERT_COMPACT_POS_FRAC_BITS); }
+    static const ImDrawVertAttrib* Attribs()    // position, uv, color
+    {
+        static const ImDrawVertAttrib attribs[3] =
+        {
+            { 2, ImDrawVertAttribType_Short, false, (int)offsetof(ImDrawVertCompact, pos) },
+            { 2, ImDrawVertAttribType_UnsignedShort, true, (int)offsetof(ImDrawVertCompact, uv) },
+            { 4, ImDrawVertAttribType_UnsignedByte, true, (int)offsetof(ImDrawVertCompact, col) },
+        };
+        return attribs;
+    }
+    IMGUI_API static void Write(Vert* dst, const ImDrawVert* src, int count);
+};
+
+#ifndef IMGUI_DRAWVERT_LAYOUT
+#define IMGUI_DRAWVERT_LAYOUT ImDrawVertLayoutFloat
+#endif
+typedef IMGUI_DRAWVERT_LAYOUT ImDrawVertLayout;
+
+// Convert count vertices into dst, laid out as LAYOUT::Vert
+template<typename LAYOUT>
+static inline void ImDrawVertWrite(void* dst, const ImDrawVert* src, int count)
+{
+    LAYOUT::Write((typename LAYOUT::Vert*)dst, src, count);
+}
@@ -33,6 +33,17 @@
 //---- Pack colors to BGRA instead of RGBA (remove need to post process vertex buffer in back ends)
 //#define IMGUI_USE_BGRA_PACKED_COLOR
 
+//---- Use the default font atlas baked at build time (imgui_default_font_atlas.h, written by tools/ImFontAtlasBake.cpp) so AddFontDefault() doesn't decompress and rasterize ProggyClean at runtime
+//#define IMGUI_PREBAKED_DEFAULT_FONT
+
+//---- Use the plain float versions of the SSE2 / NEON ImDrawList tessellation loops (ImDrawSimd.h), they give the same vertices
+//#define IMGUI_DISABLE_SIMD
+
+//---- Vertex layout the SDL / Qt OpenGL3 bindings upload (ImDrawVertLayout.h), ImDrawList still builds ImDrawVert and the bindings convert it
+//---- ImDrawVertLayoutCompact is 12 bytes instead of 20: int16 positions in 1/8 pixels (up to 4096 pixels), unorm16 UVs (0..1) and the packed color
+//---- It trades CPU for GPU bandwidth: converting a changed list costs about twice the memcpy it replaces, only worth it when vertex fetch or bus bandwidth is the bottleneck
+//#define IMGUI_DRAWVERT_LAYOUT ImDrawVertLayoutCompact
+
 //---- Implement STB libraries in a namespace to avoid linkage conflicts
 //#define IMGUI_STB_NAMESPACE     ImGuiStb
 
@@ -766,6 +766,7 @@ struct ImGuiStyle
     bool        AntiAliasedLines;           // Enable anti-aliasing on lines/borders. Disable if you are really tight on CPU/GPU.
     bool        AntiAliasedShapes;          // Enable anti-aliasing on filled shapes (rounded rectangles, circles, etc.)
     float       CurveTessellationTol;       // Tessellation tolerance. Decrease for highly tessellated curves (higher quality, more polygons), increase to reduce quality.
+    float       CircleSegmentMaxError;      // Maximum distance in pixels between a circle and its polygon, for circles and arcs drawn without an explicit segment count and for rounded corners. Decrease for smoother circles (more polygons).
     ImVec4      Colors[ImGuiCol_COUNT];
 
     IMGUI_API ImGuiStyle();
@@ -1283,8 +1284,8 @@ struct ImDrawList
     IMGUI_API void  AddQuadFilled(const ImVec2& a, const ImVec2& b, const ImVec2& c, const ImVec2& d, ImU32 col);
     IMGUI_API void  AddTriangle(const ImVec2& a, const ImVec2& b, const ImVec2& c, ImU32 col, float thickness = 1.0f);
     IMGUI_API void  AddTriangleFilled(const ImVec2& a, const ImVec2& b, const ImVec2& c, ImU32 col);
-    IMGUI_API void  AddCircle(const ImVec2& centre, float radius, ImU32 col, int num_segments = 12, float thickness = 1.0f);
-    IMGUI_API void  AddCircleFilled(const ImVec2& centre, float radius, ImU32 col, int num_segments = 12);
+    IMGUI_API void  AddCircle(const ImVec2& centre, float radius, ImU32 col, int num_segments = 0, float thickness = 1.0f);              // num_segments: 0 to derive it from the radius and style.CircleSegmentMaxError
+    IMGUI_API void  AddCircleFilled(const ImVec2& centre, float radius, ImU32 col, int num_segments = 0);
     IMGUI_API void  AddText(const ImVec2& pos, ImU32 col, const char* text_begin, const char* text_end = NULL);
     IMGUI_API void  AddText(const ImFont* font, float font_size, const ImVec2& pos, ImU32 col, const char* text_begin, const char* text_end = NULL, float wrap_width = 0.0f, const ImVec4* cpu_fine_clip_rect = NULL);
     IMGUI_API void  AddImage(ImTextureID user_texture_id, const ImVec2& a, const ImVec2& b, const ImVec2& uv_a = ImVec2(0,0), const ImVec2& uv_b = ImVec2(1,1), ImU32 col = 0xFFFFFFFF);
@@ -1299,8 +1300,8 @@ struct ImDrawList
     inline    void  PathLineToMergeDuplicate(const ImVec2& pos)                 { if (_Path.Size == 0 || memcmp(&_Path[_Path.Size-1], &pos, 8) != 0) _Path.push_back(pos); }
     inline    void  PathFillConvex(ImU32 col)                                   { AddConvexPolyFilled(_Path.Data, _Path.Size, col, true); PathClear(); }
     inline    void  PathStroke(ImU32 col, bool closed, float thickness = 1.0f)  { AddPolyline(_Path.Data, _Path.Size, col, closed, thickness, true); PathClear(); }
-    IMGUI_API void  PathArcTo(const ImVec2& centre, float radius, float a_min, float a_max, int num_segments = 10);
-    IMGUI_API void  PathArcToFast(const ImVec2& centre, float radius, int a_min_of_12, int a_max_of_12);                                // Use precomputed angles for a 12 steps circle
+    IMGUI_API void  PathArcTo(const ImVec2& centre, float radius, float a_min, float a_max, int num_segments = 0);                       // num_segments: 0 to derive it from the radius and style.CircleSegmentMaxError
+    IMGUI_API void  PathArcToFast(const ImVec2& centre, float radius, int a_min_of_12, int a_max_of_12);                                // Use precomputed angles for a 12 steps circle, quarter arcs (multiples of 3) get as many steps as the radius needs
     IMGUI_API void  PathBezierCurveTo(const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, int num_segments = 0);
     IMGUI_API void  PathRect(const ImVec2& rect_min, const ImVec2& rect_max, float rounding = 0.0f, int rounding_corners_flags = ~0);   // rounding_corners_flags: 4-bits corresponding to which corner to round
 
@@ -1360,6 +1361,7 @@ struct ImFontConfig
     bool            MergeMode;                  // false    // Merge into previous ImFont, so you can combine multiple inputs font into one ImFont (e.g. ASCII font + icons + Japanese glyphs). You may want to use GlyphOffset.y when merge font of different heights.
     unsigned int    RasterizerFlags;            // 0x00     // Settings for custom font rasterizer (e.g. ImGuiFreeType). Leave as zero if you aren't using one.
     float           RasterizerMultiply;         // 1.0f     // Brighten (>1.0f) or darken (<1.0f) font output. Brightening small fonts may be a good workaround to make them more readable.
+    bool            GlyphsOnDemand;             // false    // Rasterize the glyphs of GlyphRanges the first time text uses them instead of in Build(), see ImFontAtlas::UpdateGlyphsOnDemand(). Meant for big ranges (e.g. GetGlyphRangesChinese()) merged into a regular font.
 
     // [Internal]
     char            Name[32];                               // Name (strictly to ease debugging)
@@ -1384,6 +1386,7 @@ struct ImFontGlyph
 //  3. Upload the pixels data into a texture within your graphics system.
 //  4. Call SetTexID(my_tex_id); and pass the pointer/identifier to your texture. This value will be passed back to you during rendering to identify the texture.
 // IMPORTANT: If you pass a 'glyph_ranges' array to AddFont*** functions, you need to make sure that your array persist up until the ImFont is build (when calling GetTextData*** or Build()). We only copy the pointer, not the data.
+struct ImFontAtlasOnDemand;         // [Internal] Packing state of the ImFontConfig::GlyphsOnDemand fonts
 struct ImFontAtlas
 {
     IMGUI_API ImFontAtlas();
@@ -1408,6 +1411,15 @@ struct ImFontAtlas
     IMGUI_API void              GetTexDataAsRGBA32(unsigned char** out_pixels, int* out_width, int* out_height, int* out_bytes_per_pixel = NULL);  // 4 bytes-per-pixel
     void                        SetTexID(ImTextureID id)    { TexID = id; }
 
+    // Glyphs on demand
+    // Inputs added with ImFontConfig::GlyphsOnDemand only get a band of empty rows at the bottom of the texture in Build(). Text looking up one of their
+    // glyphs draws the fallback glyph and queues it, UpdateGlyphsOnDemand() then renders the queued glyphs into the band and returns the rectangle of
+    // TexPixelsAlpha8 (and TexPixelsRGBA32 if present) to upload again. Call it once a frame before ImGui::NewFrame(). When the band is full the glyphs
+    // used least recently are evicted and the rest is packed again, the whole band is returned then. The CPU-side pixels are needed for this, so don't
+    // call ClearTexData() when HasGlyphsOnDemand().
+    IMGUI_API bool              UpdateGlyphsOnDemand(int* out_x, int* out_y, int* out_width, int* out_height);
+    bool                        HasGlyphsOnDemand() const   { return OnDemand != NULL; }
+
     //-------------------------------------------
     // Glyph Ranges
     //-------------------------------------------
@@ -1464,6 +1476,11 @@ struct ImFontAtlas
     ImTextureID                 TexID;              // User data to refer to the texture once it has been uploaded to user's graphic systems. It is passed back to you during rendering via the ImDrawCmd structure.
     int                         TexDesiredWidth;    // Texture width desired by user before Build(). Must be a power-of-two. If have many glyphs your graphics API have texture size restrictions you may want to increase texture width to decrease height.
     int                         TexGlyphPadding;    // Padding between glyphs within texture in pixels. Defaults to 1.
+    int                         BuildThreads;       // = 0      // Threads rendering glyphs in Build(), 0 for one per hardware thread. Unless this is 1, io.MemAllocFn/MemFreeFn must be thread-safe.
+    const char*                 BuildCacheFilename; // = NULL   // Path to a file keeping the built atlas between runs. Build() loads it instead of rasterizing when the fonts and their ImFontConfig are unchanged, else builds and rewrites it. NULL to always build.
+    int                         TexOnDemandHeight;  // = 0      // Rows kept below the built glyphs for the GlyphsOnDemand inputs, 0 for room for about 1000 of their glyphs.
+    bool                        TexDistanceField;   // = false  // Render the glyphs as signed distance fields (stbtt_GetGlyphSDF) instead of coverage, so one size stays sharp at any SetWindowFontScale() / FontGlobalScale. The renderer must then threshold the alpha it samples from TexID. OversampleH/V and RasterizerMultiply are ignored.
+    int                         TexDistanceFieldSpread; // = 4  // Pixels (at SizePixels) the field reaches on each side of the outline: alpha is 128 on the outline and changes by 127 / TexDistanceFieldSpread per pixel. Also added around every glyph.
 
     // [Internal]
     // NB: Access texture data via GetTexData*() calls! Which will setup a default font for you.
@@ -1476,6 +1493,7 @@ struct ImFontAtlas
     ImVector<CustomRect>        CustomRects;        // Rectangles for packing custom texture data into the atlas.
     ImVector<ImFontConfig>      ConfigData;         // Internal data
     int                         CustomRectIds[1];   // Identifiers of custom texture rectangle used by ImFontAtlas/ImDrawList
+    ImFontAtlasOnDemand*        OnDemand;           // NULL unless an input has GlyphsOnDemand
 };
 
 // Font runtime data and rendering
@@ -1499,6 +1517,8 @@ struct ImFont
     ImFontAtlas*                ContainerAtlas;     //              // What we has been loaded into
     float                       Ascent, Descent;    //              // Ascent: distance from top to bottom of e.g. 'A' [0..FontSize]
     int                         MetricsTotalSurface;//              // Total surface in pixels to get an idea of the font rasterization/texture cost (not exact, we approximate the cost of padding between glyphs)
+    int                         OnDemandGlyphsStart;// = 0xFFFF     // Glyphs from this index on were rendered by ImFontAtlas::UpdateGlyphsOnDemand() and may be evicted
+    mutable ImVector<int>       OnDemandGlyphsUsed; //              // Frame each of them was last looked up in by FindGlyph()
 
     // Methods
     IMGUI_API ImFont();
@@ -41,6 +41,8 @@ struct ImGuiDrawContext;
 struct ImGuiTextEditState;
 struct ImGuiIniData;
 struct ImGuiMouseCursorData;
+struct ImDrawListCircleCache;
+struct ImDrawListCurveCache;
 struct ImGuiPopupRef;
 struct ImGuiWindow;
 
@@ -392,6 +394,57 @@ struct ImGuiMouseCursorData
     ImVec2              TexUvMax[2];
 };
 
+// Circles and rounded corners drawn from precomputed unit circles instead of cosf()/sinf() per point.
+// Segment counts keep the gap between a circle and its polygon under style.CircleSegmentMaxError, rounded up to a multiple of 4
+// so quarter arcs (PathRect() corners) land on table points.
+#define IM_DRAWLIST_CIRCLE_SEGMENT_MIN      4
+#define IM_DRAWLIST_CIRCLE_SEGMENT_MAX      512
+struct ImDrawListCircleCache
+{
+    float               SegmentMaxError;                                    // Style.CircleSegmentMaxError the counts were computed for
+    unsigned short      SegmentCounts[64];                                  // Segment count by radius (rounded up), larger circles are computed each time
+    int                 UnitCircleOffsets[IM_DRAWLIST_CIRCLE_SEGMENT_MAX+1];// Offset of the N points circle in UnitCircles, -1 until first used
+    ImVector<ImVec2>    UnitCircles;                                        // cos/sin of i/N turns, i = 0..N-1, for each N used so far
+
+    ImDrawListCircleCache()     { Clear(); }
+    IMGUI_API void              Clear();
+    IMGUI_API int               GetSegmentCount(float radius, float max_error);
+    IMGUI_API const ImVec2*     GetUnitCircle(int num_segments);            // num_segments in 1..IM_DRAWLIST_CIRCLE_SEGMENT_MAX
+};
+
+// Flattened bezier curves of the last frame, so curves that don't change (node editor links...) aren't tessellated again.
+// Curves are stored relative to their first point, a curve that only moved is found as well.
+#define IM_DRAWLIST_CURVE_SEGMENT_MAX       1024
+#define IM_DRAWLIST_CURVE_CACHE_MAX         4096    // Curves kept at most, more are tessellated each time
+struct ImDrawListCurveCache
+{
+    struct CurveKey
+    {
+        ImVec2          Ctrl[3];            // Control points and end point minus the start point
+        float           TessTol;            // Style.CurveTessellationTol for auto-tessellated curves, 0.0f otherwise
+        int             NumSegments;        // 0 for auto-tessellated curves
+    };
+    struct Entry
+    {
+        CurveKey        Key;
+        ImU32           Hash;               // ImHash(Key)
+        int             PointsOffset;
+        int             PointsCount;
+        int             LastUsedFrame;
+    };
+
+    ImVector<int>       Buckets;            // Index in Entries or -1, open addressing on Entry::Hash (2 * IM_DRAWLIST_CURVE_CACHE_MAX slots)
+    ImVector<Entry>     Entries;
+    ImVector<ImVec2>    Points;             // Flattened curves, without their start point
+    int                 Frame;
+    int                 UsedEntries;        // Entries drawn so far this frame
+
+    ImDrawListCurveCache()      { Clear(); }
+    IMGUI_API void              Clear();
+    IMGUI_API void              NewFrame(int frame_count);                  // Drop the curves that weren't drawn during the previous frame
+    IMGUI_API const ImVec2*     GetFlattened(const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, float tess_tol, int num_segments, int* out_count); // p2..p4 relative to p1, NULL when the cache is full (*out_count is still set)
+};
+
 // Storage for current popup stack
 struct ImGuiPopupRef
 {
@@ -471,6 +524,8 @@ struct ImGuiContext
     ImDrawList              OverlayDrawList;                    // Optional software render of mouse cursors, if io.MouseDrawCursor is set + a few debug overlays
     ImGuiMouseCursor        MouseCursor;
     ImGuiMouseCursorData    MouseCursorData[ImGuiMouseCursor_Count_];
+    ImDrawListCircleCache   CircleCache;                        // Unit circles for AddCircle(), AddCircleFilled() and PathRect() corners
+    ImDrawListCurveCache    CurveCache;                         // Flattened PathBezierCurveTo() curves
 
     // Widget state
     ImGuiTextEditState      InputTextState;
@@ -869,12 +924,36 @@ namespace ImGui
 
 } // namespace ImGui
 
+// Font atlas baked at build time: the pixels and tables a build of a single font produced, emitted as constant arrays by tools/ImFontAtlasBake.cpp
+struct ImFontAtlasPrebaked
+{
+    int                     TexWidth, TexHeight;
+    int                     TexDesiredWidth;        // Atlas settings and font size of the bake, the atlas is built as usual when they differ
+    int                     TexGlyphPadding;
+    float                   SizePixels;
+    unsigned short          DefaultRectX, DefaultRectY; // Position of the mouse cursors / white pixel rectangle
+    float                   Ascent, Descent;
+    int                     MetricsTotalSurface;
+    int                     GlyphsCount;
+    int                     IndexCount;             // Size of both IndexAdvanceX and IndexLookup
+    const unsigned char*    Pixels;                 // TexWidth * TexHeight alpha
+    const ImFontGlyph*      Glyphs;
+    const float*            IndexAdvanceX;
+    const unsigned short*   IndexLookup;
+};
+
 // ImFontAtlas internals
 IMGUI_API bool              ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas);
 IMGUI_API void              ImFontAtlasBuildRegisterDefaultCustomRects(ImFontAtlas* atlas);
 IMGUI_API void              ImFontAtlasBuildSetupFont(ImFontAtlas* atlas, ImFont* font, ImFontConfig* font_config, float ascent, float descent); 
 IMGUI_API void              ImFontAtlasBuildPackCustomRects(ImFontAtlas* atlas, void* spc);
 IMGUI_API void              ImFontAtlasBuildFinish(ImFontAtlas* atlas);
+IMGUI_API bool              ImFontAtlasBuildLoadCache(ImFontAtlas* atlas, const char* filename);
+IMGUI_API bool              ImFontAtlasBuildSaveCache(ImFontAtlas* atlas, const char* filename);
+IMGUI_API bool              ImFontAtlasBuildLoadPrebaked(ImFontAtlas* atlas, const ImFontAtlasPrebaked* prebaked);
+IMGUI_API void              ImFontAtlasBuildSetupGlyphsOnDemand(ImFontAtlas* atlas, int band_y);
+IMGUI_API void              ImFontAtlasBuildIndexGlyphsOnDemand(ImFontAtlas* atlas, ImFont* font);
+IMGUI_API void              ImFontAtlasBuildClearGlyphsOnDemand(ImFontAtlas* atlas);
 IMGUI_API void              ImFontAtlasBuildMultiplyCalcLookupTable(unsigned char out_table[256], float in_multiply_factor);
 IMGUI_API void              ImFontAtlasBuildMultiplyRectAlpha8(const unsigned char table[256], unsigned char* pixels, int x, int y, int w, int h, int stride);
 
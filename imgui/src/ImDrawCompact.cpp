@@ -0,0 +1,138 @@
+#include "ImDrawCompact.h"
+#include <string.h>
+
+static bool ImDrawCompactSameClip(const int* a, const int* b)
+{
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2] && a[3] == b[3];
+}
+
+void ImDrawCompactCommands(const ImDrawData* draw_data, int fb_height, ImVector<ImDrawCompactCmd>& out_cmds, ImDrawCompactStats* stats, const ImDrawListSlot* slots)
+{
+    ImDrawCompactStats s;
+    int naive_calls = 0;
+    out_cmds.resize(0);
+
+    // Merge pass, commands may only merge inside one list as each list has its own base vertex
+    int vtx_offset = 0;
+    unsigned int idx_offset = 0;
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        ImDrawCompactCmd* prev = NULL;
+        if (slots)
+        {
+            vtx_offset = slots[n].VtxOffset;
+            idx_offset = (unsigned int)slots[n].IdxOffset;
+        }
+        for (const ImDrawCmd* pcmd = cmd_list->CmdBuffer.begin(); pcmd != cmd_list->CmdBuffer.end(); pcmd++)
+        {
+            s.SourceCmds++;
+            if (pcmd->UserCallback)
+            {
+                ImDrawCompactCmd cmd;
+                memset(&cmd, 0, sizeof(cmd));
+                cmd.CmdList = cmd_list;
+                cmd.UserCmd = pcmd;
+                out_cmds.push_back(cmd);
+                prev = NULL;
+            }
+            else if (pcmd->ElemCount > 0)
+            {
+                naive_calls += 3;
+                int clip[4] = { (int)pcmd->ClipRect.x, (int)(fb_height - pcmd->ClipRect.w), (int)(pcmd->ClipRect.z - pcmd->ClipRect.x), (int)(pcmd->ClipRect.w - pcmd->ClipRect.y) };
+                if (prev && prev->TextureId == pcmd->TextureId && ImDrawCompactSameClip(prev->ClipRect, clip) && prev->IdxOffset + prev->ElemCount == idx_offset)
+                {
+                    prev->ElemCount += pcmd->ElemCount;
+                }
+                else
+                {
+                    ImDrawCompactCmd cmd;
+                    memset(&cmd, 0, sizeof(cmd));
+                    cmd.TextureId = pcmd->TextureId;
+                    memcpy(cmd.ClipRect, clip, sizeof(clip));
+                    cmd.IdxOffset = idx_offset;
+                    cmd.ElemCount = pcmd->ElemCount;
+                    cmd.VtxOffset = vtx_offset;
+                    cmd.CmdList = cmd_list;
+                    out_cmds.push_back(cmd);
+                    prev = &out_cmds.back();
+                }
+            }
+            idx_offset += pcmd->ElemCount;
+        }
+        vtx_offset += cmd_list->VtxBuffer.Size;
+    }
+
+    // State pass, a callback may leave anything bound so the draw after it always sets everything again
+    const ImDrawCompactCmd* last = NULL;
+    for (ImDrawCompactCmd* cmd = out_cmds.begin(); cmd != out_cmds.end(); cmd++)
+    {
+        if (cmd->UserCmd)
+        {
+            last = NULL;
+            continue;
+        }
+        cmd->BindTexture = !last || last->TextureId != cmd->TextureId;
+        cmd->SetScissor = !last || !ImDrawCompactSameClip(last->ClipRect, cmd->ClipRect);
+        s.DrawCalls++;
+        s.TextureBinds += cmd->BindTexture ? 1 : 0;
+        s.Scissors += cmd->SetScissor ? 1 : 0;
+        last = cmd;
+    }
+    s.SavedCalls = naive_calls - (s.DrawCalls + s.TextureBinds + s.Scissors);
+    if (stats)
+        *stats = s;
+}
+
+void ImDrawCompactBuildIndirect(const ImVector<ImDrawCompactCmd>& cmds, int vtx_base, int idx_base, ImVector<ImDrawIndirectCmd>& out_cmds, ImVector<ImVec4>& out_clips, ImVector<ImDrawIndirectRun>& out_runs, ImDrawCompactStats* stats)
+{
+    out_cmds.resize(0);
+    out_clips.resize(0);
+    out_runs.resize(0);
+    ImDrawIndirectRun* run = NULL;
+    for (const ImDrawCompactCmd* cmd = cmds.begin(); cmd != cmds.end(); cmd++)
+    {
+        if (cmd->UserCmd)
+        {
+            ImDrawIndirectRun callback_run;
+            callback_run.TextureId = NULL;
+            callback_run.FirstCmd = out_cmds.Size;
+            callback_run.CmdCount = 0;
+            callback_run.UserCmd = cmd;
+            out_runs.push_back(callback_run);
+            run = NULL;
+            continue;
+        }
+        if (!run || run->TextureId != cmd->TextureId)
+        {
+            ImDrawIndirectRun new_run;
+            new_run.TextureId = cmd->TextureId;
+            new_run.FirstCmd = out_cmds.Size;
+            new_run.CmdCount = 0;
+            new_run.UserCmd = NULL;
+            out_runs.push_back(new_run);
+            run = &out_runs.back();
+        }
+        ImDrawIndirectCmd indirect;
+        indirect.Count = cmd->ElemCount;
+        indirect.InstanceCount = 1;
+        indirect.FirstIndex = idx_base + cmd->IdxOffset;
+        indirect.BaseVertex = vtx_base + cmd->VtxOffset;
+        indirect.BaseInstance = (unsigned int)out_cmds.Size;
+        out_cmds.push_back(indirect);
+        out_clips.push_back(ImVec4((float)cmd->ClipRect[0], (float)cmd->ClipRect[1], (float)cmd->ClipRect[2], (float)cmd->ClipRect[3]));
+        run->CmdCount++;
+    }
+
+    if (stats)
+    {
+        const int naive_calls = stats->SavedCalls + stats->DrawCalls + stats->TextureBinds + stats->Scissors;
+        int draw_runs = 0;
+        for (const ImDrawIndirectRun* r = out_runs.begin(); r != out_runs.end(); r++)
+            draw_runs += r->UserCmd ? 0 : 1;
+        stats->DrawCalls = draw_runs;
+        stats->TextureBinds = draw_runs;
+        stats->Scissors = 0;
+        stats->SavedCalls = naive_calls - draw_runs * 2;
+    }
+}
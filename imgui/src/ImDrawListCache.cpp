@@ -0,0 +1,236 @@
+#include "ImDrawListCache.h"
+#include "ImDrawVertLayout.h"
+#include "imgui_internal.h"
+#include <string.h>
+#include <float.h>
+
+// Cheap 64-bit hash, one multiply per 8 bytes, good enough to tell a changed list from an unchanged one
+static ImU64 ImDrawListCacheHash(const void* data, size_t size, ImU64 h)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    for (; size >= 8; p += 8, size -= 8)
+    {
+        ImU64 w;
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 32;
+    }
+    for (; size > 0; p++, size--)
+        h = (h ^ *p) * 0x100000001B3ULL;
+    return h;
+}
+
+static ImU64 ImDrawListCacheHashList(const ImDrawList* cmd_list)
+{
+    ImU64 h = 0xCBF29CE484222325ULL ^ ((ImU64)cmd_list->VtxBuffer.Size << 32) ^ (ImU64)cmd_list->IdxBuffer.Size;
+    h = ImDrawListCacheHash(cmd_list->VtxBuffer.Data, (size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), h);
+    return ImDrawListCacheHash(cmd_list->IdxBuffer.Data, (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), h);
+}
+
+// The commands are not uploaded but change what the frame looks like (clip rects, textures)
+static ImU64 ImDrawListCacheHashCommands(const ImDrawList* cmd_list, ImU64 h)
+{
+    for (const ImDrawCmd* pcmd = cmd_list->CmdBuffer.begin(); pcmd != cmd_list->CmdBuffer.end(); pcmd++)
+    {
+        h = ImDrawListCacheHash(&pcmd->ElemCount, sizeof(pcmd->ElemCount), h);
+        h = ImDrawListCacheHash(&pcmd->ClipRect, sizeof(pcmd->ClipRect), h);
+        h = ImDrawListCacheHash(&pcmd->TextureId, sizeof(pcmd->TextureId), h);
+        h = ImDrawListCacheHash(&pcmd->UserCallback, sizeof(pcmd->UserCallback), h);
+    }
+    return h;
+}
+
+static ImVec4 ImDrawListCacheEmptyRect()
+{
+    return ImVec4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+}
+
+static void ImDrawListCacheAddRect(ImVec4& r, const ImVec4& add)
+{
+    if (add.x >= add.z || add.y >= add.w)
+        return;
+    r.x = ImMin(r.x, add.x);
+    r.y = ImMin(r.y, add.y);
+    r.z = ImMax(r.z, add.z);
+    r.w = ImMax(r.w, add.w);
+}
+
+// Window backgrounds are drawn with the full display as clip rect, so the bounds come from the vertices and the clip
+// rects only trim them. Positions are display coordinates, scale them like ScaleClipRects() did for the clip rects.
+static ImVec4 ImDrawListCacheBounds(const ImDrawList* cmd_list, const ImVec2& scale)
+{
+    ImVec4 clip = ImDrawListCacheEmptyRect();
+    for (const ImDrawCmd* pcmd = cmd_list->CmdBuffer.begin(); pcmd != cmd_list->CmdBuffer.end(); pcmd++)
+        if (!pcmd->UserCallback && pcmd->ElemCount > 0)
+            ImDrawListCacheAddRect(clip, pcmd->ClipRect);
+    ImVec4 r = ImDrawListCacheEmptyRect();
+    for (const ImDrawVert* v = cmd_list->VtxBuffer.begin(); v != cmd_list->VtxBuffer.end(); v++)
+    {
+        r.x = ImMin(r.x, v->pos.x);
+        r.y = ImMin(r.y, v->pos.y);
+        r.z = ImMax(r.z, v->pos.x);
+        r.w = ImMax(r.w, v->pos.y);
+    }
+    r = ImVec4(ImMax(r.x * scale.x, clip.x), ImMax(r.y * scale.y, clip.y), ImMin(r.z * scale.x, clip.z), ImMin(r.w * scale.y, clip.w));
+    return (r.x < r.z && r.y < r.w) ? r : ImDrawListCacheEmptyRect();
+}
+
+void ImDrawListCache::Clear()
+{
+    Entries.resize(0);
+    ResidentVtxUsed = ResidentIdxUsed = 0;
+    ResetPending = false;
+    StreamVtxCount = StreamIdxCount = 0;
+    FrameHash = 0;
+    Damage = ImDrawListCacheEmptyRect();
+}
+
+bool ImDrawListCache::DamageScissor(int fb_width, int fb_height, int out_rect[4]) const
+{
+    const int x1 = (int)ImMax(Damage.x, 0.0f);
+    const int y1 = (int)ImMax(Damage.y, 0.0f);
+    const int x2 = (int)ImMin(Damage.z + 1.0f, (float)fb_width);
+    const int y2 = (int)ImMin(Damage.w + 1.0f, (float)fb_height);
+    if (x1 >= x2 || y1 >= y2)
+        return false;
+    out_rect[0] = x1;
+    out_rect[1] = fb_height - y2;
+    out_rect[2] = x2 - x1;
+    out_rect[3] = y2 - y1;
+    return true;
+}
+
+bool ImDrawListCache::Update(const ImDrawData* draw_data, const ImVec2& fb_scale, int stream_vtx_base, int stream_idx_base, int resident_vtx_base, int resident_idx_base, int resident_vtx_capacity, int resident_idx_capacity, ImVector<ImDrawListSlot>& out_slots, ImDrawListCacheStats* stats)
+{
+    // Recycle the region requested last frame, nothing in it survives
+    const bool reset = ResetPending;
+    if (reset)
+    {
+        for (Entry* e = Entries.begin(); e != Entries.end(); e++)
+            e->Resident = false;
+        ResidentVtxUsed = ResidentIdxUsed = 0;
+        ResetPending = false;
+    }
+
+    ImDrawListCacheStats s;
+    StreamVtxCount = StreamIdxCount = 0;
+    FrameHash = 0xCBF29CE484222325ULL;
+    Damage = ImDrawListCacheEmptyRect();
+    out_slots.resize(draw_data->CmdListsCount);
+    for (Entry* e = Entries.begin(); e != Entries.end(); e++)
+        e->Seen = false;
+
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        const int vtx_count = cmd_list->VtxBuffer.Size;
+        const int idx_count = cmd_list->IdxBuffer.Size;
+        const int bytes = vtx_count * (int)sizeof(ImDrawVertLayout::Vert) + idx_count * (int)sizeof(ImDrawIdx);
+        const void* id = cmd_list->_OwnerName ? (const void*)cmd_list->_OwnerName : (const void*)cmd_list;
+        const ImU64 hash = ImDrawListCacheHashList(cmd_list);
+        const ImU64 draw_hash = ImDrawListCacheHashCommands(cmd_list, hash);
+        FrameHash = ImDrawListCacheHash(&draw_hash, sizeof(draw_hash), FrameHash);
+        ImDrawListSlot& slot = out_slots[n];
+        s.Lists++;
+
+        Entry* entry = NULL;
+        for (Entry* e = Entries.begin(); e != Entries.end(); e++)
+            if (e->Id == id)
+            {
+                entry = e;
+                break;
+            }
+        if (!entry)
+        {
+            Entry new_entry;
+            new_entry.Id = id;
+            new_entry.Hash = ~hash;
+            new_entry.DrawHash = ~draw_hash;
+            new_entry.Bounds = ImDrawListCacheEmptyRect();
+            new_entry.Index = -1;
+            new_entry.VtxOffset = new_entry.IdxOffset = 0;
+            new_entry.VtxCount = new_entry.IdxCount = 0;
+            new_entry.Resident = false;
+            new_entry.Seen = false;
+            Entries.push_back(new_entry);
+            entry = &Entries.back();
+        }
+        entry->Seen = true;
+
+        // A changed window damages where it was and where it is now, so does moving in front of / behind another one
+        const ImVec4 bounds = ImDrawListCacheBounds(cmd_list, fb_scale);
+        if (entry->DrawHash != draw_hash || entry->Index != n)
+        {
+            ImDrawListCacheAddRect(Damage, entry->Bounds);
+            ImDrawListCacheAddRect(Damage, bounds);
+        }
+        entry->DrawHash = draw_hash;
+        entry->Bounds = bounds;
+        entry->Index = n;
+
+        // Unchanged and already resident, nothing to do
+        if (entry->Hash == hash && entry->Resident)
+        {
+            slot.VtxOffset = entry->VtxOffset;
+            slot.IdxOffset = entry->IdxOffset;
+            slot.Upload = false;
+            s.Hits++;
+            s.ReusedBytes += bytes;
+            continue;
+        }
+
+        // Unchanged since last frame, so probably static: promote it to the resident region if there is room
+        if (entry->Hash == hash && vtx_count > 0)
+        {
+            if (ResidentVtxUsed + vtx_count <= resident_vtx_capacity && ResidentIdxUsed + idx_count <= resident_idx_capacity)
+            {
+                entry->VtxOffset = resident_vtx_base + ResidentVtxUsed;
+                entry->IdxOffset = resident_idx_base + ResidentIdxUsed;
+                entry->VtxCount = vtx_count;
+                entry->IdxCount = idx_count;
+                entry->Resident = true;
+                ResidentVtxUsed += vtx_count;
+                ResidentIdxUsed += idx_count;
+                slot.VtxOffset = entry->VtxOffset;
+                slot.IdxOffset = entry->IdxOffset;
+                slot.Upload = true;
+                s.UploadedBytes += bytes;
+                continue;
+            }
+            // Would fit once the lists that went away or changed are dropped, don't recycle a region full of live lists
+            int live_vtx = vtx_count, live_idx = idx_count;
+            for (const Entry* e = Entries.begin(); e != Entries.end(); e++)
+                if (e->Resident)
+                {
+                    live_vtx += e->VtxCount;
+                    live_idx += e->IdxCount;
+                }
+            if (live_vtx <= resident_vtx_capacity && live_idx <= resident_idx_capacity)
+                ResetPending = true;
+        }
+
+        // Changed (or no room), stream it
+        entry->Hash = hash;
+        entry->Resident = false;
+        slot.VtxOffset = stream_vtx_base + StreamVtxCount;
+        slot.IdxOffset = stream_idx_base + StreamIdxCount;
+        slot.Upload = true;
+        StreamVtxCount += vtx_count;
+        StreamIdxCount += idx_count;
+        s.UploadedBytes += bytes;
+    }
+
+    // Forget the lists that were not rendered this frame, their resident space is reclaimed by the next reset
+    for (int i = Entries.Size - 1; i >= 0; i--)
+        if (!Entries[i].Seen)
+        {
+            ImDrawListCacheAddRect(Damage, Entries[i].Bounds);
+            Entries.erase(Entries.begin() + i);
+        }
+    if (Damage.x < Damage.z && Damage.y < Damage.w)
+        s.DamagedPixels = (int)((Damage.z - Damage.x) * (Damage.w - Damage.y));
+
+    if (stats)
+        *stats = s;
+    return reset;
+}
@@ -0,0 +1,585 @@
+#include "ImDrawRaster.h"
+#include "imgui_internal.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IMDRAWRASTER_SSE2
+#endif
+
+// Tiles are a multiple of 4 pixels wide so a group of 4 pixels never straddles two threads
+static const int ImDrawRasterTileSize = 64;
+
+struct ImDrawRasterTri
+{
+    int                         X[3], Y[3];     // 1/16 pixel, ordered so the area is positive
+    bool                        TopLeft[3];     // edge i (vertex i to i + 1) owns the pixels exactly on it
+    int                         MinX, MinY;     // pixels to visit, bounds clipped to the ClipRect and target
+    int                         MaxX, MaxY;     // exclusive
+    float                       Plane[6][3];    // r, g, b, a (0..255), u, v as [0] + [1] * x + [2] * y at pixel centres
+    const ImDrawRasterTexture*  Tex;            // NULL when untextured or the uv is constant (folded into the colour)
+    float                       DistanceScale;  // > 0 when Tex is a distance field, alpha = (texel - edge) * DistanceScale + 0.5
+    bool                        Solid;          // constant colour and no texture, filled with Color and integer blending
+    bool                        Rect;           // axis aligned rectangle covering [MinX, MaxX) x [MinY, MaxY), no edges
+    ImU32                       Color;
+};
+
+static inline long long ImDrawRasterFloorDiv(long long a, long long b)
+{
+    long long q = a / b;
+    return (a % b != 0 && a < 0) ? q - 1 : q;
+}
+
+static void ImDrawRasterSetPlane(float plane[3], const float fx[3], const float fy[3], const float f[3])
+{
+    const float ex1 = fx[1] - fx[0], ey1 = fy[1] - fy[0];
+    const float ex2 = fx[2] - fx[0], ey2 = fy[2] - fy[0];
+    const float area = ex1 * ey2 - ex2 * ey1;
+    const float dx = ((f[1] - f[0]) * ey2 - (f[2] - f[0]) * ey1) / area;
+    const float dy = ((f[2] - f[0]) * ex1 - (f[1] - f[0]) * ex2) / area;
+    plane[0] = f[0] - dx * fx[0] - dy * fy[0];
+    plane[1] = dx;
+    plane[2] = dy;
+}
+
+// Alpha 128 is on the outline of a distance field glyph, see ImFontAtlas::TexDistanceField
+static const float ImDrawRasterDistanceEdge = 128.0f / 255.0f;
+
+static inline float ImDrawRasterDistance(float texel, float scale)
+{
+    return ImClamp((texel - ImDrawRasterDistanceEdge) * scale + 0.5f, 0.0f, 1.0f);
+}
+
+static void ImDrawRasterSample(const ImDrawRasterTexture* tex, float u, float v, float out[4])
+{
+    int tx = (int)(u * tex->Width), ty = (int)(v * tex->Height);
+    tx = ImClamp(tx, 0, tex->Width - 1);
+    ty = ImClamp(ty, 0, tex->Height - 1);
+    const unsigned char* p = tex->Pixels + ((size_t)ty * tex->Width + tx) * tex->BytesPerPixel;
+    if (tex->BytesPerPixel == 1)
+    {
+        out[0] = out[1] = out[2] = 1.0f;
+        out[3] = p[0] * (1.0f / 255.0f);
+    }
+    else
+    {
+        for (int c = 0; c < 4; c++)
+            out[c] = p[c] * (1.0f / 255.0f);
+    }
+}
+
+// Colour / uv planes through the three (snapped) vertices of t, or the single colour when nothing varies
+static void ImDrawRasterSetupShading(ImDrawRasterTri& t, const ImDrawVert* const v[3], const ImDrawRasterTexture* tex)
+{
+    float fx[3], fy[3], f[6][3];
+    for (int i = 0; i < 3; i++)
+    {
+        fx[i] = t.X[i] * (1.0f / 16.0f);
+        fy[i] = t.Y[i] * (1.0f / 16.0f);
+        const ImU32 col = v[i]->col;
+        f[0][i] = (float)((col >> IM_COL32_R_SHIFT) & 0xFF);
+        f[1][i] = (float)((col >> IM_COL32_G_SHIFT) & 0xFF);
+        f[2][i] = (float)((col >> IM_COL32_B_SHIFT) & 0xFF);
+        f[3][i] = (float)((col >> IM_COL32_A_SHIFT) & 0xFF);
+        f[4][i] = v[i]->uv.x;
+        f[5][i] = v[i]->uv.y;
+    }
+
+    // Most of a UI samples the atlas' white pixel, a constant uv is looked up once here instead of per pixel
+    t.Tex = tex;
+    if (tex && f[4][0] == f[4][1] && f[4][0] == f[4][2] && f[5][0] == f[5][1] && f[5][0] == f[5][2])
+    {
+        float texel[4];
+        ImDrawRasterSample(tex, f[4][0], f[5][0], texel);
+        if (tex->DistanceFieldSpread > 0.0f)
+            texel[3] = texel[3] >= ImDrawRasterDistanceEdge ? 1.0f : 0.0f;
+        for (int c = 0; c < 4; c++)
+            for (int i = 0; i < 3; i++)
+                f[c][i] *= texel[c];
+        t.Tex = NULL;
+    }
+    t.Solid = t.Tex == NULL;
+    for (int c = 0; c < 4; c++)
+        t.Solid = t.Solid && f[c][0] == f[c][1] && f[c][0] == f[c][2];
+    if (t.Solid)
+        t.Color = IM_COL32((int)(f[0][0] + 0.5f), (int)(f[1][0] + 0.5f), (int)(f[2][0] + 0.5f), (int)(f[3][0] + 0.5f));
+    else
+        for (int c = 0; c < 6; c++)
+            ImDrawRasterSetPlane(t.Plane[c], fx, fy, f[c]);
+
+    // The field changes by 127 / spread per texel, spread over the texels one pixel covers that is the width of the edge
+    t.DistanceScale = 0.0f;
+    if (t.Tex && t.Tex->DistanceFieldSpread > 0.0f)
+    {
+        const float texels_x = sqrtf(ImLengthSqr(ImVec2(t.Plane[4][1] * t.Tex->Width, t.Plane[5][1] * t.Tex->Height)));
+        const float texels_y = sqrtf(ImLengthSqr(ImVec2(t.Plane[4][2] * t.Tex->Width, t.Plane[5][2] * t.Tex->Height)));
+        const float edge_width = ImMax(texels_x, texels_y) * 127.0f / (255.0f * t.Tex->DistanceFieldSpread);
+        t.DistanceScale = edge_width > 0.0f ? 1.0f / edge_width : 1e6f;
+    }
+}
+
+static void ImDrawRasterAddTri(ImVector<ImDrawRasterTri>& tris, const ImDrawVert* v0, const ImDrawVert* v1, const ImDrawVert* v2, const ImVec2& scale, const int clip[4], const ImDrawRasterTexture* tex)
+{
+    const ImDrawVert* v[3] = { v0, v1, v2 };
+    ImDrawRasterTri t;
+    for (int i = 0; i < 3; i++)
+    {
+        t.X[i] = (int)floorf(v[i]->pos.x * scale.x * 16.0f + 0.5f);
+        t.Y[i] = (int)floorf(v[i]->pos.y * scale.y * 16.0f + 0.5f);
+    }
+    long long area = (long long)(t.X[1] - t.X[0]) * (t.Y[2] - t.Y[0]) - (long long)(t.X[2] - t.X[0]) * (t.Y[1] - t.Y[0]);
+    if (area == 0)
+        return;
+    if (area < 0)
+    {
+        const ImDrawVert* tmp = v[1];
+        v[1] = v[2];
+        v[2] = tmp;
+        ImSwap(t.X[1], t.X[2]);
+        ImSwap(t.Y[1], t.Y[2]);
+    }
+
+    // A pixel is covered when its centre (x * 16 + 8) is inside, so the first pixel is ceil((min - 8) / 16)
+    const int min_x = ImMin(t.X[0], ImMin(t.X[1], t.X[2])), max_x = ImMax(t.X[0], ImMax(t.X[1], t.X[2]));
+    const int min_y = ImMin(t.Y[0], ImMin(t.Y[1], t.Y[2])), max_y = ImMax(t.Y[0], ImMax(t.Y[1], t.Y[2]));
+    t.MinX = ImMax((min_x + 7) >> 4, clip[0]);
+    t.MinY = ImMax((min_y + 7) >> 4, clip[1]);
+    t.MaxX = ImMin(((max_x - 8) >> 4) + 1, clip[2]);
+    t.MaxY = ImMin(((max_y - 8) >> 4) + 1, clip[3]);
+    if (t.MinX >= t.MaxX || t.MinY >= t.MaxY)
+        return;
+
+    // The same edge walked the other way by a neighbour gets the opposite answer, so shared edges are drawn once
+    for (int i = 0; i < 3; i++)
+    {
+        const int dx = t.X[(i + 1) % 3] - t.X[i], dy = t.Y[(i + 1) % 3] - t.Y[i];
+        t.TopLeft[i] = dy < 0 || (dy == 0 && dx > 0);
+    }
+    t.Rect = false;
+    ImDrawRasterSetupShading(t, v, tex);
+    tris.push_back(t);
+}
+
+// PrimRect / PrimRectUV quads (a, b, c, a, c, d with b and d on the other corners) are most of a UI, glyphs included.
+// Drawn as one rectangle they need no edge walk and their rows are not split in two at the diagonal.
+static bool ImDrawRasterAddRect(ImVector<ImDrawRasterTri>& tris, const ImDrawVert* a, const ImDrawVert* b, const ImDrawVert* c, const ImDrawVert* d, const ImVec2& scale, const int clip[4], const ImDrawRasterTexture* tex)
+{
+    if (a->pos.y != b->pos.y || b->pos.x != c->pos.x || c->pos.y != d->pos.y || d->pos.x != a->pos.x)
+        return false;
+    if (a->col != b->col || a->col != c->col || a->col != d->col || a->uv.x != d->uv.x || a->uv.y != b->uv.y || b->uv.x != c->uv.x || c->uv.y != d->uv.y)
+        return false;
+    const ImDrawVert* v[3] = { a, b, c };
+    ImDrawRasterTri t;
+    for (int i = 0; i < 3; i++)
+    {
+        t.X[i] = (int)floorf(v[i]->pos.x * scale.x * 16.0f + 0.5f);
+        t.Y[i] = (int)floorf(v[i]->pos.y * scale.y * 16.0f + 0.5f);
+    }
+    // Left / top edges own their pixels, so the rectangle covers the centres in [min, max)
+    t.MinX = ImMax((ImMin(t.X[0], t.X[1]) + 7) >> 4, clip[0]);
+    t.MinY = ImMax((ImMin(t.Y[1], t.Y[2]) + 7) >> 4, clip[1]);
+    t.MaxX = ImMin((ImMax(t.X[0], t.X[1]) + 7) >> 4, clip[2]);
+    t.MaxY = ImMin((ImMax(t.Y[1], t.Y[2]) + 7) >> 4, clip[3]);
+    if (t.MinX >= t.MaxX || t.MinY >= t.MaxY)
+        return true;
+    t.Rect = true;
+    ImDrawRasterSetupShading(t, v, tex);
+    tris.push_back(t);
+    return true;
+}
+
+static void ImDrawRasterShadeSpan(const ImDrawRasterTri& t, ImU32* row, int y, int x_begin, int x_end)
+{
+    const float py = y + 0.5f;
+    float base[6];
+    for (int c = 0; c < 6; c++)
+        base[c] = t.Plane[c][0] + t.Plane[c][2] * py;
+#ifdef IMDRAWRASTER_SSE2
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), max = _mm_set1_ps(255.0f), inv255 = _mm_set1_ps(1.0f / 255.0f);
+    const __m128 lane_offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+    const __m128i lane_index = _mm_set_epi32(3, 2, 1, 0), byte_mask = _mm_set1_epi32(0xFF);
+    const __m128i first = _mm_set1_epi32(x_begin - 1), last = _mm_set1_epi32(x_end);
+    const __m128 tex_w = _mm_set1_ps(t.Tex ? (float)t.Tex->Width : 0.0f), tex_h = _mm_set1_ps(t.Tex ? (float)t.Tex->Height : 0.0f);
+    const __m128 tex_max_x = _mm_sub_ps(tex_w, one), tex_max_y = _mm_sub_ps(tex_h, one);
+    const __m128 distance_edge = _mm_set1_ps(ImDrawRasterDistanceEdge), distance_scale = _mm_set1_ps(t.DistanceScale), half = _mm_set1_ps(0.5f);
+    __m128 src[4];
+    for (int x = x_begin & ~3; x < x_end; x += 4)
+    {
+        const __m128i xi = _mm_add_epi32(_mm_set1_epi32(x), lane_index);
+        const __m128i mask = _mm_and_si128(_mm_cmpgt_epi32(xi, first), _mm_cmplt_epi32(xi, last));
+        const __m128 px = _mm_add_ps(_mm_set1_ps((float)x), lane_offsets);
+        for (int c = 0; c < 4; c++)
+            src[c] = _mm_add_ps(_mm_set1_ps(base[c]), _mm_mul_ps(_mm_set1_ps(t.Plane[c][1]), px));
+        if (t.Tex)
+        {
+            // nearest texel, clamped and indexed in float (exact below 2^24 texels) as SSE2 has no 32-bit multiply
+            const __m128 u = _mm_add_ps(_mm_set1_ps(base[4]), _mm_mul_ps(_mm_set1_ps(t.Plane[4][1]), px));
+            const __m128 v = _mm_add_ps(_mm_set1_ps(base[5]), _mm_mul_ps(_mm_set1_ps(t.Plane[5][1]), px));
+            const __m128 tx = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(u, tex_w), zero), tex_max_x)));
+            const __m128 ty = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(v, tex_h), zero), tex_max_y)));
+            int index[4];
+            _mm_storeu_si128((__m128i*)index, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(ty, tex_w), tx)));
+            if (t.Tex->BytesPerPixel == 1)
+            {
+                const unsigned char* pixels = t.Tex->Pixels;
+                const __m128i texel = _mm_set_epi32(pixels[index[3]], pixels[index[2]], pixels[index[1]], pixels[index[0]]);
+                __m128 texel_a = _mm_mul_ps(_mm_cvtepi32_ps(texel), inv255);
+                if (t.DistanceScale > 0.0f)
+                    texel_a = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(texel_a, distance_edge), distance_scale), half), zero), one);
+                src[3] = _mm_mul_ps(src[3], texel_a);
+            }
+            else
+            {
+                const ImU32* pixels = (const ImU32*)t.Tex->Pixels;
+                const __m128i texel = _mm_set_epi32((int)pixels[index[3]], (int)pixels[index[2]], (int)pixels[index[1]], (int)pixels[index[0]]);
+                for (int c = 0; c < 4; c++)
+                {
+                    __m128 texel_c = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texel, c * 8), byte_mask)), inv255);
+                    if (c == 3 && t.DistanceScale > 0.0f)
+                        texel_c = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(texel_c, distance_edge), distance_scale), half), zero), one);
+                    src[c] = _mm_mul_ps(src[c], texel_c);
+                }
+            }
+        }
+        for (int c = 0; c < 4; c++)
+            src[c] = _mm_min_ps(_mm_max_ps(src[c], zero), max);
+        __m128i* p = (__m128i*)(row + x);
+        const __m128i dst = _mm_loadu_si128(p);
+        const __m128 alpha = _mm_mul_ps(src[3], inv255);
+        const __m128 inv_alpha = _mm_sub_ps(one, alpha);
+        const __m128 dr = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dst, IM_COL32_R_SHIFT), byte_mask));
+        const __m128 dg = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dst, IM_COL32_G_SHIFT), byte_mask));
+        const __m128 db = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dst, IM_COL32_B_SHIFT), byte_mask));
+        const __m128 da = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dst, IM_COL32_A_SHIFT), byte_mask));
+        const __m128i r = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(src[0], alpha), _mm_mul_ps(dr, inv_alpha)));
+        const __m128i g = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(src[1], alpha), _mm_mul_ps(dg, inv_alpha)));
+        const __m128i b = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(src[2], alpha), _mm_mul_ps(db, inv_alpha)));
+        const __m128i a = _mm_cvtps_epi32(_mm_add_ps(src[3], _mm_mul_ps(da, inv_alpha)));
+        __m128i out = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, IM_COL32_R_SHIFT), _mm_slli_epi32(g, IM_COL32_G_SHIFT)),
+                                   _mm_or_si128(_mm_slli_epi32(b, IM_COL32_B_SHIFT), _mm_slli_epi32(a, IM_COL32_A_SHIFT)));
+        out = _mm_or_si128(_mm_and_si128(mask, out), _mm_andnot_si128(mask, dst));
+        _mm_storeu_si128(p, out);
+    }
+#else
+    for (int x = x_begin; x < x_end; x++)
+    {
+        const float px = x + 0.5f;
+        float src[4];
+        for (int c = 0; c < 4; c++)
+            src[c] = base[c] + t.Plane[c][1] * px;
+        if (t.Tex)
+        {
+            float texel[4];
+            ImDrawRasterSample(t.Tex, base[4] + t.Plane[4][1] * px, base[5] + t.Plane[5][1] * px, texel);
+            if (t.DistanceScale > 0.0f)
+                texel[3] = ImDrawRasterDistance(texel[3], t.DistanceScale);
+            for (int c = 0; c < 4; c++)
+                src[c] *= texel[c];
+        }
+        for (int c = 0; c < 4; c++)
+            src[c] = ImClamp(src[c], 0.0f, 255.0f);
+        const ImU32 dst = row[x];
+        const float alpha = src[3] * (1.0f / 255.0f), inv_alpha = 1.0f - alpha;
+        const int r = (int)(src[0] * alpha + ((dst >> IM_COL32_R_SHIFT) & 0xFF) * inv_alpha + 0.5f);
+        const int g = (int)(src[1] * alpha + ((dst >> IM_COL32_G_SHIFT) & 0xFF) * inv_alpha + 0.5f);
+        const int b = (int)(src[2] * alpha + ((dst >> IM_COL32_B_SHIFT) & 0xFF) * inv_alpha + 0.5f);
+        const int a = (int)(src[3] + ((dst >> IM_COL32_A_SHIFT) & 0xFF) * inv_alpha + 0.5f);
+        row[x] = IM_COL32(r, g, b, a);
+    }
+#endif
+}
+
+// Constant colour span: dst * (255 - a) + src * a in 16-bit lanes, (rgb of src premultiplied, alpha uses ONE)
+static void ImDrawRasterFillSpan(const ImDrawRasterTri& t, ImU32* row, int x_begin, int x_end)
+{
+    const int alpha = (t.Color >> IM_COL32_A_SHIFT) & 0xFF;
+    if (alpha == 0)
+        return;
+#ifdef IMDRAWRASTER_SSE2
+    const __m128i lane_index = _mm_set_epi32(3, 2, 1, 0);
+    const __m128i first = _mm_set1_epi32(x_begin - 1), last = _mm_set1_epi32(x_end);
+    const __m128i color = _mm_set1_epi32((int)t.Color);
+    // per byte of a pixel: what to add after scaling dst by 255 - alpha, +128 to round the divide by 255 below
+    unsigned short add[4];
+    for (int c = 0; c < 4; c++)
+    {
+        const int shift = c * 8;
+        const int value = (t.Color >> shift) & 0xFF;
+        add[c] = (unsigned short)((shift == IM_COL32_A_SHIFT ? 255 : value) * alpha + 128);
+    }
+    const __m128i add16 = _mm_set_epi16((short)add[3], (short)add[2], (short)add[1], (short)add[0], (short)add[3], (short)add[2], (short)add[1], (short)add[0]);
+    const __m128i inv16 = _mm_set1_epi16((short)(255 - alpha));
+    const __m128i zero = _mm_setzero_si128();
+    for (int x = x_begin & ~3; x < x_end; x += 4)
+    {
+        const __m128i xi = _mm_add_epi32(_mm_set1_epi32(x), lane_index);
+        const __m128i mask = _mm_and_si128(_mm_cmpgt_epi32(xi, first), _mm_cmplt_epi32(xi, last));
+        __m128i* p = (__m128i*)(row + x);
+        const __m128i dst = _mm_loadu_si128(p);
+        __m128i out = color;
+        if (alpha != 255)
+        {
+            __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), inv16), add16);
+            __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), inv16), add16);
+            // v / 255 rounded is (v + 128 + ((v + 128) >> 8)) >> 8 for the 0..65025 range
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+            out = _mm_packus_epi16(lo, hi);
+        }
+        out = _mm_or_si128(_mm_and_si128(mask, out), _mm_andnot_si128(mask, dst));
+        _mm_storeu_si128(p, out);
+    }
+#else
+    for (int x = x_begin; x < x_end; x++)
+    {
+        const ImU32 dst = row[x];
+        ImU32 out = 0;
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            const int src = shift == IM_COL32_A_SHIFT ? 255 : (int)((t.Color >> shift) & 0xFF);
+            const int v = (int)((dst >> shift) & 0xFF) * (255 - alpha) + src * alpha + 128;
+            out |= (ImU32)((v + (v >> 8)) >> 8) << shift;
+        }
+        row[x] = out;
+    }
+#endif
+}
+
+// Shade rows [y_begin, y_end) of the triangle inside [x_min, x_max). A pixel centre (x * 16 + 8, y * 16 + 8) is inside
+// edge i when E = dx * (py - y_i) - dy * (px - x_i) reaches the bias (0 on owned edges, else 1). Solving that for x gives
+// the span bound floor(n / (16 * |dy|)), n grows by 16 * dx per row so the quotient steps with a remainder and only
+// the first row divides.
+static void ImDrawRasterWalk(ImDrawRaster* raster, const ImDrawRasterTri& t, int y_begin, int y_end, int x_min, int x_max)
+{
+    long long q[3], r[3], step_q[3], step_r[3], den[3];
+    for (int i = 0; i < 3; i++)
+    {
+        const int j = (i + 1) % 3;
+        const long long dx = t.X[j] - t.X[i], dy = t.Y[j] - t.Y[i];
+        const long long n = dx * ((long long)y_begin * 16 + 8 - t.Y[i]) - dy * (8 - t.X[i]) - (t.TopLeft[i] ? 0 : 1);
+        if (dy == 0)
+        {
+            // horizontal edge, the whole row is in or out: n >= 0
+            den[i] = 0;
+            q[i] = n;
+            step_q[i] = 16 * dx;
+            continue;
+        }
+        den[i] = 16 * (dy > 0 ? dy : -dy);
+        q[i] = ImDrawRasterFloorDiv(n, den[i]);
+        r[i] = n - q[i] * den[i];
+        step_q[i] = ImDrawRasterFloorDiv(16 * dx, den[i]);
+        step_r[i] = 16 * dx - step_q[i] * den[i];
+    }
+    for (int y = y_begin; y < y_end; y++)
+    {
+        int x_begin = x_min, x_end = x_max;
+        bool inside = true;
+        for (int i = 0; i < 3; i++)
+        {
+            if (den[i] == 0)
+            {
+                inside = inside && q[i] >= 0;
+                q[i] += step_q[i];
+                continue;
+            }
+            // dy > 0 bounds the span on the right, dy < 0 on the left
+            if (t.Y[(i + 1) % 3] > t.Y[i])
+                x_end = q[i] + 1 < x_end ? (int)(q[i] + 1) : x_end;
+            else
+                x_begin = -q[i] > x_begin ? (int)-q[i] : x_begin;
+            q[i] += step_q[i];
+            r[i] += step_r[i];
+            if (r[i] >= den[i])
+            {
+                q[i]++;
+                r[i] -= den[i];
+            }
+        }
+        if (inside && x_begin < x_end)
+        {
+            if (t.Solid)
+                ImDrawRasterFillSpan(t, raster->Row(y), x_begin, x_end);
+            else
+                ImDrawRasterShadeSpan(t, raster->Row(y), y, x_begin, x_end);
+        }
+    }
+}
+
+static void ImDrawRasterTile(ImDrawRaster* raster, int tile)
+{
+    const int tiles_x = (raster->Width + ImDrawRasterTileSize - 1) / ImDrawRasterTileSize;
+    const int x0 = (tile % tiles_x) * ImDrawRasterTileSize, y0 = (tile / tiles_x) * ImDrawRasterTileSize;
+    const int x1 = ImMin(x0 + ImDrawRasterTileSize, raster->Width), y1 = ImMin(y0 + ImDrawRasterTileSize, raster->Height);
+    for (int y = y0; y < y1; y++)
+    {
+        ImU32* row = raster->Row(y);
+        for (int x = x0; x < x1; x++)
+            row[x] = raster->ClearColor;
+    }
+    for (int n = raster->TileStart[tile]; n < raster->TileStart[tile + 1]; n++)
+    {
+        const ImDrawRasterTri& t = raster->Tris[raster->TileTris[n]];
+        const int x_begin = ImMax(t.MinX, x0), x_end = ImMin(t.MaxX, x1);
+        if (!t.Rect)
+            ImDrawRasterWalk(raster, t, ImMax(t.MinY, y0), ImMin(t.MaxY, y1), x_begin, x_end);
+        else if (t.Solid)
+            for (int y = ImMax(t.MinY, y0); y < ImMin(t.MaxY, y1); y++)
+                ImDrawRasterFillSpan(t, raster->Row(y), x_begin, x_end);
+        else
+            for (int y = ImMax(t.MinY, y0); y < ImMin(t.MaxY, y1); y++)
+                ImDrawRasterShadeSpan(t, raster->Row(y), y, x_begin, x_end);
+    }
+}
+
+void ImDrawRaster::SetTexture(ImTextureID id, const unsigned char* pixels, int width, int height, int bytes_per_pixel, float distance_field_spread)
+{
+    IM_ASSERT(bytes_per_pixel == 1 || bytes_per_pixel == 4);
+    ImDrawRasterTexture tex = { id, pixels, width, height, bytes_per_pixel, distance_field_spread };
+    for (int i = 0; i < Textures.Size; i++)
+        if (Textures[i].Id == id)
+        {
+            Textures[i] = tex;
+            return;
+        }
+    Textures.push_back(tex);
+}
+
+void ImDrawRaster::Resize(int width, int height)
+{
+    Width = width;
+    Height = height;
+    Stride = (width + 3) & ~3;
+    Pixels.resize(Stride * height);
+}
+
+void ImDrawRaster::Render(ImDrawData* draw_data)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    Render(draw_data, io.DisplaySize, io.DisplayFramebufferScale);
+}
+
+void ImDrawRaster::Render(ImDrawData* draw_data, const ImVec2& display_size, const ImVec2& scale)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const int fb_width = (int)(display_size.x * scale.x);
+    const int fb_height = (int)(display_size.y * scale.y);
+    if (fb_width <= 0 || fb_height <= 0)
+        return;
+    if (fb_width != Width || fb_height != Height)
+        Resize(fb_width, fb_height);
+
+    // Set up every triangle in submission order, callbacks run here as there is nothing to draw them into later
+    Tris.resize(0);
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        const ImDrawVert* vtx_buffer = cmd_list->VtxBuffer.Data;
+        const ImDrawIdx* idx_buffer = cmd_list->IdxBuffer.Data;
+        for (const ImDrawCmd* pcmd = cmd_list->CmdBuffer.begin(); pcmd != cmd_list->CmdBuffer.end(); pcmd++)
+        {
+            if (pcmd->UserCallback)
+            {
+                pcmd->UserCallback(cmd_list, pcmd);
+            }
+            else
+            {
+                // Same pixels as the glScissor() of the GL bindings
+                const int clip[4] = { ImMax((int)(pcmd->ClipRect.x * scale.x), 0), ImMax((int)(pcmd->ClipRect.y * scale.y), 0),
+                                      ImMin((int)(pcmd->ClipRect.z * scale.x), Width), ImMin((int)(pcmd->ClipRect.w * scale.y), Height) };
+                const ImDrawRasterTexture* tex = NULL;
+                for (int i = 0; i < Textures.Size; i++)
+                    if (Textures[i].Id == pcmd->TextureId)
+                        tex = &Textures[i];
+                for (unsigned int i = 0; clip[0] < clip[2] && clip[1] < clip[3] && i + 2 < pcmd->ElemCount; i += 3)
+                {
+                    const ImDrawIdx* tri = idx_buffer + i;
+                    if (i + 5 < pcmd->ElemCount && tri[3] == tri[0] && tri[4] == tri[2] &&
+                        ImDrawRasterAddRect(Tris, &vtx_buffer[tri[0]], &vtx_buffer[tri[1]], &vtx_buffer[tri[2]], &vtx_buffer[tri[5]], scale, clip, tex))
+                        i += 3;
+                    else
+                        ImDrawRasterAddTri(Tris, &vtx_buffer[tri[0]], &vtx_buffer[tri[1]], &vtx_buffer[tri[2]], scale, clip, tex);
+                }
+            }
+            idx_buffer += pcmd->ElemCount;
+        }
+    }
+
+    // Bin by tile with a counting sort, triangles keep their order inside a tile
+    const int tiles_x = (Width + ImDrawRasterTileSize - 1) / ImDrawRasterTileSize;
+    const int tiles_y = (Height + ImDrawRasterTileSize - 1) / ImDrawRasterTileSize;
+    const int tile_count = tiles_x * tiles_y;
+    TileStart.resize(tile_count + 1);
+    memset(TileStart.Data, 0, (size_t)TileStart.Size * sizeof(int));
+    for (int i = 0; i < Tris.Size; i++)
+    {
+        const ImDrawRasterTri& t = Tris[i];
+        for (int ty = t.MinY / ImDrawRasterTileSize; ty <= (t.MaxY - 1) / ImDrawRasterTileSize; ty++)
+            for (int tx = t.MinX / ImDrawRasterTileSize; tx <= (t.MaxX - 1) / ImDrawRasterTileSize; tx++)
+                TileStart[ty * tiles_x + tx + 1]++;
+    }
+    for (int i = 0; i < tile_count; i++)
+        TileStart[i + 1] += TileStart[i];
+    TileTris.resize(TileStart[tile_count]);
+    for (int i = 0; i < Tris.Size; i++)
+    {
+        const ImDrawRasterTri& t = Tris[i];
+        for (int ty = t.MinY / ImDrawRasterTileSize; ty <= (t.MaxY - 1) / ImDrawRasterTileSize; ty++)
+            for (int tx = t.MinX / ImDrawRasterTileSize; tx <= (t.MaxX - 1) / ImDrawRasterTileSize; tx++)
+                TileTris[TileStart[ty * tiles_x + tx]++] = i;
+    }
+    for (int i = tile_count; i > 0; i--)
+        TileStart[i] = TileStart[i - 1];
+    TileStart[0] = 0;
+
+    // Tiles share no pixels, workers take the next one until none are left
+    int thread_count = Threads > 0 ? Threads : (int)std::thread::hardware_concurrency();
+    thread_count = ImClamp(thread_count, 1, tile_count);
+    std::atomic<int> next_tile(0);
+    auto worker = [this, &next_tile, tile_count]()
+    {
+        for (int tile = next_tile++; tile < tile_count; tile = next_tile++)
+            ImDrawRasterTile(this, tile);
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < thread_count; i++)
+        workers.push_back(std::thread(worker));
+    worker();
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    RenderTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool ImDrawRaster::SaveImage(const char* filename, bool with_alpha) const
+{
+    FILE* f = fopen(filename, "wb");
+    if (!f)
+        return false;
+    if (with_alpha)
+        fprintf(f, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", Width, Height);
+    else
+        fprintf(f, "P6\n%d %d\n255\n", Width, Height);
+    ImVector<unsigned char> line;
+    line.resize(Width * 4);
+    for (int y = 0; y < Height; y++)
+    {
+        unsigned char* out = line.Data;
+        for (int x = 0; x < Width; x++)
+        {
+            const ImU32 col = Row(y)[x];
+            *out++ = (unsigned char)(col >> IM_COL32_R_SHIFT);
+            *out++ = (unsigned char)(col >> IM_COL32_G_SHIFT);
+            *out++ = (unsigned char)(col >> IM_COL32_B_SHIFT);
+            if (with_alpha)
+                *out++ = (unsigned char)(col >> IM_COL32_A_SHIFT);
+        }
+        fwrite(line.Data, 1, out - line.Data, f);
+    }
+    return fclose(f) == 0;
+}
@@ -0,0 +1,58 @@
+#include "ImDrawSnapshot.h"
+#define IMGUI_DEFINE_PLACEMENT_NEW
+#include "imgui_internal.h"
+#include <string.h>
+
+template<typename T>
+static void ImDrawSnapshotCopy(ImVector<T>& dst, const ImVector<T>& src)
+{
+    dst.resize(src.Size);
+    if (src.Size > 0)
+        memcpy(dst.Data, src.Data, (size_t)src.Size * sizeof(T));
+}
+
+void ImDrawSnapshot::Capture(const ImDrawData* draw_data)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    DisplaySize = io.DisplaySize;
+    FramebufferScale = io.DisplayFramebufferScale;
+    FrameCount = ImGui::GetFrameCount();
+
+    const int count = (draw_data && draw_data->Valid) ? draw_data->CmdListsCount : 0;
+    while (Lists.Size < count)
+    {
+        ImDrawList* list = (ImDrawList*)ImGui::MemAlloc(sizeof(ImDrawList));
+        IM_PLACEMENT_NEW(list) ImDrawList();
+        Lists.push_back(list);
+    }
+    CmdLists.resize(count);
+    for (int n = 0; n < count; n++)
+    {
+        const ImDrawList* src = draw_data->CmdLists[n];
+        ImDrawList* dst = Lists[n];
+        // only what a renderer reads, the building state (_Path, _Channels...) is left empty
+        ImDrawSnapshotCopy(dst->CmdBuffer, src->CmdBuffer);
+        ImDrawSnapshotCopy(dst->IdxBuffer, src->IdxBuffer);
+        ImDrawSnapshotCopy(dst->VtxBuffer, src->VtxBuffer);
+        dst->_OwnerName = src->_OwnerName;
+        CmdLists[n] = dst;
+    }
+
+    DrawData.Valid = count > 0;
+    DrawData.CmdLists = CmdLists.Data;
+    DrawData.CmdListsCount = count;
+    DrawData.TotalVtxCount = count > 0 ? draw_data->TotalVtxCount : 0;
+    DrawData.TotalIdxCount = count > 0 ? draw_data->TotalIdxCount : 0;
+}
+
+void ImDrawSnapshot::Clear()
+{
+    for (int n = 0; n < Lists.Size; n++)
+    {
+        Lists[n]->~ImDrawList();
+        ImGui::MemFree(Lists[n]);
+    }
+    Lists.clear();
+    CmdLists.clear();
+    DrawData = ImDrawData();
+}
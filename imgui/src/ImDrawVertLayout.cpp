@@ -0,0 +1,33 @@
+#include "ImDrawVertLayout.h"
+#include "imgui_internal.h"
+#include "ImDrawSimd.h"
+
+void ImDrawVertLayoutCompact::Write(ImDrawVertCompact* dst, const ImDrawVert* src, int count)
+{
+    const float pos_scale = PosScale();
+    const ImSimd4f scale = ImSimd4fSet(pos_scale, pos_scale, 65535.0f, 65535.0f);
+    const ImSimd4f lo = ImSimd4fSet(-32768.0f, -32768.0f, 0.0f, 0.0f);
+    const ImSimd4f hi = ImSimd4fSet(32767.0f, 32767.0f, 65535.0f, 65535.0f);
+    // Adding and removing 1.5 * 2^23 rounds to nearest even in any of the ImSimd4f backends, the truncating
+    // conversion that follows then has nothing left to truncate
+    const ImSimd4f round = ImSimd4fSet1(12582912.0f);
+    for (int n = 0; n < count; n++)
+    {
+        const ImDrawVert& v = src[n];
+        ImSimd4f f;
+        if (IM_OFFSETOF(ImDrawVert, uv) == IM_OFFSETOF(ImDrawVert, pos) + sizeof(ImVec2))
+            f = ImSimd4fLoad(&v.pos.x);
+        else
+            f = ImSimd4fSet(v.pos.x, v.pos.y, v.uv.x, v.uv.y);
+        f = ImSimd4fMin(ImSimd4fMax(ImSimd4fMul(f, scale), lo), hi);
+        f = ImSimd4fSub(ImSimd4fAdd(f, round), round);
+        int q[4];
+        ImSimd4fStoreInt(q, f);
+        ImDrawVertCompact& out = dst[n];
+        out.pos[0] = (short)q[0];
+        out.pos[1] = (short)q[1];
+        out.uv[0] = (unsigned short)q[2];
+        out.uv[1] = (unsigned short)q[3];
+        out.col = v.col;
+    }
+}
@@ -16,8 +16,12 @@
 #define IMGUI_DEFINE_MATH_OPERATORS
 #define IMGUI_DEFINE_PLACEMENT_NEW
 #include "imgui_internal.h"
+#include "ImDrawSimd.h"
 
 #include <stdio.h>      // vsnprintf, sscanf, printf
+#include <atomic>       // glyphs are rendered on several threads in ImFontAtlasBuildWithStbTruetype()
+#include <thread>
+#include <vector>
 #if !defined(alloca)
 #ifdef _WIN32
 #include <malloc.h>     // alloca
@@ -88,8 +92,9 @@ namespace IMGUI_STB_NAMESPACE
 #endif
 #include "stb_rect_pack.h"
 
-#define STBTT_malloc(x,u)  ((void)(u), ImGui::MemAlloc(x))
-#define STBTT_free(x,u)    ((void)(u), ImGui::MemFree(x))
+// The glyph rendering jobs of ImFontAtlasBuildWithStbTruetype() pass a non-NULL user data: they may run on worker threads so they go straight to the (thread-safe) allocator and leave the metrics alone
+#define STBTT_malloc(x,u)  ((u) ? GImGui->IO.MemAllocFn(x) : ImGui::MemAlloc(x))
+#define STBTT_free(x,u)    ((u) ? GImGui->IO.MemFreeFn(x) : ImGui::MemFree(x))
 #define STBTT_assert(x)    IM_ASSERT(x)
 #ifndef IMGUI_DISABLE_STB_TRUETYPE_IMPLEMENTATION
 #define STBTT_STATIC
@@ -116,6 +121,11 @@ namespace IMGUI_STB_NAMESPACE
 using namespace IMGUI_STB_NAMESPACE;
 #endif
 
+// Default font atlas generated at build time by tools/ImFontAtlasBake.cpp, defines GImFontAtlasPrebakedDefault
+#ifdef IMGUI_PREBAKED_DEFAULT_FONT
+#include "imgui_default_font_atlas.h"
+#endif
+
 //-----------------------------------------------------------------------------
 // ImDrawList
 //-----------------------------------------------------------------------------
@@ -415,6 +425,159 @@ void ImDrawList::PrimQuadUV(const ImVec2& a, const ImVec2& b, const ImVec2& c, c
     _IdxWritePtr += 6;
 }
 
+// Unit normal of each segment i -> i+1 (the last one wraps to point 0), 4 segments at a time. Same math as ImInvLength().
+static void ImDrawListComputeNormals(const ImVec2* points, int points_count, int count, ImVec2* out_normals)
+{
+    int i = 0;
+    const ImSimd4f zero = ImSimd4fSet1(0.0f), one = ImSimd4fSet1(1.0f);
+    for (; i + 4 < points_count && i + 4 <= count; i += 4)
+    {
+        ImSimd4f x1, y1, x2, y2;
+        ImSimd4fLoad2(points + i, &x1, &y1);
+        ImSimd4fLoad2(points + i + 1, &x2, &y2);
+        const ImSimd4f dx = ImSimd4fSub(x2, x1), dy = ImSimd4fSub(y2, y1);
+        const ImSimd4f d = ImSimd4fAdd(ImSimd4fMul(dx, dx), ImSimd4fMul(dy, dy));
+        const ImSimd4f inv_length = ImSimd4fSelectGt(d, zero, ImSimd4fDiv(one, ImSimd4fSqrt(d)), one);
+        ImSimd4fStore2(out_normals + i, ImSimd4fMul(dy, inv_length), ImSimd4fNeg(ImSimd4fMul(dx, inv_length)));
+    }
+    for (; i < count; i++)
+    {
+        const int i2 = (i+1) == points_count ? 0 : i+1;
+        ImVec2 diff = points[i2] - points[i];
+        diff *= ImInvLength(diff, 1.0f);
+        out_normals[i].x = diff.y;
+        out_normals[i].y = -diff.x;
+    }
+}
+
+// Offset of each point to its fringe for a 1 pixel wide stroke: the average of the normals of its two segments, scaled up
+// (at most 10x) so the stroke keeps its width in sharp corners. The first point of an open line uses its segment normal.
+static void ImDrawListComputeFringeOffsets(const ImVec2* normals, int points_count, bool closed, ImVec2* out_offsets)
+{
+    const ImSimd4f half = ImSimd4fSet1(0.5f), one = ImSimd4fSet1(1.0f), min_length = ImSimd4fSet1(0.000001f), max_scale = ImSimd4fSet1(100.0f);
+    int i = 1;
+    for (; i + 4 <= points_count; i += 4)
+    {
+        ImSimd4f x1, y1, x2, y2;
+        ImSimd4fLoad2(normals + i - 1, &x1, &y1);
+        ImSimd4fLoad2(normals + i, &x2, &y2);
+        const ImSimd4f dx = ImSimd4fMul(ImSimd4fAdd(x1, x2), half), dy = ImSimd4fMul(ImSimd4fAdd(y1, y2), half);
+        const ImSimd4f dmr2 = ImSimd4fAdd(ImSimd4fMul(dx, dx), ImSimd4fMul(dy, dy));
+        const ImSimd4f scale = ImSimd4fSelectGt(dmr2, min_length, ImSimd4fMin(ImSimd4fDiv(one, dmr2), max_scale), one);
+        ImSimd4fStore2(out_offsets + i, ImSimd4fMul(dx, scale), ImSimd4fMul(dy, scale));
+    }
+    for (int i1 = i - 1; i1 < points_count; i1++)
+    {
+        // i1 == points_count-1 is the segment back to the first point
+        const int i2 = (i1+1) == points_count ? 0 : i1+1;
+        if (i2 == 0 && !closed)
+        {
+            out_offsets[0] = normals[0];
+            continue;
+        }
+        ImVec2 dm = (normals[i1] + normals[i2]) * 0.5f;
+        float dmr2 = dm.x*dm.x + dm.y*dm.y;
+        if (dmr2 > 0.000001f)
+        {
+            float scale = 1.0f / dmr2;
+            if (scale > 100.0f) scale = 100.0f;
+            dm *= scale;
+        }
+        out_offsets[i2] = dm;
+    }
+}
+
+// Anti-aliased stroke vertices, 4 points at a time. With half_inner_thickness == 0 each point gives itself and its two fringes
+// (col, col_trans, col_trans), else two opaque vertices half_inner_thickness away and two transparent ones aa_size further.
+static void ImDrawListWriteStrokeVerts(ImDrawVert* vtx, const ImVec2* points, const ImVec2* offsets, int points_count, float half_inner_thickness, float aa_size, const ImVec2& uv, ImU32 col, ImU32 col_trans)
+{
+    const bool thick_line = half_inner_thickness > 0.0f;
+    const float outer = half_inner_thickness + aa_size;
+    const ImSimd4f inner4 = ImSimd4fSet1(half_inner_thickness), outer4 = ImSimd4fSet1(outer);
+    ImVec2 pos[4][4];
+    int i = 0;
+    for (; i + 4 <= points_count; i += 4)
+    {
+        ImSimd4f px, py, dx, dy;
+        ImSimd4fLoad2(points + i, &px, &py);
+        ImSimd4fLoad2(offsets + i, &dx, &dy);
+        const ImSimd4f out_x = ImSimd4fMul(dx, outer4), out_y = ImSimd4fMul(dy, outer4);
+        ImSimd4fStore2(pos[0], ImSimd4fAdd(px, out_x), ImSimd4fAdd(py, out_y));
+        ImSimd4fStore2(pos[3], ImSimd4fSub(px, out_x), ImSimd4fSub(py, out_y));
+        if (thick_line)
+        {
+            const ImSimd4f in_x = ImSimd4fMul(dx, inner4), in_y = ImSimd4fMul(dy, inner4);
+            ImSimd4fStore2(pos[1], ImSimd4fAdd(px, in_x), ImSimd4fAdd(py, in_y));
+            ImSimd4fStore2(pos[2], ImSimd4fSub(px, in_x), ImSimd4fSub(py, in_y));
+            for (int n = 0; n < 4; n++, vtx += 4)
+            {
+                vtx[0].pos = pos[0][n]; vtx[0].uv = uv; vtx[0].col = col_trans;
+                vtx[1].pos = pos[1][n]; vtx[1].uv = uv; vtx[1].col = col;
+                vtx[2].pos = pos[2][n]; vtx[2].uv = uv; vtx[2].col = col;
+                vtx[3].pos = pos[3][n]; vtx[3].uv = uv; vtx[3].col = col_trans;
+            }
+        }
+        else
+        {
+            for (int n = 0; n < 4; n++, vtx += 3)
+            {
+                vtx[0].pos = points[i+n]; vtx[0].uv = uv; vtx[0].col = col;
+                vtx[1].pos = pos[0][n];   vtx[1].uv = uv; vtx[1].col = col_trans;
+                vtx[2].pos = pos[3][n];   vtx[2].uv = uv; vtx[2].col = col_trans;
+            }
+        }
+    }
+    for (; i < points_count; i++)
+    {
+        const ImVec2 dm_out = offsets[i] * outer;
+        if (thick_line)
+        {
+            const ImVec2 dm_in = offsets[i] * half_inner_thickness;
+            vtx[0].pos = points[i] + dm_out; vtx[0].uv = uv; vtx[0].col = col_trans;
+            vtx[1].pos = points[i] + dm_in;  vtx[1].uv = uv; vtx[1].col = col;
+            vtx[2].pos = points[i] - dm_in;  vtx[2].uv = uv; vtx[2].col = col;
+            vtx[3].pos = points[i] - dm_out; vtx[3].uv = uv; vtx[3].col = col_trans;
+            vtx += 4;
+        }
+        else
+        {
+            vtx[0].pos = points[i];          vtx[0].uv = uv; vtx[0].col = col;
+            vtx[1].pos = points[i] + dm_out; vtx[1].uv = uv; vtx[1].col = col_trans;
+            vtx[2].pos = points[i] - dm_out; vtx[2].uv = uv; vtx[2].col = col_trans;
+            vtx += 3;
+        }
+    }
+}
+
+// Anti-aliased fill vertices, 4 points at a time: each point gives an opaque vertex half_aa_size inside and a transparent one outside.
+static void ImDrawListWriteFillVerts(ImDrawVert* vtx, const ImVec2* points, const ImVec2* offsets, int points_count, float half_aa_size, const ImVec2& uv, ImU32 col, ImU32 col_trans)
+{
+    const ImSimd4f half4 = ImSimd4fSet1(half_aa_size);
+    ImVec2 pos[2][4];
+    int i = 0;
+    for (; i + 4 <= points_count; i += 4)
+    {
+        ImSimd4f px, py, dx, dy;
+        ImSimd4fLoad2(points + i, &px, &py);
+        ImSimd4fLoad2(offsets + i, &dx, &dy);
+        dx = ImSimd4fMul(dx, half4);
+        dy = ImSimd4fMul(dy, half4);
+        ImSimd4fStore2(pos[0], ImSimd4fSub(px, dx), ImSimd4fSub(py, dy));
+        ImSimd4fStore2(pos[1], ImSimd4fAdd(px, dx), ImSimd4fAdd(py, dy));
+        for (int n = 0; n < 4; n++, vtx += 2)
+        {
+            vtx[0].pos = pos[0][n]; vtx[0].uv = uv; vtx[0].col = col;          // Inner
+            vtx[1].pos = pos[1][n]; vtx[1].uv = uv; vtx[1].col = col_trans;    // Outer
+        }
+    }
+    for (; i < points_count; i++, vtx += 2)
+    {
+        const ImVec2 dm = offsets[i] * half_aa_size;
+        vtx[0].pos = points[i] - dm; vtx[0].uv = uv; vtx[0].col = col;
+        vtx[1].pos = points[i] + dm; vtx[1].uv = uv; vtx[1].col = col_trans;
+    }
+}
+
 // TODO: Thickness anti-aliased lines cap are missing their AA fringe.
 void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32 col, bool closed, float thickness, bool anti_aliased)
 {
@@ -440,109 +603,30 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
         const int vtx_count = thick_line ? points_count*4 : points_count*3;
         PrimReserve(idx_count, vtx_count);
 
-        // Temporary buffer
-        ImVec2* temp_normals = (ImVec2*)alloca(points_count * (thick_line ? 5 : 3) * sizeof(ImVec2));
-        ImVec2* temp_points = temp_normals + points_count;
-
-        for (int i1 = 0; i1 < count; i1++)
-        {
-            const int i2 = (i1+1) == points_count ? 0 : i1+1;
-            ImVec2 diff = points[i2] - points[i1];
-            diff *= ImInvLength(diff, 1.0f);
-            temp_normals[i1].x = diff.y;
-            temp_normals[i1].y = -diff.x;
-        }
+        // Temporary buffer: segment normals, then the offset of each point to its fringe (averaged normals at 1 pixel)
+        ImVec2* temp_normals = (ImVec2*)alloca(points_count * 2 * sizeof(ImVec2));
+        ImVec2* temp_offsets = temp_normals + points_count;
+        ImDrawListComputeNormals(points, points_count, count, temp_normals);
         if (!closed)
             temp_normals[points_count-1] = temp_normals[points_count-2];
+        ImDrawListComputeFringeOffsets(temp_normals, points_count, closed, temp_offsets);
 
-        if (!thick_line)
+        // Add indexes
+        unsigned int idx1 = _VtxCurrentIdx;
+        const unsigned int vtx_stride = thick_line ? 4 : 3;
+        for (int i1 = 0; i1 < count; i1++)
         {
-            if (!closed)
-            {
-                temp_points[0] = points[0] + temp_normals[0] * AA_SIZE;
-                temp_points[1] = points[0] - temp_normals[0] * AA_SIZE;
-                temp_points[(points_count-1)*2+0] = points[points_count-1] + temp_normals[points_count-1] * AA_SIZE;
-                temp_points[(points_count-1)*2+1] = points[points_count-1] - temp_normals[points_count-1] * AA_SIZE;
-            }
-
-            // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
-            unsigned int idx1 = _VtxCurrentIdx;
-            for (int i1 = 0; i1 < count; i1++)
+            unsigned int idx2 = (i1+1) == points_count ? _VtxCurrentIdx : idx1+vtx_stride;
+            if (!thick_line)
             {
-                const int i2 = (i1+1) == points_count ? 0 : i1+1;
-                unsigned int idx2 = (i1+1) == points_count ? _VtxCurrentIdx : idx1+3;
-
-                // Average normals
-                ImVec2 dm = (temp_normals[i1] + temp_normals[i2]) * 0.5f;
-                float dmr2 = dm.x*dm.x + dm.y*dm.y;
-                if (dmr2 > 0.000001f)
-                {
-                    float scale = 1.0f / dmr2;
-                    if (scale > 100.0f) scale = 100.0f;
-                    dm *= scale;
-                }
-                dm *= AA_SIZE;
-                temp_points[i2*2+0] = points[i2] + dm;
-                temp_points[i2*2+1] = points[i2] - dm;
-
-                // Add indexes
                 _IdxWritePtr[0] = (ImDrawIdx)(idx2+0); _IdxWritePtr[1] = (ImDrawIdx)(idx1+0); _IdxWritePtr[2] = (ImDrawIdx)(idx1+2);
                 _IdxWritePtr[3] = (ImDrawIdx)(idx1+2); _IdxWritePtr[4] = (ImDrawIdx)(idx2+2); _IdxWritePtr[5] = (ImDrawIdx)(idx2+0);
                 _IdxWritePtr[6] = (ImDrawIdx)(idx2+1); _IdxWritePtr[7] = (ImDrawIdx)(idx1+1); _IdxWritePtr[8] = (ImDrawIdx)(idx1+0);
                 _IdxWritePtr[9] = (ImDrawIdx)(idx1+0); _IdxWritePtr[10]= (ImDrawIdx)(idx2+0); _IdxWritePtr[11]= (ImDrawIdx)(idx2+1);
                 _IdxWritePtr += 12;
-
-                idx1 = idx2;
-            }
-
-            // Add vertexes
-            for (int i = 0; i < points_count; i++)
-            {
-                _VtxWritePtr[0].pos = points[i];          _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col;
-                _VtxWritePtr[1].pos = temp_points[i*2+0]; _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col_trans;
-                _VtxWritePtr[2].pos = temp_points[i*2+1]; _VtxWritePtr[2].uv = uv; _VtxWritePtr[2].col = col_trans;
-                _VtxWritePtr += 3;
-            }
-        }
-        else
-        {
-            const float half_inner_thickness = (thickness - AA_SIZE) * 0.5f;
-            if (!closed)
-            {
-                temp_points[0] = points[0] + temp_normals[0] * (half_inner_thickness + AA_SIZE);
-                temp_points[1] = points[0] + temp_normals[0] * (half_inner_thickness);
-                temp_points[2] = points[0] - temp_normals[0] * (half_inner_thickness);
-                temp_points[3] = points[0] - temp_normals[0] * (half_inner_thickness + AA_SIZE);
-                temp_points[(points_count-1)*4+0] = points[points_count-1] + temp_normals[points_count-1] * (half_inner_thickness + AA_SIZE);
-                temp_points[(points_count-1)*4+1] = points[points_count-1] + temp_normals[points_count-1] * (half_inner_thickness);
-                temp_points[(points_count-1)*4+2] = points[points_count-1] - temp_normals[points_count-1] * (half_inner_thickness);
-                temp_points[(points_count-1)*4+3] = points[points_count-1] - temp_normals[points_count-1] * (half_inner_thickness + AA_SIZE);
             }
-
-            // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
-            unsigned int idx1 = _VtxCurrentIdx;
-            for (int i1 = 0; i1 < count; i1++)
+            else
             {
-                const int i2 = (i1+1) == points_count ? 0 : i1+1;
-                unsigned int idx2 = (i1+1) == points_count ? _VtxCurrentIdx : idx1+4;
-
-                // Average normals
-                ImVec2 dm = (temp_normals[i1] + temp_normals[i2]) * 0.5f;
-                float dmr2 = dm.x*dm.x + dm.y*dm.y;
-                if (dmr2 > 0.000001f)
-                {
-                    float scale = 1.0f / dmr2;
-                    if (scale > 100.0f) scale = 100.0f;
-                    dm *= scale;
-                }
-                ImVec2 dm_out = dm * (half_inner_thickness + AA_SIZE);
-                ImVec2 dm_in = dm * half_inner_thickness;
-                temp_points[i2*4+0] = points[i2] + dm_out;
-                temp_points[i2*4+1] = points[i2] + dm_in;
-                temp_points[i2*4+2] = points[i2] - dm_in;
-                temp_points[i2*4+3] = points[i2] - dm_out;
-
-                // Add indexes
                 _IdxWritePtr[0]  = (ImDrawIdx)(idx2+1); _IdxWritePtr[1]  = (ImDrawIdx)(idx1+1); _IdxWritePtr[2]  = (ImDrawIdx)(idx1+2);
                 _IdxWritePtr[3]  = (ImDrawIdx)(idx1+2); _IdxWritePtr[4]  = (ImDrawIdx)(idx2+2); _IdxWritePtr[5]  = (ImDrawIdx)(idx2+1);
                 _IdxWritePtr[6]  = (ImDrawIdx)(idx2+1); _IdxWritePtr[7]  = (ImDrawIdx)(idx1+1); _IdxWritePtr[8]  = (ImDrawIdx)(idx1+0);
@@ -550,20 +634,16 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
                 _IdxWritePtr[12] = (ImDrawIdx)(idx2+2); _IdxWritePtr[13] = (ImDrawIdx)(idx1+2); _IdxWritePtr[14] = (ImDrawIdx)(idx1+3);
                 _IdxWritePtr[15] = (ImDrawIdx)(idx1+3); _IdxWritePtr[16] = (ImDrawIdx)(idx2+3); _IdxWritePtr[17] = (ImDrawIdx)(idx2+2);
                 _IdxWritePtr += 18;
-
-                idx1 = idx2;
-            }
-
-            // Add vertexes
-            for (int i = 0; i < points_count; i++)
-            {
-                _VtxWritePtr[0].pos = temp_points[i*4+0]; _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col_trans;
-                _VtxWritePtr[1].pos = temp_points[i*4+1]; _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col;
-                _VtxWritePtr[2].pos = temp_points[i*4+2]; _VtxWritePtr[2].uv = uv; _VtxWritePtr[2].col = col;
-                _VtxWritePtr[3].pos = temp_points[i*4+3]; _VtxWritePtr[3].uv = uv; _VtxWritePtr[3].col = col_trans;
-                _VtxWritePtr += 4;
             }
+            idx1 = idx2;
         }
+
+        // Add vertexes, thin lines get the point and its two fringes, thick lines an inner and an outer edge on each side
+        if (!thick_line)
+            ImDrawListWriteStrokeVerts(_VtxWritePtr, points, temp_offsets, points_count, 0.0f, AA_SIZE, uv, col, col_trans);
+        else
+            ImDrawListWriteStrokeVerts(_VtxWritePtr, points, temp_offsets, points_count, (thickness - AA_SIZE) * 0.5f, AA_SIZE, uv, col, col_trans);
+        _VtxWritePtr += vtx_count;
         _VtxCurrentIdx += (ImDrawIdx)vtx_count;
     }
     else
@@ -621,43 +701,23 @@ void ImDrawList::AddConvexPolyFilled(const ImVec2* points, const int points_coun
             _IdxWritePtr += 3;
         }
 
-        // Compute normals
-        ImVec2* temp_normals = (ImVec2*)alloca(points_count * sizeof(ImVec2));
-        for (int i0 = points_count-1, i1 = 0; i1 < points_count; i0 = i1++)
-        {
-            const ImVec2& p0 = points[i0];
-            const ImVec2& p1 = points[i1];
-            ImVec2 diff = p1 - p0;
-            diff *= ImInvLength(diff, 1.0f);
-            temp_normals[i0].x = diff.y;
-            temp_normals[i0].y = -diff.x;
-        }
+        // Temporary buffer: edge normals, then the offset of each point to its fringe (averaged normals at 1 pixel)
+        ImVec2* temp_normals = (ImVec2*)alloca(points_count * 2 * sizeof(ImVec2));
+        ImVec2* temp_offsets = temp_normals + points_count;
+        ImDrawListComputeNormals(points, points_count, points_count, temp_normals);
+        ImDrawListComputeFringeOffsets(temp_normals, points_count, true, temp_offsets);
 
+        // Add indexes for fringes
         for (int i0 = points_count-1, i1 = 0; i1 < points_count; i0 = i1++)
         {
-            // Average normals
-            const ImVec2& n0 = temp_normals[i0];
-            const ImVec2& n1 = temp_normals[i1];
-            ImVec2 dm = (n0 + n1) * 0.5f;
-            float dmr2 = dm.x*dm.x + dm.y*dm.y;
-            if (dmr2 > 0.000001f)
-            {
-                float scale = 1.0f / dmr2;
-                if (scale > 100.0f) scale = 100.0f;
-                dm *= scale;
-            }
-            dm *= AA_SIZE * 0.5f;
-
-            // Add vertices
-            _VtxWritePtr[0].pos = (points[i1] - dm); _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col;        // Inner
-            _VtxWritePtr[1].pos = (points[i1] + dm); _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col_trans;  // Outer
-            _VtxWritePtr += 2;
-
-            // Add indexes for fringes
             _IdxWritePtr[0] = (ImDrawIdx)(vtx_inner_idx+(i1<<1)); _IdxWritePtr[1] = (ImDrawIdx)(vtx_inner_idx+(i0<<1)); _IdxWritePtr[2] = (ImDrawIdx)(vtx_outer_idx+(i0<<1));
             _IdxWritePtr[3] = (ImDrawIdx)(vtx_outer_idx+(i0<<1)); _IdxWritePtr[4] = (ImDrawIdx)(vtx_outer_idx+(i1<<1)); _IdxWritePtr[5] = (ImDrawIdx)(vtx_inner_idx+(i1<<1));
             _IdxWritePtr += 6;
         }
+
+        // Add vertexes, an inner one and an outer one per point
+        ImDrawListWriteFillVerts(_VtxWritePtr, points, temp_offsets, points_count, AA_SIZE * 0.5f, uv, col, col_trans);
+        _VtxWritePtr += vtx_count;
         _VtxCurrentIdx += (ImDrawIdx)vtx_count;
     }
     else
@@ -680,32 +740,105 @@ void ImDrawList::AddConvexPolyFilled(const ImVec2* points, const int points_coun
     }
 }
 
-void ImDrawList::PathArcToFast(const ImVec2& centre, float radius, int a_min_of_12, int a_max_of_12)
+void ImDrawListCircleCache::Clear()
+{
+    SegmentMaxError = -1.0f;
+    memset(SegmentCounts, 0, sizeof(SegmentCounts));
+    for (int n = 0; n < IM_ARRAYSIZE(UnitCircleOffsets); n++)
+        UnitCircleOffsets[n] = -1;
+    UnitCircles.clear();
+}
+
+// Smallest multiple of 4 segment count for which the polygon stays within max_error of the circle: the gap at the middle
+// of a segment is radius * (1 - cos(PI / num_segments)).
+static int ImDrawListCircleSegmentCountCalc(float radius, float max_error)
+{
+    if (radius <= 0.0f)
+        return IM_DRAWLIST_CIRCLE_SEGMENT_MIN;
+    const float error_ratio = ImMin(max_error, radius) / radius;
+    const int num_segments = (int)ceilf(IM_PI / acosf(1.0f - error_ratio));
+    return ImClamp((num_segments + 3) & ~3, IM_DRAWLIST_CIRCLE_SEGMENT_MIN, IM_DRAWLIST_CIRCLE_SEGMENT_MAX);
+}
+
+int ImDrawListCircleCache::GetSegmentCount(float radius, float max_error)
+{
+    if (max_error != SegmentMaxError)
+    {
+        for (int n = 0; n < IM_ARRAYSIZE(SegmentCounts); n++)
+            SegmentCounts[n] = (unsigned short)ImDrawListCircleSegmentCountCalc((float)n, max_error);
+        SegmentMaxError = max_error;
+    }
+    // Rounding the radius up errs on the side of more segments
+    if (radius < (float)IM_ARRAYSIZE(SegmentCounts) - 1.0f)
+        return radius > 0.0f ? SegmentCounts[(int)(radius + 0.999999f)] : IM_DRAWLIST_CIRCLE_SEGMENT_MIN;
+    return ImDrawListCircleSegmentCountCalc(radius, max_error);
+}
+
+const ImVec2* ImDrawListCircleCache::GetUnitCircle(int num_segments)
 {
-    static ImVec2 circle_vtx[12];
-    static bool circle_vtx_builds = false;
-    const int circle_vtx_count = IM_ARRAYSIZE(circle_vtx);
-    if (!circle_vtx_builds)
+    IM_ASSERT(num_segments > 0 && num_segments <= IM_DRAWLIST_CIRCLE_SEGMENT_MAX);
+    if (UnitCircleOffsets[num_segments] < 0)
     {
-        for (int i = 0; i < circle_vtx_count; i++)
+        const int offset = UnitCircles.Size;
+        UnitCircles.resize(offset + num_segments);
+        for (int i = 0; i < num_segments; i++)
         {
-            const float a = ((float)i / (float)circle_vtx_count) * 2*IM_PI;
-            circle_vtx[i].x = cosf(a);
-            circle_vtx[i].y = sinf(a);
+            const float a = ((float)i / (float)num_segments) * 2*IM_PI;
+            UnitCircles[offset + i] = ImVec2(cosf(a), sinf(a));
         }
-        circle_vtx_builds = true;
+        UnitCircleOffsets[num_segments] = offset;
     }
+    return UnitCircles.Data + UnitCircleOffsets[num_segments];
+}
 
+static int ImDrawListCircleSegmentCount(float radius)
+{
+    ImGuiContext& g = *GImGui;
+    return g.CircleCache.GetSegmentCount(radius, g.Style.CircleSegmentMaxError);
+}
+
+// Full circle of num_segments points scaled from the cached unit circle
+static void PathCircle(ImVector<ImVec2>* path, const ImVec2& centre, float radius, int num_segments)
+{
+    if (radius == 0.0f)
+    {
+        path->push_back(centre);
+        return;
+    }
+    const ImVec2* circle_vtx = GImGui->CircleCache.GetUnitCircle(num_segments);
+    const int path_size = path->Size;
+    path->resize(path_size + num_segments);
+    ImVec2* out = path->Data + path_size;
+    for (int i = 0; i < num_segments; i++)
+        out[i] = ImVec2(centre.x + circle_vtx[i].x * radius, centre.y + circle_vtx[i].y * radius);
+}
+
+void ImDrawList::PathArcToFast(const ImVec2& centre, float radius, int a_min_of_12, int a_max_of_12)
+{
     if (radius == 0.0f || a_min_of_12 > a_max_of_12)
     {
         _Path.push_back(centre);
         return;
     }
-    _Path.reserve(_Path.Size + (a_max_of_12 - a_min_of_12 + 1));
-    for (int a = a_min_of_12; a <= a_max_of_12; a++)
+
+    // Quarter turns fall on a point of any circle with a multiple of 4 segments, so quarter arcs (rounded corners) get
+    // as many segments as their radius needs. Other arcs keep the 12 steps circle.
+    int circle_vtx_count = 12;
+    int a_min = a_min_of_12, a_max = a_max_of_12;
+    if ((a_min_of_12 % 3) == 0 && (a_max_of_12 % 3) == 0)
+    {
+        circle_vtx_count = ImDrawListCircleSegmentCount(radius);
+        a_min = (a_min_of_12 / 3) * (circle_vtx_count / 4);
+        a_max = (a_max_of_12 / 3) * (circle_vtx_count / 4);
+    }
+    const ImVec2* circle_vtx = GImGui->CircleCache.GetUnitCircle(circle_vtx_count);
+    const int path_size = _Path.Size;
+    _Path.resize(path_size + (a_max - a_min + 1));
+    ImVec2* out = _Path.Data + path_size;
+    for (int a = a_min; a <= a_max; a++)
     {
         const ImVec2& c = circle_vtx[a % circle_vtx_count];
-        _Path.push_back(ImVec2(centre.x + c.x * radius, centre.y + c.y * radius));
+        *out++ = ImVec2(centre.x + c.x * radius, centre.y + c.y * radius);
     }
 }
 
@@ -716,6 +849,9 @@ void ImDrawList::PathArcTo(const ImVec2& centre, float radius, float a_min, floa
         _Path.push_back(centre);
         return;
     }
+    // Arbitrary angles don't fall on the cached circles, only the segment count comes from the cache here
+    if (num_segments <= 0)
+        num_segments = ImMax(1, (int)ceilf(ImDrawListCircleSegmentCount(radius) * fabsf(a_max - a_min) / (2*IM_PI)));
     _Path.reserve(_Path.Size + (num_segments + 1));
     for (int i = 0; i <= num_segments; i++)
     {
@@ -724,54 +860,152 @@ void ImDrawList::PathArcTo(const ImVec2& centre, float radius, float a_min, floa
     }
 }
 
-static void PathBezierToCasteljau(ImVector<ImVec2>* path, float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, float tess_tol, int level)
+// Curves are flattened in uniform steps by forward differencing, 3 additions per coordinate and point.
+// With p1 at the origin the curve is B(t) = A*t^3 + B*t^2 + C*t, the gap between a chord of parameter length h and the curve
+// is at most h^2/8 * max|B''|, and B'' is linear so its largest length is at one of the ends: 6 * |p1 - 2*p2 + p3| or 6 * |p2 - 2*p3 + p4|.
+// The allowed gap is half of tess_tol in pixels, which gives about as many points as the former recursive subdivision did.
+static int PathBezierSegmentCount(const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, float tess_tol)
 {
-    float dx = x4 - x1;
-    float dy = y4 - y1;
-    float d2 = ((x2 - x4) * dy - (y2 - y4) * dx);
-    float d3 = ((x3 - x4) * dy - (y3 - y4) * dx);
-    d2 = (d2 >= 0) ? d2 : -d2;
-    d3 = (d3 >= 0) ? d3 : -d3;
-    if ((d2+d3) * (d2+d3) < tess_tol * (dx*dx + dy*dy))
+    const float d0x = p3.x - 2.0f * p2.x, d0y = p3.y - 2.0f * p2.y;
+    const float d1x = p4.x - 2.0f * p3.x + p2.x, d1y = p4.y - 2.0f * p3.y + p2.y;
+    const float dd_max_sqr = 36.0f * ImMax(d0x * d0x + d0y * d0y, d1x * d1x + d1y * d1y);
+    const float num_segments = ceilf(sqrtf(sqrtf(dd_max_sqr) / (4.0f * tess_tol)));
+    return (num_segments < (float)IM_DRAWLIST_CURVE_SEGMENT_MAX) ? ImMax((int)num_segments, 1) : IM_DRAWLIST_CURVE_SEGMENT_MAX;
+}
+
+// Writes the num_segments points after p1 (which is at the origin), the last one is p4.
+static void PathBezierFlatten(ImVec2* out, const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, int num_segments)
+{
+    const float ax = p4.x - 3.0f * p3.x + 3.0f * p2.x, ay = p4.y - 3.0f * p3.y + 3.0f * p2.y;
+    const float bx = 3.0f * (p3.x - 2.0f * p2.x), by = 3.0f * (p3.y - 2.0f * p2.y);
+    const float cx = 3.0f * p2.x, cy = 3.0f * p2.y;
+    const float h = 1.0f / (float)num_segments, h2 = h * h, h3 = h2 * h;
+    float x = 0.0f, y = 0.0f;
+    float dx = ax * h3 + bx * h2 + cx * h, dy = ay * h3 + by * h2 + cy * h;
+    float ddx = 6.0f * ax * h3 + 2.0f * bx * h2, ddy = 6.0f * ay * h3 + 2.0f * by * h2;
+    const float dddx = 6.0f * ax * h3, dddy = 6.0f * ay * h3;
+    for (int i = 0; i < num_segments - 1; i++)
     {
-        path->push_back(ImVec2(x4, y4));
+        x += dx; dx += ddx; ddx += dddx;
+        y += dy; dy += ddy; ddy += dddy;
+        out[i] = ImVec2(x, y);
     }
-    else if (level < 10)
+    out[num_segments - 1] = p4;
+}
+
+void ImDrawListCurveCache::Clear()
+{
+    Buckets.clear();
+    Entries.clear();
+    Points.clear();
+    Frame = 0;
+    UsedEntries = 0;
+}
+
+void ImDrawListCurveCache::NewFrame(int frame_count)
+{
+    // Compact when some curves weren't drawn during the last frame
+    if (UsedEntries < Entries.Size)
     {
-        float x12 = (x1+x2)*0.5f,       y12 = (y1+y2)*0.5f;
-        float x23 = (x2+x3)*0.5f,       y23 = (y2+y3)*0.5f;
-        float x34 = (x3+x4)*0.5f,       y34 = (y3+y4)*0.5f;
-        float x123 = (x12+x23)*0.5f,    y123 = (y12+y23)*0.5f;
-        float x234 = (x23+x34)*0.5f,    y234 = (y23+y34)*0.5f;
-        float x1234 = (x123+x234)*0.5f, y1234 = (y123+y234)*0.5f;
+        ImVector<Entry> entries;
+        ImVector<ImVec2> points;
+        entries.reserve(UsedEntries);
+        for (int n = 0; n < Entries.Size; n++)
+        {
+            const Entry& entry = Entries[n];
+            if (entry.LastUsedFrame != Frame)
+                continue;
+            entries.push_back(entry);
+            entries.back().PointsOffset = points.Size;
+            points.resize(points.Size + entry.PointsCount);
+            memcpy(points.Data + entries.back().PointsOffset, Points.Data + entry.PointsOffset, (size_t)entry.PointsCount * sizeof(ImVec2));
+        }
+        Entries.swap(entries);
+        Points.swap(points);
 
-        PathBezierToCasteljau(path, x1,y1,        x12,y12,    x123,y123,  x1234,y1234, tess_tol, level+1);
-        PathBezierToCasteljau(path, x1234,y1234,  x234,y234,  x34,y34,    x4,y4,       tess_tol, level+1);
+        const ImU32 mask = (ImU32)Buckets.Size - 1;
+        memset(Buckets.Data, 0xFF, (size_t)Buckets.Size * sizeof(int));
+        for (int n = 0; n < Entries.Size; n++)
+        {
+            ImU32 slot = Entries[n].Hash & mask;
+            while (Buckets[(int)slot] >= 0)
+                slot = (slot + 1) & mask;
+            Buckets[(int)slot] = n;
+        }
     }
+    Frame = frame_count;
+    UsedEntries = 0;
 }
 
-void ImDrawList::PathBezierCurveTo(const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, int num_segments)
+const ImVec2* ImDrawListCurveCache::GetFlattened(const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, float tess_tol, int num_segments, int* out_count)
 {
-    ImVec2 p1 = _Path.back();
-    if (num_segments == 0)
+    CurveKey key;
+    key.Ctrl[0] = p2;
+    key.Ctrl[1] = p3;
+    key.Ctrl[2] = p4;
+    key.TessTol = tess_tol;
+    key.NumSegments = num_segments;
+    const ImU32 hash = ImHash(&key, sizeof(key), 0);
+
+    if (Buckets.empty())
     {
-        // Auto-tessellated
-        PathBezierToCasteljau(&_Path, p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, p4.x, p4.y, GImGui->Style.CurveTessellationTol, 0);
+        Buckets.resize(IM_DRAWLIST_CURVE_CACHE_MAX * 2);
+        memset(Buckets.Data, 0xFF, (size_t)Buckets.Size * sizeof(int));
     }
-    else
+    const ImU32 mask = (ImU32)Buckets.Size - 1;
+    ImU32 slot = hash & mask;
+    for (; Buckets[(int)slot] >= 0; slot = (slot + 1) & mask)
     {
-        float t_step = 1.0f / (float)num_segments;
-        for (int i_step = 1; i_step <= num_segments; i_step++)
+        Entry& entry = Entries[Buckets[(int)slot]];
+        if (entry.Hash != hash || memcmp(&entry.Key, &key, sizeof(key)) != 0)
+            continue;
+        if (entry.LastUsedFrame != Frame)
         {
-            float t = t_step * i_step;
-            float u = 1.0f - t;
-            float w1 = u*u*u;
-            float w2 = 3*u*u*t;
-            float w3 = 3*u*t*t;
-            float w4 = t*t*t;
-            _Path.push_back(ImVec2(w1*p1.x + w2*p2.x + w3*p3.x + w4*p4.x, w1*p1.y + w2*p2.y + w3*p3.y + w4*p4.y));
+            entry.LastUsedFrame = Frame;
+            UsedEntries++;
         }
+        *out_count = entry.PointsCount;
+        return Points.Data + entry.PointsOffset;
+    }
+
+    const int count = (num_segments > 0) ? num_segments : PathBezierSegmentCount(p2, p3, p4, tess_tol);
+    *out_count = count;
+    if (Entries.Size >= IM_DRAWLIST_CURVE_CACHE_MAX)
+        return NULL;
+    Buckets[(int)slot] = Entries.Size;
+    Entries.resize(Entries.Size + 1);
+    Entry& entry = Entries.back();
+    entry.Key = key;
+    entry.Hash = hash;
+    entry.PointsOffset = Points.Size;
+    entry.PointsCount = count;
+    entry.LastUsedFrame = Frame;
+    UsedEntries++;
+    Points.resize(Points.Size + count);
+    PathBezierFlatten(Points.Data + entry.PointsOffset, p2, p3, p4, count);
+    return Points.Data + entry.PointsOffset;
+}
+
+void ImDrawList::PathBezierCurveTo(const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, int num_segments)
+{
+    ImGuiContext& g = *GImGui;
+    const ImVec2 p1 = _Path.back();
+    const ImVec2 d2(p2.x - p1.x, p2.y - p1.y), d3(p3.x - p1.x, p3.y - p1.y), d4(p4.x - p1.x, p4.y - p1.y);
+    const float tess_tol = (num_segments > 0) ? 0.0f : g.Style.CurveTessellationTol;
+    int count;
+    const ImVec2* points = g.CurveCache.GetFlattened(d2, d3, d4, tess_tol, ImMax(num_segments, 0), &count);
+
+    const int path_size = _Path.Size;
+    _Path.resize(path_size + count);
+    ImVec2* out = _Path.Data + path_size;
+    if (points == NULL)
+    {
+        PathBezierFlatten(out, d2, d3, d4, count);
+        points = out;
     }
+    for (int i = 0; i < count - 1; i++)
+        out[i] = ImVec2(p1.x + points[i].x, p1.y + points[i].y);
+    out[count - 1] = p4;
 }
 
 void ImDrawList::PathRect(const ImVec2& a, const ImVec2& b, float rounding, int rounding_corners)
@@ -904,8 +1138,17 @@ void ImDrawList::AddCircle(const ImVec2& centre, float radius, ImU32 col, int nu
     if ((col & IM_COL32_A_MASK) == 0)
         return;
 
-    const float a_max = IM_PI*2.0f * ((float)num_segments - 1.0f) / (float)num_segments;
-    PathArcTo(centre, radius-0.5f, 0.0f, a_max, num_segments);
+    if (num_segments <= 0)
+        num_segments = ImDrawListCircleSegmentCount(radius);
+    if (num_segments <= IM_DRAWLIST_CIRCLE_SEGMENT_MAX)
+    {
+        PathCircle(&_Path, centre, radius-0.5f, num_segments);
+    }
+    else
+    {
+        const float a_max = IM_PI*2.0f * ((float)num_segments - 1.0f) / (float)num_segments;
+        PathArcTo(centre, radius-0.5f, 0.0f, a_max, num_segments - 1);
+    }
     PathStroke(col, true, thickness);
 }
 
@@ -914,8 +1157,17 @@ void ImDrawList::AddCircleFilled(const ImVec2& centre, float radius, ImU32 col,
     if ((col & IM_COL32_A_MASK) == 0)
         return;
 
-    const float a_max = IM_PI*2.0f * ((float)num_segments - 1.0f) / (float)num_segments;
-    PathArcTo(centre, radius, 0.0f, a_max, num_segments);
+    if (num_segments <= 0)
+        num_segments = ImDrawListCircleSegmentCount(radius);
+    if (num_segments <= IM_DRAWLIST_CIRCLE_SEGMENT_MAX)
+    {
+        PathCircle(&_Path, centre, radius, num_segments);
+    }
+    else
+    {
+        const float a_max = IM_PI*2.0f * ((float)num_segments - 1.0f) / (float)num_segments;
+        PathArcTo(centre, radius, 0.0f, a_max, num_segments - 1);
+    }
     PathFillConvex(col);
 }
 
@@ -1038,12 +1290,76 @@ void ImDrawData::ScaleClipRects(const ImVec2& scale)
 // Shade functions
 //-----------------------------------------------------------------------------
 
+#ifdef IMDRAWSIMD_AVX2
+// 8 vertices at a time, pos and col gathered straight out of the ImDrawVert array. Same float math as the 4-wide loop.
+IMDRAWSIMD_AVX2_TARGET static ImDrawVert* ShadeVertsLinearColorGradientKeepAlphaAvx2(ImDrawVert* vert, ImDrawVert* vert_end, const ImVec2& gradient_p0, const ImVec2& gradient_extent, float gradient_inv_length2, const float* col0_rgb, const float* col_diff_rgb)
+{
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)sizeof(ImDrawVert)));
+    const __m256 p0_x = _mm256_set1_ps(gradient_p0.x), p0_y = _mm256_set1_ps(gradient_p0.y);
+    const __m256 extent_x = _mm256_set1_ps(gradient_extent.x), extent_y = _mm256_set1_ps(gradient_extent.y), inv_length2 = _mm256_set1_ps(gradient_inv_length2);
+    const __m256 zero = _mm256_set1_ps(0.0f), one = _mm256_set1_ps(1.0f);
+    const __m256 r0 = _mm256_set1_ps(col0_rgb[0]), g0 = _mm256_set1_ps(col0_rgb[1]), b0 = _mm256_set1_ps(col0_rgb[2]);
+    const __m256 r_diff = _mm256_set1_ps(col_diff_rgb[0]), g_diff = _mm256_set1_ps(col_diff_rgb[1]), b_diff = _mm256_set1_ps(col_diff_rgb[2]);
+    const __m256i alpha_mask = _mm256_set1_epi32((int)IM_COL32_A_MASK);
+    ImU32 cols[8];
+    for (; vert + 8 <= vert_end; vert += 8)
+    {
+        const __m256 x = _mm256_i32gather_ps(&vert->pos.x, offsets, 1);
+        const __m256 y = _mm256_i32gather_ps(&vert->pos.y, offsets, 1);
+        const __m256i col = _mm256_i32gather_epi32((const int*)&vert->col, offsets, 1);
+        const __m256 d = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(x, p0_x), extent_x), _mm256_mul_ps(_mm256_sub_ps(y, p0_y), extent_y));
+        const __m256 t = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(d, inv_length2), one), zero);
+        const __m256i r = _mm256_cvttps_epi32(_mm256_add_ps(r0, _mm256_mul_ps(r_diff, t)));
+        const __m256i g = _mm256_cvttps_epi32(_mm256_add_ps(g0, _mm256_mul_ps(g_diff, t)));
+        const __m256i b = _mm256_cvttps_epi32(_mm256_add_ps(b0, _mm256_mul_ps(b_diff, t)));
+        __m256i out = _mm256_and_si256(col, alpha_mask);
+        out = _mm256_or_si256(out, _mm256_slli_epi32(r, IM_COL32_R_SHIFT));
+        out = _mm256_or_si256(out, _mm256_slli_epi32(g, IM_COL32_G_SHIFT));
+        out = _mm256_or_si256(out, _mm256_slli_epi32(b, IM_COL32_B_SHIFT));
+        _mm256_storeu_si256((__m256i*)cols, out);
+        for (int n = 0; n < 8; n++)
+            vert[n].col = cols[n];
+    }
+    return vert;
+}
+#endif
+
 // Generic linear color gradient, write to RGB fields, leave A untouched.
+// Vertices are shaded 4 at a time (8 with AVX2 when the CPU has it), with the same float math as ImLerp(int) per channel.
 void ImGui::ShadeVertsLinearColorGradientKeepAlpha(ImDrawVert* vert_start, ImDrawVert* vert_end, ImVec2 gradient_p0, ImVec2 gradient_p1, ImU32 col0, ImU32 col1)
 {
     ImVec2 gradient_extent = gradient_p1 - gradient_p0;
     float gradient_inv_length2 = 1.0f / ImLengthSqr(gradient_extent);
-    for (ImDrawVert* vert = vert_start; vert < vert_end; vert++)
+    const int shifts[3] = { IM_COL32_R_SHIFT, IM_COL32_G_SHIFT, IM_COL32_B_SHIFT };
+    float col0_rgb[3], col_diff_rgb[3];
+    for (int c = 0; c < 3; c++)
+    {
+        const int a = (int)(col0 >> shifts[c]) & 0xFF, b = (int)(col1 >> shifts[c]) & 0xFF;
+        col0_rgb[c] = (float)a;
+        col_diff_rgb[c] = (float)(b - a);
+    }
+
+    ImDrawVert* vert = vert_start;
+#ifdef IMDRAWSIMD_AVX2
+    if (ImDrawSimdHasAvx2())
+        vert = ShadeVertsLinearColorGradientKeepAlphaAvx2(vert, vert_end, gradient_p0, gradient_extent, gradient_inv_length2, col0_rgb, col_diff_rgb);
+#endif
+    const ImSimd4f p0_x = ImSimd4fSet1(gradient_p0.x), p0_y = ImSimd4fSet1(gradient_p0.y);
+    const ImSimd4f extent_x = ImSimd4fSet1(gradient_extent.x), extent_y = ImSimd4fSet1(gradient_extent.y), inv_length2 = ImSimd4fSet1(gradient_inv_length2);
+    const ImSimd4f zero = ImSimd4fSet1(0.0f), one = ImSimd4fSet1(1.0f);
+    int rgb[3][4];
+    for (; vert + 4 <= vert_end; vert += 4)
+    {
+        const ImSimd4f x = ImSimd4fSet(vert[0].pos.x, vert[1].pos.x, vert[2].pos.x, vert[3].pos.x);
+        const ImSimd4f y = ImSimd4fSet(vert[0].pos.y, vert[1].pos.y, vert[2].pos.y, vert[3].pos.y);
+        const ImSimd4f d = ImSimd4fAdd(ImSimd4fMul(ImSimd4fSub(x, p0_x), extent_x), ImSimd4fMul(ImSimd4fSub(y, p0_y), extent_y));
+        const ImSimd4f t = ImSimd4fMax(ImSimd4fMin(ImSimd4fMul(d, inv_length2), one), zero);
+        for (int c = 0; c < 3; c++)
+            ImSimd4fStoreInt(rgb[c], ImSimd4fAdd(ImSimd4fSet1(col0_rgb[c]), ImSimd4fMul(ImSimd4fSet1(col_diff_rgb[c]), t)));
+        for (int n = 0; n < 4; n++)
+            vert[n].col = (rgb[0][n] << IM_COL32_R_SHIFT) | (rgb[1][n] << IM_COL32_G_SHIFT) | (rgb[2][n] << IM_COL32_B_SHIFT) | (vert[n].col & IM_COL32_A_MASK);
+    }
+    for (; vert < vert_end; vert++)
     {
         float d = ImDot(vert->pos - gradient_p0, gradient_extent);
         float t = ImClamp(d * gradient_inv_length2, 0.0f, 1.0f);
@@ -1055,12 +1371,37 @@ void ImGui::ShadeVertsLinearColorGradientKeepAlpha(ImDrawVert* vert_start, ImDra
 }
 
 // Scan and shade backward from the end of given vertices. Assume vertices are text only (= vert_start..vert_end going left to right) so we can break as soon as we are out the gradient bounds.
+// Groups of 4 vertices are shaded together while they can't reach the early out, the group that does goes through the scalar loop.
 void ImGui::ShadeVertsLinearAlphaGradientForLeftToRightText(ImDrawVert* vert_start, ImDrawVert* vert_end, float gradient_p0_x, float gradient_p1_x)
 {
     float gradient_extent_x = gradient_p1_x - gradient_p0_x;
     float gradient_inv_length2 = 1.0f / (gradient_extent_x * gradient_extent_x);
     int full_alpha_count = 0;
-    for (ImDrawVert* vert = vert_end - 1; vert >= vert_start; vert--)
+    const ImSimd4f p0_x = ImSimd4fSet1(gradient_p0_x), extent_x = ImSimd4fSet1(gradient_extent_x), inv_length2 = ImSimd4fSet1(gradient_inv_length2);
+    const ImSimd4f zero = ImSimd4fSet1(0.0f), one = ImSimd4fSet1(1.0f);
+    float alpha_muls[4];
+    int new_alphas[4];
+    ImDrawVert* vert = vert_end;
+    for (; vert - 4 >= vert_start; vert -= 4)
+    {
+        ImDrawVert* group = vert - 4;
+        const ImSimd4f x = ImSimd4fSet(group[0].pos.x, group[1].pos.x, group[2].pos.x, group[3].pos.x);
+        const ImSimd4f d = ImSimd4fMul(ImSimd4fSub(x, p0_x), extent_x);
+        const ImSimd4f alpha_mul = ImSimd4fSub(one, ImSimd4fMax(ImSimd4fMin(ImSimd4fMul(d, inv_length2), one), zero));
+        ImSimd4fStore(alpha_muls, alpha_mul);
+        int group_full_alpha_count = 0;
+        for (int n = 0; n < 4; n++)
+            group_full_alpha_count += alpha_muls[n] >= 1.0f;
+        if (full_alpha_count + group_full_alpha_count > 2)
+            break;
+        full_alpha_count += group_full_alpha_count;
+        const ImSimd4f alpha = ImSimd4fSet((float)((group[0].col >> IM_COL32_A_SHIFT) & 0xFF), (float)((group[1].col >> IM_COL32_A_SHIFT) & 0xFF),
+                                           (float)((group[2].col >> IM_COL32_A_SHIFT) & 0xFF), (float)((group[3].col >> IM_COL32_A_SHIFT) & 0xFF));
+        ImSimd4fStoreInt(new_alphas, ImSimd4fMul(alpha, alpha_mul));
+        for (int n = 0; n < 4; n++)
+            group[n].col = (group[n].col & ~IM_COL32_A_MASK) | (new_alphas[n] << IM_COL32_A_SHIFT);
+    }
+    for (vert--; vert >= vert_start; vert--)
     {
         float d = (vert->pos.x - gradient_p0_x) * (gradient_extent_x);
         float alpha_mul = 1.0f - ImClamp(d * gradient_inv_length2, 0.0f, 1.0f);
@@ -1091,6 +1432,7 @@ ImFontConfig::ImFontConfig()
     MergeMode = false;
     RasterizerFlags = 0x00;
     RasterizerMultiply = 1.0f;
+    GlyphsOnDemand = false;
     memset(Name, 0, sizeof(Name));
     DstFont = NULL;
 }
@@ -1140,12 +1482,18 @@ ImFontAtlas::ImFontAtlas()
     TexID = NULL;
     TexDesiredWidth = 0;
     TexGlyphPadding = 1;
+    BuildThreads = 0;
+    BuildCacheFilename = NULL;
+    TexOnDemandHeight = 0;
+    TexDistanceField = false;
+    TexDistanceFieldSpread = 4;
     TexPixelsAlpha8 = NULL;
     TexPixelsRGBA32 = NULL;
     TexWidth = TexHeight = 0;
     TexUvWhitePixel = ImVec2(0, 0);
     for (int n = 0; n < IM_ARRAYSIZE(CustomRectIds); n++)
         CustomRectIds[n] = -1;
+    OnDemand = NULL;
 }
 
 ImFontAtlas::~ImFontAtlas()
@@ -1155,6 +1503,8 @@ ImFontAtlas::~ImFontAtlas()
 
 void    ImFontAtlas::ClearInputData()
 {
+    // Glyphs on demand are rendered from the input data, the ones already rendered stay
+    ImFontAtlasBuildClearGlyphsOnDemand(this);
     for (int i = 0; i < ConfigData.Size; i++)
         if (ConfigData[i].FontData && ConfigData[i].FontDataOwnedByAtlas)
         {
@@ -1187,6 +1537,7 @@ void    ImFontAtlas::ClearTexData()
 
 void    ImFontAtlas::ClearFonts()
 {
+    ImFontAtlasBuildClearGlyphsOnDemand(this);
     for (int i = 0; i < Fonts.Size; i++)
     {
         Fonts[i]->~ImFont();
@@ -1300,11 +1651,49 @@ ImFont* ImFontAtlas::AddFontDefault(const ImFontConfig* font_cfg_template)
     if (font_cfg.Name[0] == '\0') strcpy(font_cfg.Name, "ProggyClean.ttf, 13px");
     if (font_cfg.SizePixels <= 0.0f) font_cfg.SizePixels = 13.0f;
 
+#ifdef IMGUI_PREBAKED_DEFAULT_FONT
+    // The atlas baked at build time replaces the TTF data as long as the default font is alone with its default settings. The input is
+    // registered without data, Build() only decodes it when the baked atlas doesn't fit (another font added, atlas settings changed).
+    if (!font_cfg_template && ConfigData.empty())
+    {
+        ImFont* font = (ImFont*)ImGui::MemAlloc(sizeof(ImFont));
+        IM_PLACEMENT_NEW(font) ImFont();
+        Fonts.push_back(font);
+        font_cfg.GlyphRanges = GetGlyphRangesDefault();
+        font_cfg.DstFont = font;
+        font_cfg.FontDataOwnedByAtlas = true;
+        ConfigData.push_back(font_cfg);
+        ClearTexData();
+        return font;
+    }
+#endif
+
     const char* ttf_compressed_base85 = GetDefaultCompressedFontDataTTFBase85();
     ImFont* font = AddFontFromMemoryCompressedBase85TTF(ttf_compressed_base85, font_cfg.SizePixels, &font_cfg, GetGlyphRangesDefault());
     return font;
 }
 
+#ifdef IMGUI_PREBAKED_DEFAULT_FONT
+// Give the input AddFontDefault() left without data its TTF after all
+static void ImFontAtlasBuildDecodeDefaultFont(ImFontAtlas* atlas)
+{
+    for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
+    {
+        ImFontConfig& cfg = atlas->ConfigData[input_i];
+        if (cfg.FontData != NULL)
+            continue;
+        const char* compressed_ttf_data_base85 = GetDefaultCompressedFontDataTTFBase85();
+        int compressed_ttf_size = (((int)strlen(compressed_ttf_data_base85) + 4) / 5) * 4;
+        unsigned char* compressed_ttf = (unsigned char*)ImGui::MemAlloc((size_t)compressed_ttf_size);
+        Decode85((const unsigned char*)compressed_ttf_data_base85, compressed_ttf);
+        cfg.FontDataSize = (int)stb_decompress_length(compressed_ttf);
+        cfg.FontData = ImGui::MemAlloc((size_t)cfg.FontDataSize);
+        stb_decompress((unsigned char*)cfg.FontData, compressed_ttf, (unsigned int)compressed_ttf_size);
+        ImGui::MemFree(compressed_ttf);
+    }
+}
+#endif
+
 ImFont* ImFontAtlas::AddFontFromFileTTF(const char* filename, float size_pixels, const ImFontConfig* font_cfg_template, const ImWchar* glyph_ranges)
 {
     int data_size = 0;
@@ -1399,7 +1788,25 @@ void ImFontAtlas::CalcCustomRectUV(const CustomRect* rect, ImVec2* out_uv_min, I
 
 bool    ImFontAtlas::Build()
 {
-    return ImFontAtlasBuildWithStbTruetype(this);
+    // A previous run may have left this exact atlas on disk, loading it skips stb_truetype entirely.
+    // Inputs with GlyphsOnDemand render next to nothing here and keep changing the atlas afterwards, those atlases are always built.
+#ifdef IMGUI_PREBAKED_DEFAULT_FONT
+    // Nothing to decode or rasterize when the inputs are what the build baked in
+    if (ImFontAtlasBuildLoadPrebaked(this, &GImFontAtlasPrebakedDefault))
+        return true;
+    ImFontAtlasBuildDecodeDefaultFont(this);
+#endif
+    bool use_cache = BuildCacheFilename != NULL;
+    for (int input_i = 0; input_i < ConfigData.Size; input_i++)
+        if (ConfigData[input_i].GlyphsOnDemand)
+            use_cache = false;
+    if (use_cache && ImFontAtlasBuildLoadCache(this, BuildCacheFilename))
+        return true;
+    if (!ImFontAtlasBuildWithStbTruetype(this))
+        return false;
+    if (use_cache)
+        ImFontAtlasBuildSaveCache(this, BuildCacheFilename);
+    return true;
 }
 
 void    ImFontAtlasBuildMultiplyCalcLookupTable(unsigned char out_table[256], float in_brighten_factor)
@@ -1419,6 +1826,81 @@ void    ImFontAtlasBuildMultiplyRectAlpha8(const unsigned char table[256], unsig
             data[i] = table[data[i]];
 }
 
+struct ImFontTempBuildData
+{
+    stbtt_fontinfo      FontInfo;
+    stbrp_rect*         Rects;
+    int                 RectsCount;
+    stbtt_pack_range*   Ranges;
+    int                 RangesCount;
+};
+
+// A run of consecutive glyphs of one range, rendered by a single thread
+struct ImFontBuildRenderJob
+{
+    int                 InputIndex;
+    int                 RangeIndex;
+    int                 CharStart, CharCount;
+    int                 RectStart;          // Index of the first glyph's rectangle in ImFontTempBuildData::Rects
+};
+
+const int FONT_ATLAS_BUILD_JOB_GLYPHS = 64;
+const int FONT_ATLAS_ON_DEMAND_GLYPHS = 1024;   // Glyphs the band of the GlyphsOnDemand inputs is sized for, unless TexOnDemandHeight is set
+const unsigned char FONT_ATLAS_DISTANCE_FIELD_ON_EDGE = 128;
+
+// Border stbtt_GetGlyphSDF() adds around each glyph of a TexDistanceField atlas, 0 for coverage
+static int ImFontAtlasBuildDistanceFieldSpread(const ImFontAtlas* atlas)
+{
+    return atlas->TexDistanceField ? ImMax(atlas->TexDistanceFieldSpread, 1) : 0;
+}
+
+// stbtt_PackFontRangesRenderIntoRects() for a TexDistanceField atlas. The rects were gathered with the spread added to the padding on both
+// sides and no oversampling, each gets the stbtt_GetGlyphSDF() output and its stbtt_packedchar the same fields the coverage version sets.
+static void ImFontAtlasBuildRenderDistanceFieldIntoRects(const ImFontAtlas* atlas, stbtt_pack_context* spc, const stbtt_fontinfo* info, stbtt_pack_range* ranges, int num_ranges, stbrp_rect* rects)
+{
+    const int spread = ImFontAtlasBuildDistanceFieldSpread(atlas);
+    const int pad = spc->padding - spread * 2;
+    for (int i = 0, k = 0; i < num_ranges; i++)
+    {
+        const float scale = stbtt_ScaleForPixelHeight(info, ranges[i].font_size);
+        for (int j = 0; j < ranges[i].num_chars; j++, k++)
+        {
+            stbrp_rect* r = &rects[k];
+            if (!r->was_packed)
+                continue;
+
+            // Padding on the left and top, as stb_truetype does
+            r->x += (stbrp_coord)pad;
+            r->y += (stbrp_coord)pad;
+            r->w -= (stbrp_coord)pad;
+            r->h -= (stbrp_coord)pad;
+            const int glyph = stbtt_FindGlyphIndex(info, ranges[i].first_unicode_codepoint_in_range + j);
+            int advance, left_side_bearing, w = 0, h = 0, x_off = 0, y_off = 0;
+            stbtt_GetGlyphHMetrics(info, glyph, &advance, &left_side_bearing);
+            unsigned char* sdf = stbtt_GetGlyphSDF(info, scale, glyph, spread, FONT_ATLAS_DISTANCE_FIELD_ON_EDGE, 127.0f / spread, &w, &h, &x_off, &y_off);
+            if (sdf)
+            {
+                IM_ASSERT(w == r->w && h == r->h);
+                for (int y = 0; y < h; y++)
+                    memcpy(spc->pixels + r->x + (r->y + y) * spc->stride_in_bytes, sdf + y * w, (size_t)w);
+                stbtt_FreeSDF(sdf, info->userdata);
+            }
+
+            // Empty glyphs (space) keep a zero sized quad and their advance
+            stbtt_packedchar* bc = &ranges[i].chardata_for_range[j];
+            bc->x0 = (unsigned short)r->x;
+            bc->y0 = (unsigned short)r->y;
+            bc->x1 = (unsigned short)(r->x + w);
+            bc->y1 = (unsigned short)(r->y + h);
+            bc->xadvance = scale * advance;
+            bc->xoff = (float)x_off;
+            bc->yoff = (float)y_off;
+            bc->xoff2 = (float)(x_off + w);
+            bc->yoff2 = (float)(y_off + h);
+        }
+    }
+}
+
 bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
 {
     IM_ASSERT(atlas->ConfigData.Size > 0);
@@ -1429,15 +1911,20 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     atlas->TexWidth = atlas->TexHeight = 0;
     atlas->TexUvWhitePixel = ImVec2(0, 0);
     atlas->ClearTexData();
+    ImFontAtlasBuildClearGlyphsOnDemand(atlas);
 
-    // Count glyphs/ranges
+    // Count glyphs/ranges, the GlyphsOnDemand inputs pack nothing here
     int total_glyphs_count = 0;
     int total_ranges_count = 0;
+    bool has_glyphs_on_demand = false;
     for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
     {
         ImFontConfig& cfg = atlas->ConfigData[input_i];
         if (!cfg.GlyphRanges)
             cfg.GlyphRanges = atlas->GetGlyphRangesDefault();
+        has_glyphs_on_demand |= cfg.GlyphsOnDemand;
+        if (cfg.GlyphsOnDemand)
+            continue;
         for (const ImWchar* in_range = cfg.GlyphRanges; in_range[0] && in_range[1]; in_range += 2, total_ranges_count++)
             total_glyphs_count += (in_range[1] - in_range[0]) + 1;
     }
@@ -1447,24 +1934,17 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     atlas->TexWidth = (atlas->TexDesiredWidth > 0) ? atlas->TexDesiredWidth : (total_glyphs_count > 4000) ? 4096 : (total_glyphs_count > 2000) ? 2048 : (total_glyphs_count > 1000) ? 1024 : 512;
     atlas->TexHeight = 0;
 
-    // Start packing
+    // Start packing, distance fields need their spread around each glyph on top of the padding
     const int max_tex_height = 1024*32;
+    const int sdf_spread = ImFontAtlasBuildDistanceFieldSpread(atlas);
     stbtt_pack_context spc;
-    stbtt_PackBegin(&spc, NULL, atlas->TexWidth, max_tex_height, 0, atlas->TexGlyphPadding, NULL);
+    stbtt_PackBegin(&spc, NULL, atlas->TexWidth, max_tex_height, 0, atlas->TexGlyphPadding + sdf_spread * 2, NULL);
     stbtt_PackSetOversampling(&spc, 1, 1);
 
     // Pack our extra data rectangles first, so it will be on the upper-left corner of our texture (UV will have small values).
     ImFontAtlasBuildPackCustomRects(atlas, spc.pack_info);
 
     // Initialize font information (so we can error without any cleanup)
-    struct ImFontTempBuildData
-    {
-        stbtt_fontinfo      FontInfo;
-        stbrp_rect*         Rects;
-        int                 RectsCount;
-        stbtt_pack_range*   Ranges;
-        int                 RangesCount;
-    };
     ImFontTempBuildData* tmp_array = (ImFontTempBuildData*)ImGui::MemAlloc((size_t)atlas->ConfigData.Size * sizeof(ImFontTempBuildData));
     for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
     {
@@ -1479,6 +1959,7 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
             ImGui::MemFree(tmp_array);
             return false;
         }
+        tmp.FontInfo.userdata = NULL;
     }
 
     // Allocate packing character data and flag packed characters buffer as non-packed (x0=y0=x1=y1=0)
@@ -1491,10 +1972,26 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     memset(buf_ranges, 0, total_ranges_count * sizeof(stbtt_pack_range));
 
     // First font pass: pack all glyphs (no rendering at this point, we are working with rectangles in an infinitely tall texture at this point)
+    int on_demand_height = 0;
     for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
     {
         ImFontConfig& cfg = atlas->ConfigData[input_i];
         ImFontTempBuildData& tmp = tmp_array[input_i];
+        if (cfg.GlyphsOnDemand)
+        {
+            // Only size the band, assuming glyphs about as wide as they are tall (true of the CJK ranges this is meant for)
+            tmp.Ranges = NULL;
+            tmp.RangesCount = 0;
+            tmp.Rects = NULL;
+            tmp.RectsCount = 0;
+            const int oversample_h = atlas->TexDistanceField ? 1 : cfg.OversampleH;
+            const int oversample_v = atlas->TexDistanceField ? 1 : cfg.OversampleV;
+            const int cell_w = (int)(cfg.SizePixels * oversample_h) + oversample_h - 1 + atlas->TexGlyphPadding + sdf_spread * 2;
+            const int cell_h = (int)(cfg.SizePixels * oversample_v) + oversample_v - 1 + atlas->TexGlyphPadding + sdf_spread * 2;
+            const int cells_per_row = ImMax(atlas->TexWidth / cell_w, 1);
+            on_demand_height = ImMax(on_demand_height, (FONT_ATLAS_ON_DEMAND_GLYPHS + cells_per_row - 1) / cells_per_row * cell_h);
+            continue;
+        }
 
         // Setup ranges
         int font_glyphs_count = 0;
@@ -1519,7 +2016,10 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
         tmp.Rects = buf_rects + buf_rects_n;
         tmp.RectsCount = font_glyphs_count;
         buf_rects_n += font_glyphs_count;
-        stbtt_PackSetOversampling(&spc, cfg.OversampleH, cfg.OversampleV);
+        if (atlas->TexDistanceField)
+            stbtt_PackSetOversampling(&spc, 1, 1);
+        else
+            stbtt_PackSetOversampling(&spc, cfg.OversampleH, cfg.OversampleV);
         int n = stbtt_PackFontRangesGatherRects(&spc, &tmp.FontInfo, tmp.Ranges, tmp.RangesCount, tmp.Rects);
         IM_ASSERT(n == font_glyphs_count);
         stbrp_pack_rects((stbrp_context*)spc.pack_info, tmp.Rects, n);
@@ -1533,7 +2033,10 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     IM_ASSERT(buf_packedchars_n == total_glyphs_count);
     IM_ASSERT(buf_ranges_n == total_ranges_count);
 
-    // Create texture
+    // Create texture, the band for the GlyphsOnDemand inputs goes below everything packed and gets the rows the rounding adds
+    const int on_demand_y = atlas->TexHeight;
+    if (has_glyphs_on_demand)
+        atlas->TexHeight += (atlas->TexOnDemandHeight > 0) ? atlas->TexOnDemandHeight : on_demand_height;
     atlas->TexHeight = ImUpperPowerOfTwo(atlas->TexHeight);
     atlas->TexPixelsAlpha8 = (unsigned char*)ImGui::MemAlloc(atlas->TexWidth * atlas->TexHeight);
     memset(atlas->TexPixelsAlpha8, 0, atlas->TexWidth * atlas->TexHeight);
@@ -1541,22 +2044,68 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     spc.height = atlas->TexHeight;
 
     // Second pass: render font characters
+    // Every glyph has a rectangle of its own so they can be rendered in any order and on any thread, the result is the
+    // same as rendering them one after the other. The glyphs are handed out in short runs taken from a single range.
+    ImVector<ImFontBuildRenderJob> jobs;
     for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
     {
-        ImFontConfig& cfg = atlas->ConfigData[input_i];
         ImFontTempBuildData& tmp = tmp_array[input_i];
-        stbtt_PackSetOversampling(&spc, cfg.OversampleH, cfg.OversampleV);
-        stbtt_PackFontRangesRenderIntoRects(&spc, &tmp.FontInfo, tmp.Ranges, tmp.RangesCount, tmp.Rects);
-        if (cfg.RasterizerMultiply != 1.0f)
+        for (int i = 0, rect_n = 0; i < tmp.RangesCount; rect_n += tmp.Ranges[i].num_chars, i++)
+            for (int char_n = 0; char_n < tmp.Ranges[i].num_chars; char_n += FONT_ATLAS_BUILD_JOB_GLYPHS)
+            {
+                ImFontBuildRenderJob job;
+                job.InputIndex = input_i;
+                job.RangeIndex = i;
+                job.CharStart = char_n;
+                job.CharCount = ImMin(FONT_ATLAS_BUILD_JOB_GLYPHS, tmp.Ranges[i].num_chars - char_n);
+                job.RectStart = rect_n + char_n;
+                jobs.push_back(job);
+            }
+    }
+    int thread_count = atlas->BuildThreads > 0 ? atlas->BuildThreads : (int)std::thread::hardware_concurrency();
+    thread_count = ImClamp(thread_count, 1, ImMax(jobs.Size, 1));
+    std::atomic<int> next_job(0);
+    auto worker = [atlas, &spc, tmp_array, &jobs, &next_job]()
+    {
+        for (int job_n = next_job++; job_n < jobs.Size; job_n = next_job++)
         {
-            unsigned char multiply_table[256];
-            ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
-            for (const stbrp_rect* r = tmp.Rects; r != tmp.Rects + tmp.RectsCount; r++)
-                if (r->was_packed)
-                    ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, spc.pixels, r->x, r->y, r->w, r->h, spc.stride_in_bytes);
+            const ImFontBuildRenderJob& job = jobs[job_n];
+            const ImFontConfig& cfg = atlas->ConfigData[job.InputIndex];
+            ImFontTempBuildData& tmp = tmp_array[job.InputIndex];
+
+            // Rendering changes the oversampling of the context, and user data routes the allocations (see STBTT_malloc)
+            stbtt_pack_context job_spc = spc;
+            stbtt_fontinfo job_info = tmp.FontInfo;
+            job_info.userdata = atlas;
+            stbtt_pack_range range = tmp.Ranges[job.RangeIndex];
+            range.first_unicode_codepoint_in_range += job.CharStart;
+            range.chardata_for_range += job.CharStart;
+            range.num_chars = job.CharCount;
+            stbrp_rect* rects = tmp.Rects + job.RectStart;
+            if (atlas->TexDistanceField)
+            {
+                ImFontAtlasBuildRenderDistanceFieldIntoRects(atlas, &job_spc, &job_info, &range, 1, rects);
+                continue;
+            }
+            stbtt_PackFontRangesRenderIntoRects(&job_spc, &job_info, &range, 1, rects);
+            if (cfg.RasterizerMultiply != 1.0f)
+            {
+                unsigned char multiply_table[256];
+                ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
+                for (const stbrp_rect* r = rects; r != rects + job.CharCount; r++)
+                    if (r->was_packed)
+                        ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, job_spc.pixels, r->x, r->y, r->w, r->h, job_spc.stride_in_bytes);
+            }
         }
-        tmp.Rects = NULL;
-    }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < thread_count; i++)
+        workers.push_back(std::thread(worker));
+    worker();
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+    for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
+        tmp_array[input_i].Rects = NULL;
 
     // End packing
     stbtt_PackEnd(&spc);
@@ -1607,6 +2156,8 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     ImGui::MemFree(tmp_array);
 
     ImFontAtlasBuildFinish(atlas);
+    if (has_glyphs_on_demand)
+        ImFontAtlasBuildSetupGlyphsOnDemand(atlas, on_demand_y);
 
     return true;
 }
@@ -1731,6 +2282,613 @@ void ImFontAtlasBuildFinish(ImFontAtlas* atlas)
         atlas->Fonts[i]->BuildLookupTable();
 }
 
+//-----------------------------------------------------------------------------
+// ImFontAtlas glyphs on demand
+//-----------------------------------------------------------------------------
+// Build() indexes the codepoints of the GlyphsOnDemand inputs (so CalcTextSize() has their advance from the start) but renders none of them.
+// FindGlyph() queues the ones text looks up and UpdateGlyphsOnDemand() packs them into a band at the bottom of the texture with its own
+// stb_rect_pack context. They are added to the end of their font's Glyphs, from OnDemandGlyphsStart on, with the frame each was last looked up
+// in. A skyline packer can't free a single rectangle, so a full band is emptied and packed again keeping the most recently used glyphs.
+
+// IndexLookup values of the codepoints a GlyphsOnDemand input has: not rendered yet, and queued by FindGlyph() for UpdateGlyphsOnDemand()
+const unsigned short FONT_ATLAS_GLYPH_ON_DEMAND = 0xFFFE;
+const unsigned short FONT_ATLAS_GLYPH_REQUESTED = 0xFFFD;
+const int FONT_ATLAS_ON_DEMAND_KEEP_FRAMES = 2;     // Glyphs looked up in this many frames are kept before the ones that were asked for when the band is full
+
+struct ImFontOnDemandGlyph
+{
+    ImFont*             Font;
+    ImWchar             Codepoint;
+    int                 InputIndex;         // Index in ConfigData of the input rendering it
+    int                 LastUsed;           // ImFontAtlasOnDemand::Frame it was last looked up in
+    stbrp_rect          Rect;               // Within the band
+};
+
+struct ImFontAtlasOnDemand
+{
+    int                             BandY, BandHeight;
+    stbrp_context                   Pack;
+    ImVector<stbrp_node>            PackNodes;
+    ImVector<stbtt_fontinfo>        FontInfos;  // Per ConfigData entry, only set for the GlyphsOnDemand ones
+    ImVector<ImFontOnDemandGlyph>   Requests;   // Queued by FindGlyph() since the last update, Font and Codepoint only
+    int                             Frame;      // Number of UpdateGlyphsOnDemand() calls
+};
+
+void ImFontAtlasBuildSetupGlyphsOnDemand(ImFontAtlas* atlas, int band_y)
+{
+    IM_ASSERT(atlas->OnDemand == NULL && band_y < atlas->TexHeight);
+    ImFontAtlasOnDemand* on_demand = (ImFontAtlasOnDemand*)ImGui::MemAlloc(sizeof(ImFontAtlasOnDemand));
+    IM_PLACEMENT_NEW(on_demand) ImFontAtlasOnDemand();
+    atlas->OnDemand = on_demand;
+    on_demand->BandY = band_y;
+    on_demand->BandHeight = atlas->TexHeight - band_y;
+    on_demand->PackNodes.resize(atlas->TexWidth);
+    stbrp_init_target(&on_demand->Pack, atlas->TexWidth, on_demand->BandHeight, on_demand->PackNodes.Data, on_demand->PackNodes.Size);
+    on_demand->Frame = 0;
+
+    // The build already initialized every input once, this can't fail
+    on_demand->FontInfos.resize(atlas->ConfigData.Size);
+    memset(on_demand->FontInfos.Data, 0, (size_t)on_demand->FontInfos.Size * sizeof(stbtt_fontinfo));
+    for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
+    {
+        const ImFontConfig& cfg = atlas->ConfigData[input_i];
+        if (!cfg.GlyphsOnDemand)
+            continue;
+        const int font_offset = stbtt_GetFontOffsetForIndex((unsigned char*)cfg.FontData, cfg.FontNo);
+        stbtt_InitFont(&on_demand->FontInfos[input_i], (unsigned char*)cfg.FontData, font_offset);
+        on_demand->FontInfos[input_i].userdata = NULL;
+    }
+    for (int i = 0; i < atlas->Fonts.Size; i++)
+        ImFontAtlasBuildIndexGlyphsOnDemand(atlas, atlas->Fonts[i]);
+}
+
+// Mark the codepoints the GlyphsOnDemand inputs of 'font' have and no glyph of the font covers yet. Like merged inputs, the first input having a
+// codepoint renders it.
+void ImFontAtlasBuildIndexGlyphsOnDemand(ImFontAtlas* atlas, ImFont* font)
+{
+    ImFontAtlasOnDemand* on_demand = atlas->OnDemand;
+    font->OnDemandGlyphsStart = 0xFFFF;
+    font->OnDemandGlyphsUsed.resize(0);
+    if (!on_demand || !font->ConfigData)
+        return;
+
+    bool indexed = false;
+    for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
+    {
+        const ImFontConfig& cfg = atlas->ConfigData[input_i];
+        if (cfg.DstFont != font || !cfg.GlyphsOnDemand)
+            continue;
+        indexed = true;
+        const stbtt_fontinfo* info = &on_demand->FontInfos[input_i];
+        const float scale = stbtt_ScaleForPixelHeight(info, cfg.SizePixels);
+        for (const ImWchar* in_range = cfg.GlyphRanges; in_range[0] && in_range[1]; in_range += 2)
+            for (int codepoint = in_range[0]; codepoint <= in_range[1]; codepoint++)
+            {
+                if (codepoint < font->IndexLookup.Size && font->IndexLookup[codepoint] != (unsigned short)-1)
+                    continue;
+                const int glyph = stbtt_FindGlyphIndex(info, codepoint);
+                if (glyph == 0)
+                    continue;
+                int advance, left_side_bearing;
+                stbtt_GetGlyphHMetrics(info, glyph, &advance, &left_side_bearing);
+
+                // Same as the AdvanceX AddGlyph() will give it
+                float advance_x = advance * scale + font->ConfigData->GlyphExtraSpacing.x;
+                if (font->ConfigData->PixelSnapH)
+                    advance_x = (float)(int)(advance_x + 0.5f);
+                font->GrowIndex(codepoint + 1);
+                font->IndexAdvanceX[codepoint] = advance_x;
+                font->IndexLookup[codepoint] = FONT_ATLAS_GLYPH_ON_DEMAND;
+            }
+    }
+    if (!indexed)
+        return;
+    font->OnDemandGlyphsStart = font->Glyphs.Size;
+    for (int i = 0; i < font->IndexAdvanceX.Size; i++)
+        if (font->IndexAdvanceX[i] < 0.0f)
+            font->IndexAdvanceX[i] = font->FallbackAdvanceX;
+}
+
+void ImFontAtlasBuildClearGlyphsOnDemand(ImFontAtlas* atlas)
+{
+    if (!atlas->OnDemand)
+        return;
+    for (int i = 0; i < atlas->Fonts.Size; i++)
+    {
+        atlas->Fonts[i]->OnDemandGlyphsStart = 0xFFFF;
+        atlas->Fonts[i]->OnDemandGlyphsUsed.clear();
+    }
+    atlas->OnDemand->~ImFontAtlasOnDemand();
+    ImGui::MemFree(atlas->OnDemand);
+    atlas->OnDemand = NULL;
+}
+
+static int ImFontAtlasOnDemandFindInput(ImFontAtlas* atlas, const ImFont* font, int codepoint)
+{
+    for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
+    {
+        const ImFontConfig& cfg = atlas->ConfigData[input_i];
+        if (cfg.DstFont != font || !cfg.GlyphsOnDemand)
+            continue;
+        for (const ImWchar* in_range = cfg.GlyphRanges; in_range[0] && in_range[1]; in_range += 2)
+            if (codepoint >= in_range[0] && codepoint <= in_range[1] && stbtt_FindGlyphIndex(&atlas->OnDemand->FontInfos[input_i], codepoint) != 0)
+                return input_i;
+    }
+    return -1;
+}
+
+// A pack context and a one glyph range for the stbtt_PackFontRanges*() functions, only the fields they read are set
+static void ImFontAtlasOnDemandSetupRange(ImFontAtlas* atlas, const ImFontOnDemandGlyph& glyph, stbtt_pack_context* spc, stbtt_pack_range* range, stbtt_packedchar* packed_char)
+{
+    const ImFontConfig& cfg = atlas->ConfigData[glyph.InputIndex];
+    memset(spc, 0, sizeof(*spc));
+    spc->width = atlas->TexWidth;
+    spc->height = atlas->TexHeight;
+    spc->stride_in_bytes = atlas->TexWidth;
+    spc->padding = atlas->TexGlyphPadding + ImFontAtlasBuildDistanceFieldSpread(atlas) * 2;
+    spc->h_oversample = atlas->TexDistanceField ? 1 : cfg.OversampleH;
+    spc->v_oversample = atlas->TexDistanceField ? 1 : cfg.OversampleV;
+    spc->pixels = atlas->TexPixelsAlpha8;
+    memset(range, 0, sizeof(*range));
+    memset(packed_char, 0, sizeof(*packed_char));
+    range->font_size = cfg.SizePixels;
+    range->first_unicode_codepoint_in_range = glyph.Codepoint;
+    range->num_chars = 1;
+    range->chardata_for_range = packed_char;
+}
+
+// Pack one glyph into the band, render it and add it to its font. False when it does not fit.
+static bool ImFontAtlasOnDemandPlace(ImFontAtlas* atlas, ImFontOnDemandGlyph& glyph)
+{
+    ImFontAtlasOnDemand* on_demand = atlas->OnDemand;
+    ImFont* font = glyph.Font;
+    if (font->Glyphs.Size + 1 >= FONT_ATLAS_GLYPH_REQUESTED)
+        return false;
+    stbtt_pack_context spc;
+    stbtt_pack_range range;
+    stbtt_packedchar packed_char;
+    ImFontAtlasOnDemandSetupRange(atlas, glyph, &spc, &range, &packed_char);
+    const stbtt_fontinfo* info = &on_demand->FontInfos[glyph.InputIndex];
+    stbtt_PackFontRangesGatherRects(&spc, info, &range, 1, &glyph.Rect);
+    stbrp_pack_rects(&on_demand->Pack, &glyph.Rect, 1);
+    if (!glyph.Rect.was_packed)
+        return false;
+
+    const ImFontConfig& cfg = atlas->ConfigData[glyph.InputIndex];
+    stbrp_rect rect = glyph.Rect;
+    rect.y += (stbrp_coord)on_demand->BandY;
+    if (atlas->TexDistanceField)
+        ImFontAtlasBuildRenderDistanceFieldIntoRects(atlas, &spc, info, &range, 1, &rect);
+    else
+        stbtt_PackFontRangesRenderIntoRects(&spc, info, &range, 1, &rect);
+    if (cfg.RasterizerMultiply != 1.0f && !atlas->TexDistanceField)
+    {
+        unsigned char multiply_table[256];
+        ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
+        ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, atlas->TexPixelsAlpha8, rect.x, rect.y, rect.w, rect.h, atlas->TexWidth);
+    }
+
+    // As the third pass of ImFontAtlasBuildWithStbTruetype() does
+    const float off_x = cfg.GlyphOffset.x;
+    const float off_y = cfg.GlyphOffset.y + (float)(int)(font->Ascent + 0.5f);
+    stbtt_aligned_quad q;
+    float dummy_x = 0.0f, dummy_y = 0.0f;
+    stbtt_GetPackedQuad(&packed_char, atlas->TexWidth, atlas->TexHeight, 0, &dummy_x, &dummy_y, &q, 0);
+    font->AddGlyph(glyph.Codepoint, q.x0 + off_x, q.y0 + off_y, q.x1 + off_x, q.y1 + off_y, q.s0, q.t0, q.s1, q.t1, packed_char.xadvance);
+    font->IndexLookup[glyph.Codepoint] = (unsigned short)(font->Glyphs.Size - 1);
+    font->OnDemandGlyphsUsed.push_back(glyph.LastUsed);
+    return true;
+}
+
+static int ImFontOnDemandGlyphComparerByLastUsed(const void* lhs, const void* rhs)
+{
+    return ((const ImFontOnDemandGlyph*)rhs)->LastUsed - ((const ImFontOnDemandGlyph*)lhs)->LastUsed;
+}
+
+// The band is full: empty it and pack again the glyphs looked up in the last frames, then the ones that did not fit, then the older ones from the
+// most recently used down, until one does not fit. Whatever is left out goes back to FONT_ATLAS_GLYPH_ON_DEMAND. False if nothing could be evicted.
+static bool ImFontAtlasOnDemandEvict(ImFontAtlas* atlas, const ImVector<ImFontOnDemandGlyph>& not_fitting)
+{
+    ImFontAtlasOnDemand* on_demand = atlas->OnDemand;
+    const int keep_frame = on_demand->Frame - FONT_ATLAS_ON_DEMAND_KEEP_FRAMES;
+    ImVector<ImFontOnDemandGlyph> resident;
+    bool evictable = false;
+    for (int i = 0; i < atlas->Fonts.Size; i++)
+    {
+        ImFont* font = atlas->Fonts[i];
+        for (int n = 0; n < font->OnDemandGlyphsUsed.Size; n++)
+        {
+            ImFontOnDemandGlyph glyph;
+            glyph.Font = font;
+            glyph.Codepoint = font->Glyphs[font->OnDemandGlyphsStart + n].Codepoint;
+            glyph.InputIndex = ImFontAtlasOnDemandFindInput(atlas, font, glyph.Codepoint);
+            glyph.LastUsed = font->OnDemandGlyphsUsed[n];
+            resident.push_back(glyph);
+            evictable |= glyph.LastUsed < keep_frame;
+        }
+    }
+    if (!evictable)
+        return false;
+    if (resident.Size > 1)
+        qsort(resident.Data, (size_t)resident.Size, sizeof(ImFontOnDemandGlyph), ImFontOnDemandGlyphComparerByLastUsed);
+
+    // Empty the band
+    for (int i = 0; i < atlas->Fonts.Size; i++)
+    {
+        ImFont* font = atlas->Fonts[i];
+        for (int n = font->OnDemandGlyphsStart; n < font->Glyphs.Size; n++)
+        {
+            const ImFontGlyph& glyph = font->Glyphs[n];
+            font->IndexLookup[glyph.Codepoint] = FONT_ATLAS_GLYPH_ON_DEMAND;
+            font->MetricsTotalSurface -= (int)((glyph.U1 - glyph.U0) * atlas->TexWidth + 1.99f) * (int)((glyph.V1 - glyph.V0) * atlas->TexHeight + 1.99f);
+        }
+        if (font->OnDemandGlyphsUsed.Size > 0)
+            font->Glyphs.resize(font->OnDemandGlyphsStart);
+        font->OnDemandGlyphsUsed.resize(0);
+    }
+    stbrp_init_target(&on_demand->Pack, atlas->TexWidth, on_demand->BandHeight, on_demand->PackNodes.Data, on_demand->PackNodes.Size);
+    memset(atlas->TexPixelsAlpha8 + on_demand->BandY * atlas->TexWidth, 0, (size_t)(on_demand->BandHeight * atlas->TexWidth));
+
+    int resident_n = 0;
+    for (; resident_n < resident.Size && resident[resident_n].LastUsed >= keep_frame; resident_n++)
+        ImFontAtlasOnDemandPlace(atlas, resident[resident_n]);
+    for (int n = 0; n < not_fitting.Size; n++)
+    {
+        ImFontOnDemandGlyph glyph = not_fitting[n];
+        if (!ImFontAtlasOnDemandPlace(atlas, glyph))
+            glyph.Font->IndexLookup[glyph.Codepoint] = FONT_ATLAS_GLYPH_ON_DEMAND;
+    }
+    for (; resident_n < resident.Size; resident_n++)
+        if (!ImFontAtlasOnDemandPlace(atlas, resident[resident_n]))
+            break;
+    return true;
+}
+
+bool ImFontAtlas::UpdateGlyphsOnDemand(int* out_x, int* out_y, int* out_width, int* out_height)
+{
+    // Without the pixels (ClearTexData() was called) nothing can be rendered, the next GetTexData*() builds everything again
+    ImFontAtlasOnDemand* on_demand = OnDemand;
+    if (!on_demand || !TexPixelsAlpha8)
+        return false;
+    const int request_frame = on_demand->Frame++;
+    if (on_demand->Requests.empty())
+        return false;
+
+    // Place the glyphs in the order they were asked for
+    int x0 = TexWidth, y0 = TexHeight, x1 = 0, y1 = 0;
+    ImVector<ImFontOnDemandGlyph> not_fitting;
+    for (int n = 0; n < on_demand->Requests.Size; n++)
+    {
+        ImFontOnDemandGlyph glyph = on_demand->Requests[n];
+        if (glyph.Font->IndexLookup[glyph.Codepoint] != FONT_ATLAS_GLYPH_REQUESTED)
+            continue;   // BuildLookupTable() ran since, a later request is there if it was looked up again
+        glyph.InputIndex = ImFontAtlasOnDemandFindInput(this, glyph.Font, glyph.Codepoint);
+        glyph.LastUsed = request_frame;
+        if (glyph.InputIndex < 0)
+        {
+            // An AddRemapChar() copy of a mark, there is nothing to render it from
+            glyph.Font->IndexLookup[glyph.Codepoint] = (unsigned short)-1;
+            continue;
+        }
+        if (!ImFontAtlasOnDemandPlace(this, glyph))
+        {
+            not_fitting.push_back(glyph);
+            continue;
+        }
+        x0 = ImMin(x0, (int)glyph.Rect.x);
+        y0 = ImMin(y0, on_demand->BandY + glyph.Rect.y);
+        x1 = ImMax(x1, glyph.Rect.x + glyph.Rect.w);
+        y1 = ImMax(y1, on_demand->BandY + glyph.Rect.y + glyph.Rect.h);
+    }
+    on_demand->Requests.resize(0);
+
+    if (!not_fitting.empty())
+    {
+        if (ImFontAtlasOnDemandEvict(this, not_fitting))
+        {
+            x0 = 0;
+            y0 = on_demand->BandY;
+            x1 = TexWidth;
+            y1 = TexHeight;
+        }
+        else
+        {
+            // Everything in the band is in use, they are asked for again the next time they are drawn
+            for (int n = 0; n < not_fitting.Size; n++)
+                not_fitting[n].Font->IndexLookup[not_fitting[n].Codepoint] = FONT_ATLAS_GLYPH_ON_DEMAND;
+        }
+    }
+
+    // Glyphs may have been reallocated
+    for (int i = 0; i < Fonts.Size; i++)
+    {
+        ImFont* font = Fonts[i];
+        const unsigned short fallback_i = (font->FallbackChar < font->IndexLookup.Size) ? font->IndexLookup[font->FallbackChar] : (unsigned short)-1;
+        font->FallbackGlyph = (fallback_i < FONT_ATLAS_GLYPH_REQUESTED) ? &font->Glyphs[fallback_i] : NULL;
+    }
+    if (x0 >= x1 || y0 >= y1)
+        return false;
+
+    if (TexPixelsRGBA32)
+        for (int y = y0; y < y1; y++)
+        {
+            const unsigned char* src = TexPixelsAlpha8 + y * TexWidth + x0;
+            unsigned int* dst = TexPixelsRGBA32 + y * TexWidth + x0;
+            for (int n = x1 - x0; n > 0; n--)
+                *dst++ = IM_COL32(255, 255, 255, (unsigned int)(*src++));
+        }
+    if (out_x) *out_x = x0;
+    if (out_y) *out_y = y0;
+    if (out_width) *out_width = x1 - x0;
+    if (out_height) *out_height = y1 - y0;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// ImFontAtlas build cache
+//-----------------------------------------------------------------------------
+// The file keeps the output of a build: the alpha pixels, where every custom rectangle was packed and for each font its
+// metrics, glyphs and lookup indices. The header holds a hash of every input of the build (TTF data, ImFontConfig fields,
+// glyph ranges, custom rectangle requests, atlas settings), a file built from anything else is ignored and rewritten.
+// Sections are stored with the in-memory layout of the machine that wrote them, it is a cache and not a format to ship.
+
+const unsigned int FONT_ATLAS_CACHE_MAGIC   = 0x41464D49;  // "IMFA"
+const unsigned int FONT_ATLAS_CACHE_VERSION = 2;           // Bump when the layout or the rasterized output changes
+
+struct ImFontAtlasCacheHeader
+{
+    unsigned int    Magic;
+    unsigned int    Version;
+    ImU32           Key;
+    unsigned int    GlyphSize;          // sizeof(ImFontGlyph), differs when ImWchar is configured differently
+    int             TexWidth, TexHeight;
+    int             FontsCount;
+    int             CustomRectsCount;
+};
+
+struct ImFontAtlasCacheFont
+{
+    float           Ascent, Descent;
+    int             MetricsTotalSurface;
+    int             GlyphsCount;
+    int             IndexCount;         // Size of both IndexAdvanceX and IndexLookup
+};
+
+struct ImFontAtlasCacheReader
+{
+    const char*     P;
+    const char*     End;
+
+    const char*     Skip(size_t size)               { if ((size_t)(End - P) < size) return NULL; const char* p = P; P += size; return p; }
+    bool            Read(void* dst, size_t size)    { const char* p = Skip(size); if (p) memcpy(dst, p, size); return p != NULL; }
+};
+
+static ImU32 ImFontAtlasCacheHashData(ImU32 seed, const void* data, int data_size)
+{
+    // ImHash() treats a size of 0 as a zero-terminated string
+    return data_size > 0 ? ImHash(data, data_size, seed) : seed;
+}
+
+template<typename T>
+static ImU32 ImFontAtlasCacheHashValue(ImU32 seed, const T& value)
+{
+    return ImHash(&value, (int)sizeof(T), seed);
+}
+
+static int ImFontAtlasCacheFontIndex(const ImFontAtlas* atlas, const ImFont* font)
+{
+    for (int i = 0; i < atlas->Fonts.Size; i++)
+        if (atlas->Fonts[i] == font)
+            return i;
+    return -1;
+}
+
+static ImU32 ImFontAtlasCacheKey(ImFontAtlas* atlas)
+{
+    ImU32 key = ImFontAtlasCacheHashValue(0, FONT_ATLAS_CACHE_VERSION);
+    key = ImFontAtlasCacheHashValue(key, atlas->TexDesiredWidth);
+    key = ImFontAtlasCacheHashValue(key, atlas->TexGlyphPadding);
+    key = ImFontAtlasCacheHashValue(key, atlas->TexDistanceField);
+    key = ImFontAtlasCacheHashValue(key, atlas->TexDistanceField ? atlas->TexDistanceFieldSpread : 0);
+    for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
+    {
+        ImFontConfig& cfg = atlas->ConfigData[input_i];
+        if (!cfg.GlyphRanges)
+            cfg.GlyphRanges = atlas->GetGlyphRangesDefault(); // Same default as ImFontAtlasBuildWithStbTruetype()
+        int ranges_size = 0;
+        while (cfg.GlyphRanges[ranges_size] && cfg.GlyphRanges[ranges_size + 1])
+            ranges_size += 2;
+
+        key = ImFontAtlasCacheHashData(key, cfg.FontData, cfg.FontDataSize);
+        key = ImFontAtlasCacheHashData(key, cfg.GlyphRanges, ranges_size * (int)sizeof(ImWchar));
+        key = ImFontAtlasCacheHashValue(key, cfg.FontNo);
+        key = ImFontAtlasCacheHashValue(key, cfg.SizePixels);
+        key = ImFontAtlasCacheHashValue(key, cfg.OversampleH);
+        key = ImFontAtlasCacheHashValue(key, cfg.OversampleV);
+        key = ImFontAtlasCacheHashValue(key, cfg.PixelSnapH);
+        key = ImFontAtlasCacheHashValue(key, cfg.GlyphExtraSpacing);
+        key = ImFontAtlasCacheHashValue(key, cfg.GlyphOffset);
+        key = ImFontAtlasCacheHashValue(key, cfg.MergeMode);
+        key = ImFontAtlasCacheHashValue(key, cfg.RasterizerFlags);
+        key = ImFontAtlasCacheHashValue(key, cfg.RasterizerMultiply);
+        key = ImFontAtlasCacheHashValue(key, ImFontAtlasCacheFontIndex(atlas, cfg.DstFont));
+    }
+    for (int i = 0; i < atlas->CustomRects.Size; i++)
+    {
+        const ImFontAtlas::CustomRect& r = atlas->CustomRects[i];
+        key = ImFontAtlasCacheHashValue(key, r.ID);
+        key = ImFontAtlasCacheHashValue(key, r.Width);
+        key = ImFontAtlasCacheHashValue(key, r.Height);
+        key = ImFontAtlasCacheHashValue(key, r.GlyphAdvanceX);
+        key = ImFontAtlasCacheHashValue(key, r.GlyphOffset);
+        key = ImFontAtlasCacheHashValue(key, ImFontAtlasCacheFontIndex(atlas, r.Font));
+    }
+    return key;
+}
+
+// Fill a font with the output of an earlier build. The tables are copied byte-wise, the cache file doesn't keep them aligned.
+static void ImFontAtlasBuildRestoreFont(ImFont* dst_font, float ascent, float descent, int metrics_total_surface, const void* glyphs, int glyphs_count, const void* index_advance_x, const void* index_lookup, int index_count)
+{
+    dst_font->Ascent = ascent;
+    dst_font->Descent = descent;
+    dst_font->MetricsTotalSurface = metrics_total_surface;
+    dst_font->Glyphs.resize(glyphs_count);
+    dst_font->IndexAdvanceX.resize(index_count);
+    dst_font->IndexLookup.resize(index_count);
+    memcpy(dst_font->Glyphs.Data, glyphs, (size_t)glyphs_count * sizeof(ImFontGlyph));
+    memcpy(dst_font->IndexAdvanceX.Data, index_advance_x, (size_t)index_count * sizeof(float));
+    memcpy(dst_font->IndexLookup.Data, index_lookup, (size_t)index_count * sizeof(unsigned short));
+    dst_font->FallbackGlyph = NULL;
+    dst_font->FallbackGlyph = dst_font->FindGlyph(dst_font->FallbackChar);
+    dst_font->FallbackAdvanceX = dst_font->FallbackGlyph ? dst_font->FallbackGlyph->AdvanceX : 0.0f;
+}
+
+// Load the atlas from a file written by ImFontAtlasBuildSaveCache() for the same inputs. Returns false and leaves the atlas untouched when the file is missing, stale or truncated.
+bool ImFontAtlasBuildLoadCache(ImFontAtlas* atlas, const char* filename)
+{
+    IM_ASSERT(atlas->ConfigData.Size > 0);
+
+    // The default rectangle is part of the inputs, register it the way a build would
+    ImFontAtlasBuildRegisterDefaultCustomRects(atlas);
+
+    int file_size = 0;
+    char* file_data = (char*)ImFileLoadToMemory(filename, "rb", &file_size);
+    if (!file_data)
+        return false;
+
+    // First pass: check the header and that every section is there, nothing is written to the atlas yet
+    ImFontAtlasCacheReader reader = { file_data, file_data + file_size };
+    ImFontAtlasCacheHeader header;
+    bool valid = reader.Read(&header, sizeof(header))
+        && header.Magic == FONT_ATLAS_CACHE_MAGIC && header.Version == FONT_ATLAS_CACHE_VERSION && header.GlyphSize == sizeof(ImFontGlyph)
+        && header.TexWidth > 0 && header.TexHeight > 0 && header.FontsCount == atlas->Fonts.Size && header.CustomRectsCount == atlas->CustomRects.Size
+        && header.Key == ImFontAtlasCacheKey(atlas);
+    const char* pixels = valid ? reader.Skip((size_t)header.TexWidth * header.TexHeight) : NULL;
+    const char* rects = pixels ? reader.Skip((size_t)header.CustomRectsCount * 2 * sizeof(unsigned short)) : NULL;
+    valid = rects != NULL;
+    ImVector<ImFontAtlasCacheFont> fonts;
+    ImVector<const char*> fonts_data;
+    fonts.resize(valid ? header.FontsCount : 0);
+    fonts_data.resize(fonts.Size);
+    for (int i = 0; valid && i < fonts.Size; i++)
+    {
+        const ImFontAtlasCacheFont& font = fonts[i];
+        valid = reader.Read(&fonts[i], sizeof(ImFontAtlasCacheFont)) && font.GlyphsCount >= 0 && font.GlyphsCount < 0xFFFF && font.IndexCount >= 0 && font.IndexCount <= 0x10000;
+        fonts_data[i] = valid ? reader.Skip((size_t)font.GlyphsCount * sizeof(ImFontGlyph) + (size_t)font.IndexCount * (sizeof(float) + sizeof(unsigned short))) : NULL;
+        valid = fonts_data[i] != NULL;
+    }
+    if (!valid || reader.P != reader.End)
+    {
+        ImGui::MemFree(file_data);
+        return false;
+    }
+
+    // Second pass: same state as ImFontAtlasBuildWithStbTruetype() leaves behind
+    atlas->TexID = NULL;
+    atlas->ClearTexData();
+    atlas->TexWidth = header.TexWidth;
+    atlas->TexHeight = header.TexHeight;
+    atlas->TexPixelsAlpha8 = (unsigned char*)ImGui::MemAlloc((size_t)atlas->TexWidth * atlas->TexHeight);
+    memcpy(atlas->TexPixelsAlpha8, pixels, (size_t)atlas->TexWidth * atlas->TexHeight);
+    for (int i = 0; i < atlas->CustomRects.Size; i++, rects += 2 * sizeof(unsigned short))
+    {
+        memcpy(&atlas->CustomRects[i].X, rects, sizeof(unsigned short));
+        memcpy(&atlas->CustomRects[i].Y, rects + sizeof(unsigned short), sizeof(unsigned short));
+    }
+    for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
+        ImFontAtlasBuildSetupFont(atlas, atlas->ConfigData[input_i].DstFont, &atlas->ConfigData[input_i], 0.0f, 0.0f);
+    for (int i = 0; i < atlas->Fonts.Size; i++)
+    {
+        const ImFontAtlasCacheFont& font = fonts[i];
+        const char* glyphs = fonts_data[i];
+        const char* index_advance_x = glyphs + (size_t)font.GlyphsCount * sizeof(ImFontGlyph);
+        const char* index_lookup = index_advance_x + (size_t)font.IndexCount * sizeof(float);
+        ImFontAtlasBuildRestoreFont(atlas->Fonts[i], font.Ascent, font.Descent, font.MetricsTotalSurface, glyphs, font.GlyphsCount, index_advance_x, index_lookup, font.IndexCount);
+    }
+    ImGui::MemFree(file_data);
+
+    // The cursor shapes and white pixel UV live outside the atlas, the pixels themselves are already in place
+    ImFontAtlasBuildRenderDefaultTexData(atlas);
+    return true;
+}
+
+// Write a built atlas for ImFontAtlasBuildLoadCache(). Call right after the build, before AddRemapChar() or drawing into custom rectangles.
+bool ImFontAtlasBuildSaveCache(ImFontAtlas* atlas, const char* filename)
+{
+    IM_ASSERT(atlas->TexPixelsAlpha8 != NULL);
+    FILE* f = ImFileOpen(filename, "wb");
+    if (!f)
+        return false;
+
+    ImFontAtlasCacheHeader header;
+    header.Magic = FONT_ATLAS_CACHE_MAGIC;
+    header.Version = FONT_ATLAS_CACHE_VERSION;
+    header.Key = ImFontAtlasCacheKey(atlas);
+    header.GlyphSize = sizeof(ImFontGlyph);
+    header.TexWidth = atlas->TexWidth;
+    header.TexHeight = atlas->TexHeight;
+    header.FontsCount = atlas->Fonts.Size;
+    header.CustomRectsCount = atlas->CustomRects.Size;
+    fwrite(&header, sizeof(header), 1, f);
+    fwrite(atlas->TexPixelsAlpha8, 1, (size_t)atlas->TexWidth * atlas->TexHeight, f);
+    for (int i = 0; i < atlas->CustomRects.Size; i++)
+    {
+        fwrite(&atlas->CustomRects[i].X, sizeof(unsigned short), 1, f);
+        fwrite(&atlas->CustomRects[i].Y, sizeof(unsigned short), 1, f);
+    }
+    for (int i = 0; i < atlas->Fonts.Size; i++)
+    {
+        const ImFont* src_font = atlas->Fonts[i];
+        IM_ASSERT(src_font->IndexAdvanceX.Size == src_font->IndexLookup.Size);
+        ImFontAtlasCacheFont font;
+        font.Ascent = src_font->Ascent;
+        font.Descent = src_font->Descent;
+        font.MetricsTotalSurface = src_font->MetricsTotalSurface;
+        font.GlyphsCount = src_font->Glyphs.Size;
+        font.IndexCount = src_font->IndexLookup.Size;
+        fwrite(&font, sizeof(font), 1, f);
+        fwrite(src_font->Glyphs.Data, sizeof(ImFontGlyph), (size_t)font.GlyphsCount, f);
+        fwrite(src_font->IndexAdvanceX.Data, sizeof(float), (size_t)font.IndexCount, f);
+        fwrite(src_font->IndexLookup.Data, sizeof(unsigned short), (size_t)font.IndexCount, f);
+    }
+
+    // A partly written file would only be refused on load, don't leave it around
+    const bool ok = ferror(f) == 0;
+    fclose(f);
+    if (!ok)
+        remove(filename);
+    return ok;
+}
+
+// Load an atlas baked at build time (see tools/ImFontAtlasBake.cpp). Only applies to the single input AddFontDefault() registers without TTF data,
+// with the atlas settings of the bake. Returns false and leaves the atlas untouched otherwise.
+bool ImFontAtlasBuildLoadPrebaked(ImFontAtlas* atlas, const ImFontAtlasPrebaked* prebaked)
+{
+    if (atlas->ConfigData.Size != 1 || atlas->Fonts.Size != 1 || atlas->CustomRects.Size != (atlas->CustomRectIds[0] >= 0 ? 1 : 0))
+        return false;
+    const ImFontConfig& cfg = atlas->ConfigData[0];
+    if (cfg.FontData != NULL || cfg.MergeMode || cfg.GlyphsOnDemand || cfg.SizePixels != prebaked->SizePixels || cfg.DstFont != atlas->Fonts[0])
+        return false;
+    if (atlas->TexDesiredWidth != prebaked->TexDesiredWidth || atlas->TexGlyphPadding != prebaked->TexGlyphPadding || atlas->TexDistanceField)
+        return false;
+
+    // Same state as ImFontAtlasBuildWithStbTruetype() leaves behind
+    ImFontAtlasBuildRegisterDefaultCustomRects(atlas);
+    atlas->TexID = NULL;
+    atlas->ClearTexData();
+    atlas->TexWidth = prebaked->TexWidth;
+    atlas->TexHeight = prebaked->TexHeight;
+    atlas->TexPixelsAlpha8 = (unsigned char*)ImGui::MemAlloc((size_t)atlas->TexWidth * atlas->TexHeight);
+    memcpy(atlas->TexPixelsAlpha8, prebaked->Pixels, (size_t)atlas->TexWidth * atlas->TexHeight);
+    atlas->CustomRects[0].X = prebaked->DefaultRectX;
+    atlas->CustomRects[0].Y = prebaked->DefaultRectY;
+    ImFontAtlasBuildSetupFont(atlas, atlas->Fonts[0], &atlas->ConfigData[0], 0.0f, 0.0f);
+    ImFontAtlasBuildRestoreFont(atlas->Fonts[0], prebaked->Ascent, prebaked->Descent, prebaked->MetricsTotalSurface,
+        prebaked->Glyphs, prebaked->GlyphsCount, prebaked->IndexAdvanceX, prebaked->IndexLookup, prebaked->IndexCount);
+    ImFontAtlasBuildRenderDefaultTexData(atlas);
+    return true;
+}
+
 // Retrieve list of range (2 int per range, values are inclusive)
 const ImWchar*   ImFontAtlas::GetGlyphRangesDefault()
 {
@@ -1933,15 +3091,23 @@ void    ImFont::ClearOutputData()
     ContainerAtlas = NULL;
     Ascent = Descent = 0.0f;
     MetricsTotalSurface = 0;
+    OnDemandGlyphsStart = 0xFFFF;
+    OnDemandGlyphsUsed.clear();
 }
 
 void ImFont::BuildLookupTable()
 {
+    // Glyphs rendered on demand are dropped, their codepoints are marked again at the end and text asks for them again
+    if (OnDemandGlyphsStart < Glyphs.Size)
+        Glyphs.resize(OnDemandGlyphsStart);
+    OnDemandGlyphsStart = 0xFFFF;
+    OnDemandGlyphsUsed.resize(0);
+
     int max_codepoint = 0;
     for (int i = 0; i != Glyphs.Size; i++)
         max_codepoint = ImMax(max_codepoint, (int)Glyphs[i].Codepoint);
 
-    IM_ASSERT(Glyphs.Size < 0xFFFF); // -1 is reserved
+    IM_ASSERT(Glyphs.Size < FONT_ATLAS_GLYPH_REQUESTED); // -1 and the GlyphsOnDemand marks are reserved
     IndexAdvanceX.clear();
     IndexLookup.clear();
     GrowIndex(max_codepoint + 1);
@@ -1972,6 +3138,9 @@ void ImFont::BuildLookupTable()
     for (int i = 0; i < max_codepoint + 1; i++)
         if (IndexAdvanceX[i] < 0.0f)
             IndexAdvanceX[i] = FallbackAdvanceX;
+
+    if (ContainerAtlas && ContainerAtlas->OnDemand)
+        ImFontAtlasBuildIndexGlyphsOnDemand(ContainerAtlas, this);
 }
 
 void ImFont::SetFallbackChar(ImWchar c)
@@ -2031,8 +3200,23 @@ const ImFontGlyph* ImFont::FindGlyph(unsigned short c) const
     if (c < IndexLookup.Size)
     {
         const unsigned short i = IndexLookup[c];
-        if (i != (unsigned short)-1)
+        if (i < FONT_ATLAS_GLYPH_REQUESTED)
+        {
+            if (i >= OnDemandGlyphsStart)
+                OnDemandGlyphsUsed.Data[i - OnDemandGlyphsStart] = ContainerAtlas->OnDemand->Frame;
             return &Glyphs.Data[i];
+        }
+        if (i == FONT_ATLAS_GLYPH_ON_DEMAND && ContainerAtlas->OnDemand)
+        {
+            // Queued for ImFontAtlas::UpdateGlyphsOnDemand(), the mark is the only thing changed so the font still reads the same
+            ImFont* font = const_cast<ImFont*>(this);
+            font->IndexLookup.Data[c] = FONT_ATLAS_GLYPH_REQUESTED;
+            ImFontOnDemandGlyph request;
+            memset(&request, 0, sizeof(request));
+            request.Font = font;
+            request.Codepoint = c;
+            ContainerAtlas->OnDemand->Requests.push_back(request);
+        }
     }
     return FallbackGlyph;
 }
@@ -2244,6 +3428,103 @@ void ImFont::RenderChar(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col
     }
 }
 
+// corner = (x, y, u, v), in a single store when the vertex layout keeps uv right after pos
+static inline void ImFontWriteGlyphVert(ImDrawVert* vtx, ImSimd4f corner, ImU32 col)
+{
+    if (IM_OFFSETOF(ImDrawVert, uv) == IM_OFFSETOF(ImDrawVert, pos) + sizeof(ImVec2))
+    {
+        ImSimd4fStore(&vtx->pos.x, corner);
+    }
+    else
+    {
+        float c[4];
+        ImSimd4fStore(c, corner);
+        vtx->pos.x = c[0]; vtx->pos.y = c[1]; vtx->uv.x = c[2]; vtx->uv.y = c[3];
+    }
+    vtx->col = col;
+}
+
+// Quads of the glyphs RenderText() gathered on one line, each glyph drawn at its pen position x = xs[n].
+// A quad is computed as (x1, y1, x2, y2) in one register and written with its UVs 16 bytes at a time. The few that are culled
+// or need CPU fine clipping (each lane compared against its side of the clip rect) go through the scalar code.
+static void ImFontRenderGlyphRun(ImDrawVert*& vtx_write_ref, ImDrawIdx*& idx_write_ref, unsigned int& vtx_current_idx_ref, const ImFontGlyph* const* glyphs, const float* xs, int count, float y, float scale, ImU32 col, const ImVec4& clip_rect, bool cpu_fine_clip)
+{
+    // Copied so the vertex writes can't be assumed to alias them
+    ImDrawVert* vtx_write = vtx_write_ref;
+    ImDrawIdx* idx_write = idx_write_ref;
+    unsigned int vtx_current_idx = vtx_current_idx_ref;
+    const ImSimd4f clip_lo = ImSimd4fSet(cpu_fine_clip ? clip_rect.x : -FLT_MAX, cpu_fine_clip ? clip_rect.y : -FLT_MAX, clip_rect.x, -FLT_MAX);
+    const ImSimd4f clip_hi = ImSimd4fSet(clip_rect.z, FLT_MAX, cpu_fine_clip ? clip_rect.z : FLT_MAX, cpu_fine_clip ? clip_rect.w : FLT_MAX);
+    const ImSimd4f scale4 = ImSimd4fSet1(scale);
+    for (int n = 0; n < count; n++)
+    {
+        const ImFontGlyph* glyph = glyphs[n];
+        const float x = xs[n];
+        ImSimd4f quad_pos = ImSimd4fAdd(ImSimd4fSet(x, y, x, y), ImSimd4fMul(ImSimd4fLoad(&glyph->X0), scale4));
+        ImSimd4f quad_uv = ImSimd4fLoad(&glyph->U0);
+        int outside = ImSimd4fMaskGt(clip_lo, quad_pos) | ImSimd4fMaskGt(quad_pos, clip_hi);
+        if (cpu_fine_clip && !(ImSimd4fMaskGt(ImSimd4fSwapHalves(quad_pos), quad_pos) & 2)) // !(y2 > y1), empty glyphs are dropped
+            outside = 1;
+        if (outside != 0)
+        {
+            float p[4], t[4];
+            ImSimd4fStore(p, quad_pos);
+            ImSimd4fStore(t, quad_uv);
+            float x1 = p[0], y1 = p[1], x2 = p[2], y2 = p[3];
+            float u1 = t[0], v1 = t[1], u2 = t[2], v2 = t[3];
+
+            // We don't do a second finer clipping test on the Y axis as we've already skipped anything before clip_rect.y and exit once we pass clip_rect.w
+            if (!(x1 <= clip_rect.z && x2 >= clip_rect.x))
+                continue;
+
+            // CPU side clipping used to fit text in their frame when the frame is too small. Only does clipping for axis aligned quads.
+            if (cpu_fine_clip)
+            {
+                if (x1 < clip_rect.x)
+                {
+                    u1 = u1 + (1.0f - (x2 - clip_rect.x) / (x2 - x1)) * (u2 - u1);
+                    x1 = clip_rect.x;
+                }
+                if (y1 < clip_rect.y)
+                {
+                    v1 = v1 + (1.0f - (y2 - clip_rect.y) / (y2 - y1)) * (v2 - v1);
+                    y1 = clip_rect.y;
+                }
+                if (x2 > clip_rect.z)
+                {
+                    u2 = u1 + ((clip_rect.z - x1) / (x2 - x1)) * (u2 - u1);
+                    x2 = clip_rect.z;
+                }
+                if (y2 > clip_rect.w)
+                {
+                    v2 = v1 + ((clip_rect.w - y1) / (y2 - y1)) * (v2 - v1);
+                    y2 = clip_rect.w;
+                }
+                if (y1 >= y2)
+                    continue;
+            }
+            quad_pos = ImSimd4fSet(x1, y1, x2, y2);
+            quad_uv = ImSimd4fSet(u1, v1, u2, v2);
+        }
+
+        // We are NOT calling PrimRectUV() here because non-inlined causes too much overhead in a debug builds. Inlined here:
+        ImSimd4f corners[4];
+        ImSimd4fRectCorners(quad_pos, quad_uv, corners);
+        idx_write[0] = (ImDrawIdx)(vtx_current_idx); idx_write[1] = (ImDrawIdx)(vtx_current_idx+1); idx_write[2] = (ImDrawIdx)(vtx_current_idx+2);
+        idx_write[3] = (ImDrawIdx)(vtx_current_idx); idx_write[4] = (ImDrawIdx)(vtx_current_idx+2); idx_write[5] = (ImDrawIdx)(vtx_current_idx+3);
+        ImFontWriteGlyphVert(&vtx_write[0], corners[0], col);
+        ImFontWriteGlyphVert(&vtx_write[1], corners[1], col);
+        ImFontWriteGlyphVert(&vtx_write[2], corners[2], col);
+        ImFontWriteGlyphVert(&vtx_write[3], corners[3], col);
+        vtx_write += 4;
+        vtx_current_idx += 4;
+        idx_write += 6;
+    }
+    vtx_write_ref = vtx_write;
+    idx_write_ref = idx_write;
+    vtx_current_idx_ref = vtx_current_idx;
+}
+
 void ImFont::RenderText(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col, const ImVec4& clip_rect, const char* text_begin, const char* text_end, float wrap_width, bool cpu_fine_clip) const
 {
     if (!text_end)
@@ -2278,6 +3559,9 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col
     ImDrawIdx* idx_write = draw_list->_IdxWritePtr;
     unsigned int vtx_current_idx = draw_list->_VtxCurrentIdx;
 
+    // Two passes per line (or wrapped segment): decode its characters into glyphs and pen positions, then write their quads together
+    const ImFontGlyph* run_glyphs[64];
+    float run_x[64];
     while (s < text_end)
     {
         if (word_wrap_enabled)
@@ -2306,105 +3590,88 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col
             }
         }
 
-        // Decode and advance source
-        unsigned int c = (unsigned int)*s;
-        if (c < 0x80)
-        {
-            s += 1;
-        }
-        else
-        {
-            s += ImTextCharFromUtf8(&c, s, text_end);
-            if (c == 0) // Malformed UTF-8?
-                break;
-        }
-
-        if (c < 32)
+        // Decode up to the end of the line, the wrap point or a full run
+        const char* run_end = (word_wrap_enabled && word_wrap_eol < text_end) ? word_wrap_eol : text_end;
+        int run_count = 0;
+        bool new_line = false;
+        bool malformed = false;
+        while (s < run_end && run_count < IM_ARRAYSIZE(run_glyphs))
         {
-            if (c == '\n')
+            // Printable ASCII needs neither decoding nor the control character checks
+            const int run_room = IM_ARRAYSIZE(run_glyphs) - run_count;
+            const int ascii_count = ImDrawSimdCountPrintableAscii(s, (run_end - s > run_room) ? s + run_room : run_end);
+            for (int n = 0; n < ascii_count; n++)
             {
-                x = pos.x;
-                y += line_height;
-
-                if (y > clip_rect.w)
-                    break;
-                if (!word_wrap_enabled && y + line_height < clip_rect.y)
-                    while (s < text_end && *s != '\n')  // Fast-forward to next line
-                        s++;
-                continue;
+                // FindGlyph() inlined for glyphs already in the atlas
+                const unsigned int c = (unsigned int)s[n];
+                const unsigned short glyph_idx = (c < (unsigned int)IndexLookup.Size) ? IndexLookup.Data[c] : FONT_ATLAS_GLYPH_REQUESTED;
+                if (const ImFontGlyph* glyph = (glyph_idx < FONT_ATLAS_GLYPH_REQUESTED && glyph_idx < OnDemandGlyphsStart) ? &Glyphs.Data[glyph_idx] : FindGlyph((unsigned short)c))
+                {
+                    if (c != ' ')
+                    {
+                        run_glyphs[run_count] = glyph;
+                        run_x[run_count++] = x;
+                    }
+                    x += glyph->AdvanceX * scale;
+                }
             }
-            if (c == '\r')
+            s += ascii_count;
+            if (ascii_count > 0)
                 continue;
-        }
 
-        float char_width = 0.0f;
-        if (const ImFontGlyph* glyph = FindGlyph((unsigned short)c))
-        {
-            char_width = glyph->AdvanceX * scale;
+            // Decode and advance source
+            unsigned int c = (unsigned int)*s;
+            if (c < 0x80)
+            {
+                s += 1;
+            }
+            else
+            {
+                s += ImTextCharFromUtf8(&c, s, text_end);
+                if (c == 0) // Malformed UTF-8?
+                {
+                    malformed = true;
+                    break;
+                }
+            }
 
-            // Arbitrarily assume that both space and tabs are empty glyphs as an optimization
-            if (c != ' ' && c != '\t')
+            if (c < 32)
             {
-                // We don't do a second finer clipping test on the Y axis as we've already skipped anything before clip_rect.y and exit once we pass clip_rect.w
-                float x1 = x + glyph->X0 * scale;
-                float x2 = x + glyph->X1 * scale;
-                float y1 = y + glyph->Y0 * scale;
-                float y2 = y + glyph->Y1 * scale;
-                if (x1 <= clip_rect.z && x2 >= clip_rect.x)
+                if (c == '\n')
                 {
-                    // Render a character
-                    float u1 = glyph->U0;
-                    float v1 = glyph->V0;
-                    float u2 = glyph->U1;
-                    float v2 = glyph->V1;
-
-                    // CPU side clipping used to fit text in their frame when the frame is too small. Only does clipping for axis aligned quads.
-                    if (cpu_fine_clip)
-                    {
-                        if (x1 < clip_rect.x)
-                        {
-                            u1 = u1 + (1.0f - (x2 - clip_rect.x) / (x2 - x1)) * (u2 - u1);
-                            x1 = clip_rect.x;
-                        }
-                        if (y1 < clip_rect.y)
-                        {
-                            v1 = v1 + (1.0f - (y2 - clip_rect.y) / (y2 - y1)) * (v2 - v1);
-                            y1 = clip_rect.y;
-                        }
-                        if (x2 > clip_rect.z)
-                        {
-                            u2 = u1 + ((clip_rect.z - x1) / (x2 - x1)) * (u2 - u1);
-                            x2 = clip_rect.z;
-                        }
-                        if (y2 > clip_rect.w)
-                        {
-                            v2 = v1 + ((clip_rect.w - y1) / (y2 - y1)) * (v2 - v1);
-                            y2 = clip_rect.w;
-                        }
-                        if (y1 >= y2)
-                        {
-                            x += char_width;
-                            continue;
-                        }
-                    }
+                    new_line = true;
+                    break;
+                }
+                if (c == '\r')
+                    continue;
+            }
 
-                    // We are NOT calling PrimRectUV() here because non-inlined causes too much overhead in a debug builds. Inlined here:
-                    {
-                        idx_write[0] = (ImDrawIdx)(vtx_current_idx); idx_write[1] = (ImDrawIdx)(vtx_current_idx+1); idx_write[2] = (ImDrawIdx)(vtx_current_idx+2);
-                        idx_write[3] = (ImDrawIdx)(vtx_current_idx); idx_write[4] = (ImDrawIdx)(vtx_current_idx+2); idx_write[5] = (ImDrawIdx)(vtx_current_idx+3);
-                        vtx_write[0].pos.x = x1; vtx_write[0].pos.y = y1; vtx_write[0].col = col; vtx_write[0].uv.x = u1; vtx_write[0].uv.y = v1;
-                        vtx_write[1].pos.x = x2; vtx_write[1].pos.y = y1; vtx_write[1].col = col; vtx_write[1].uv.x = u2; vtx_write[1].uv.y = v1;
-                        vtx_write[2].pos.x = x2; vtx_write[2].pos.y = y2; vtx_write[2].col = col; vtx_write[2].uv.x = u2; vtx_write[2].uv.y = v2;
-                        vtx_write[3].pos.x = x1; vtx_write[3].pos.y = y2; vtx_write[3].col = col; vtx_write[3].uv.x = u1; vtx_write[3].uv.y = v2;
-                        vtx_write += 4;
-                        vtx_current_idx += 4;
-                        idx_write += 6;
-                    }
+            if (const ImFontGlyph* glyph = FindGlyph((unsigned short)c))
+            {
+                // Arbitrarily assume that both space and tabs are empty glyphs as an optimization
+                if (c != ' ' && c != '\t')
+                {
+                    run_glyphs[run_count] = glyph;
+                    run_x[run_count++] = x;
                 }
+                x += glyph->AdvanceX * scale;
             }
         }
+        ImFontRenderGlyphRun(vtx_write, idx_write, vtx_current_idx, run_glyphs, run_x, run_count, y, scale, col, clip_rect, cpu_fine_clip);
+        if (malformed)
+            break;
 
-        x += char_width;
+        if (new_line)
+        {
+            x = pos.x;
+            y += line_height;
+
+            if (y > clip_rect.w)
+                break;
+            if (!word_wrap_enabled && y + line_height < clip_rect.y)
+                while (s < text_end && *s != '\n')  // Fast-forward to next line
+                    s++;
+        }
     }
 
     // Give back unused vertices
@@ -0,0 +1,291 @@
+// Times ImDrawList::AddPolyline against the scalar version it replaced and checks both write the same vertices and indices.
+// The scalar reference below is the 1.52 AddPolyline, only made a free function. Build it once as is for the SIMD path and
+// once with -DIMGUI_DISABLE_SIMD for the plain float fallback, both must report no mismatch.
+// Usage: ImDrawPolylineBench [polylines to compare] [points to time]
+
+#include "imgui.h"
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include "imgui_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+static void ImDrawListAddPolylineScalar(ImDrawList* draw_list, const ImVec2* points, const int points_count, ImU32 col, bool closed, float thickness, bool anti_aliased)
+{
+    if (points_count < 2)
+        return;
+
+    const ImVec2 uv = GImGui->FontTexUvWhitePixel;
+    anti_aliased &= GImGui->Style.AntiAliasedLines;
+
+    int count = points_count;
+    if (!closed)
+        count = points_count-1;
+
+    const bool thick_line = thickness > 1.0f;
+    if (anti_aliased)
+    {
+        // Anti-aliased stroke
+        const float AA_SIZE = 1.0f;
+        const ImU32 col_trans = col & ~IM_COL32_A_MASK;
+
+        const int idx_count = thick_line ? count*18 : count*12;
+        const int vtx_count = thick_line ? points_count*4 : points_count*3;
+        draw_list->PrimReserve(idx_count, vtx_count);
+
+        // Temporary buffer, an ImVector in place of the alloca so the tool builds the same everywhere
+        static ImVector<ImVec2> temp_buffer;
+        temp_buffer.resize(points_count * (thick_line ? 5 : 3));
+        ImVec2* temp_normals = temp_buffer.Data;
+        ImVec2* temp_points = temp_normals + points_count;
+
+        for (int i1 = 0; i1 < count; i1++)
+        {
+            const int i2 = (i1+1) == points_count ? 0 : i1+1;
+            ImVec2 diff = points[i2] - points[i1];
+            diff *= ImInvLength(diff, 1.0f);
+            temp_normals[i1].x = diff.y;
+            temp_normals[i1].y = -diff.x;
+        }
+        if (!closed)
+            temp_normals[points_count-1] = temp_normals[points_count-2];
+
+        if (!thick_line)
+        {
+            if (!closed)
+            {
+                temp_points[0] = points[0] + temp_normals[0] * AA_SIZE;
+                temp_points[1] = points[0] - temp_normals[0] * AA_SIZE;
+                temp_points[(points_count-1)*2+0] = points[points_count-1] + temp_normals[points_count-1] * AA_SIZE;
+                temp_points[(points_count-1)*2+1] = points[points_count-1] - temp_normals[points_count-1] * AA_SIZE;
+            }
+
+            // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
+            unsigned int idx1 = draw_list->_VtxCurrentIdx;
+            for (int i1 = 0; i1 < count; i1++)
+            {
+                const int i2 = (i1+1) == points_count ? 0 : i1+1;
+                unsigned int idx2 = (i1+1) == points_count ? draw_list->_VtxCurrentIdx : idx1+3;
+
+                // Average normals
+                ImVec2 dm = (temp_normals[i1] + temp_normals[i2]) * 0.5f;
+                float dmr2 = dm.x*dm.x + dm.y*dm.y;
+                if (dmr2 > 0.000001f)
+                {
+                    float scale = 1.0f / dmr2;
+                    if (scale > 100.0f) scale = 100.0f;
+                    dm *= scale;
+                }
+                dm *= AA_SIZE;
+                temp_points[i2*2+0] = points[i2] + dm;
+                temp_points[i2*2+1] = points[i2] - dm;
+
+                // Add indexes
+                draw_list->_IdxWritePtr[0] = (ImDrawIdx)(idx2+0); draw_list->_IdxWritePtr[1] = (ImDrawIdx)(idx1+0); draw_list->_IdxWritePtr[2] = (ImDrawIdx)(idx1+2);
+                draw_list->_IdxWritePtr[3] = (ImDrawIdx)(idx1+2); draw_list->_IdxWritePtr[4] = (ImDrawIdx)(idx2+2); draw_list->_IdxWritePtr[5] = (ImDrawIdx)(idx2+0);
+                draw_list->_IdxWritePtr[6] = (ImDrawIdx)(idx2+1); draw_list->_IdxWritePtr[7] = (ImDrawIdx)(idx1+1); draw_list->_IdxWritePtr[8] = (ImDrawIdx)(idx1+0);
+                draw_list->_IdxWritePtr[9] = (ImDrawIdx)(idx1+0); draw_list->_IdxWritePtr[10]= (ImDrawIdx)(idx2+0); draw_list->_IdxWritePtr[11]= (ImDrawIdx)(idx2+1);
+                draw_list->_IdxWritePtr += 12;
+
+                idx1 = idx2;
+            }
+
+            // Add vertexes
+            for (int i = 0; i < points_count; i++)
+            {
+                draw_list->_VtxWritePtr[0].pos = points[i];          draw_list->_VtxWritePtr[0].uv = uv; draw_list->_VtxWritePtr[0].col = col;
+                draw_list->_VtxWritePtr[1].pos = temp_points[i*2+0]; draw_list->_VtxWritePtr[1].uv = uv; draw_list->_VtxWritePtr[1].col = col_trans;
+                draw_list->_VtxWritePtr[2].pos = temp_points[i*2+1]; draw_list->_VtxWritePtr[2].uv = uv; draw_list->_VtxWritePtr[2].col = col_trans;
+                draw_list->_VtxWritePtr += 3;
+            }
+        }
+        else
+        {
+            const float half_inner_thickness = (thickness - AA_SIZE) * 0.5f;
+            if (!closed)
+            {
+                temp_points[0] = points[0] + temp_normals[0] * (half_inner_thickness + AA_SIZE);
+                temp_points[1] = points[0] + temp_normals[0] * (half_inner_thickness);
+                temp_points[2] = points[0] - temp_normals[0] * (half_inner_thickness);
+                temp_points[3] = points[0] - temp_normals[0] * (half_inner_thickness + AA_SIZE);
+                temp_points[(points_count-1)*4+0] = points[points_count-1] + temp_normals[points_count-1] * (half_inner_thickness + AA_SIZE);
+                temp_points[(points_count-1)*4+1] = points[points_count-1] + temp_normals[points_count-1] * (half_inner_thickness);
+                temp_points[(points_count-1)*4+2] = points[points_count-1] - temp_normals[points_count-1] * (half_inner_thickness);
+                temp_points[(points_count-1)*4+3] = points[points_count-1] - temp_normals[points_count-1] * (half_inner_thickness + AA_SIZE);
+            }
+
+            // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
+            unsigned int idx1 = draw_list->_VtxCurrentIdx;
+            for (int i1 = 0; i1 < count; i1++)
+            {
+                const int i2 = (i1+1) == points_count ? 0 : i1+1;
+                unsigned int idx2 = (i1+1) == points_count ? draw_list->_VtxCurrentIdx : idx1+4;
+
+                // Average normals
+                ImVec2 dm = (temp_normals[i1] + temp_normals[i2]) * 0.5f;
+                float dmr2 = dm.x*dm.x + dm.y*dm.y;
+                if (dmr2 > 0.000001f)
+                {
+                    float scale = 1.0f / dmr2;
+                    if (scale > 100.0f) scale = 100.0f;
+                    dm *= scale;
+                }
+                ImVec2 dm_out = dm * (half_inner_thickness + AA_SIZE);
+                ImVec2 dm_in = dm * half_inner_thickness;
+                temp_points[i2*4+0] = points[i2] + dm_out;
+                temp_points[i2*4+1] = points[i2] + dm_in;
+                temp_points[i2*4+2] = points[i2] - dm_in;
+                temp_points[i2*4+3] = points[i2] - dm_out;
+
+                // Add indexes
+                draw_list->_IdxWritePtr[0]  = (ImDrawIdx)(idx2+1); draw_list->_IdxWritePtr[1]  = (ImDrawIdx)(idx1+1); draw_list->_IdxWritePtr[2]  = (ImDrawIdx)(idx1+2);
+                draw_list->_IdxWritePtr[3]  = (ImDrawIdx)(idx1+2); draw_list->_IdxWritePtr[4]  = (ImDrawIdx)(idx2+2); draw_list->_IdxWritePtr[5]  = (ImDrawIdx)(idx2+1);
+                draw_list->_IdxWritePtr[6]  = (ImDrawIdx)(idx2+1); draw_list->_IdxWritePtr[7]  = (ImDrawIdx)(idx1+1); draw_list->_IdxWritePtr[8]  = (ImDrawIdx)(idx1+0);
+                draw_list->_IdxWritePtr[9]  = (ImDrawIdx)(idx1+0); draw_list->_IdxWritePtr[10] = (ImDrawIdx)(idx2+0); draw_list->_IdxWritePtr[11] = (ImDrawIdx)(idx2+1);
+                draw_list->_IdxWritePtr[12] = (ImDrawIdx)(idx2+2); draw_list->_IdxWritePtr[13] = (ImDrawIdx)(idx1+2); draw_list->_IdxWritePtr[14] = (ImDrawIdx)(idx1+3);
+                draw_list->_IdxWritePtr[15] = (ImDrawIdx)(idx1+3); draw_list->_IdxWritePtr[16] = (ImDrawIdx)(idx2+3); draw_list->_IdxWritePtr[17] = (ImDrawIdx)(idx2+2);
+                draw_list->_IdxWritePtr += 18;
+
+                idx1 = idx2;
+            }
+
+            // Add vertexes
+            for (int i = 0; i < points_count; i++)
+            {
+                draw_list->_VtxWritePtr[0].pos = temp_points[i*4+0]; draw_list->_VtxWritePtr[0].uv = uv; draw_list->_VtxWritePtr[0].col = col_trans;
+                draw_list->_VtxWritePtr[1].pos = temp_points[i*4+1]; draw_list->_VtxWritePtr[1].uv = uv; draw_list->_VtxWritePtr[1].col = col;
+                draw_list->_VtxWritePtr[2].pos = temp_points[i*4+2]; draw_list->_VtxWritePtr[2].uv = uv; draw_list->_VtxWritePtr[2].col = col;
+                draw_list->_VtxWritePtr[3].pos = temp_points[i*4+3]; draw_list->_VtxWritePtr[3].uv = uv; draw_list->_VtxWritePtr[3].col = col_trans;
+                draw_list->_VtxWritePtr += 4;
+            }
+        }
+        draw_list->_VtxCurrentIdx += (ImDrawIdx)vtx_count;
+    }
+    else
+    {
+        // Non Anti-aliased Stroke
+        const int idx_count = count*6;
+        const int vtx_count = count*4;      // FIXME-OPT: Not sharing edges
+        draw_list->PrimReserve(idx_count, vtx_count);
+
+        for (int i1 = 0; i1 < count; i1++)
+        {
+            const int i2 = (i1+1) == points_count ? 0 : i1+1;
+            const ImVec2& p1 = points[i1];
+            const ImVec2& p2 = points[i2];
+            ImVec2 diff = p2 - p1;
+            diff *= ImInvLength(diff, 1.0f);
+
+            const float dx = diff.x * (thickness * 0.5f);
+            const float dy = diff.y * (thickness * 0.5f);
+            draw_list->_VtxWritePtr[0].pos.x = p1.x + dy; draw_list->_VtxWritePtr[0].pos.y = p1.y - dx; draw_list->_VtxWritePtr[0].uv = uv; draw_list->_VtxWritePtr[0].col = col;
+            draw_list->_VtxWritePtr[1].pos.x = p2.x + dy; draw_list->_VtxWritePtr[1].pos.y = p2.y - dx; draw_list->_VtxWritePtr[1].uv = uv; draw_list->_VtxWritePtr[1].col = col;
+            draw_list->_VtxWritePtr[2].pos.x = p2.x - dy; draw_list->_VtxWritePtr[2].pos.y = p2.y + dx; draw_list->_VtxWritePtr[2].uv = uv; draw_list->_VtxWritePtr[2].col = col;
+            draw_list->_VtxWritePtr[3].pos.x = p1.x - dy; draw_list->_VtxWritePtr[3].pos.y = p1.y + dx; draw_list->_VtxWritePtr[3].uv = uv; draw_list->_VtxWritePtr[3].col = col;
+            draw_list->_VtxWritePtr += 4;
+
+            draw_list->_IdxWritePtr[0] = (ImDrawIdx)(draw_list->_VtxCurrentIdx); draw_list->_IdxWritePtr[1] = (ImDrawIdx)(draw_list->_VtxCurrentIdx+1); draw_list->_IdxWritePtr[2] = (ImDrawIdx)(draw_list->_VtxCurrentIdx+2);
+            draw_list->_IdxWritePtr[3] = (ImDrawIdx)(draw_list->_VtxCurrentIdx); draw_list->_IdxWritePtr[4] = (ImDrawIdx)(draw_list->_VtxCurrentIdx+2); draw_list->_IdxWritePtr[5] = (ImDrawIdx)(draw_list->_VtxCurrentIdx+3);
+            draw_list->_IdxWritePtr += 6;
+            draw_list->_VtxCurrentIdx += 4;
+        }
+    }
+}
+
+
+typedef void (*AddPolylineFn)(ImDrawList* draw_list, const ImVec2* points, int points_count, ImU32 col, bool closed, float thickness, bool anti_aliased);
+
+static void AddPolylineSimd(ImDrawList* draw_list, const ImVec2* points, int points_count, ImU32 col, bool closed, float thickness, bool anti_aliased)
+{
+    draw_list->AddPolyline(points, points_count, col, closed, thickness, anti_aliased);
+}
+
+static void ResetDrawList(ImDrawList* draw_list)
+{
+    draw_list->Clear();
+    draw_list->PushClipRect(ImVec2(-100000.0f, -100000.0f), ImVec2(100000.0f, 100000.0f));
+    draw_list->PushTextureID(NULL);
+}
+
+// Best of 'runs' timings of one call drawing 'points' as two open polylines, in milliseconds
+static double TimePolyline(AddPolylineFn fn, ImDrawList* draw_list, const ImVector<ImVec2>& points, float thickness, int runs)
+{
+    double best = 1e9;
+    const int half = points.Size / 2;
+    for (int run = 0; run < runs; run++)
+    {
+        ResetDrawList(draw_list);
+        const std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+        fn(draw_list, points.Data, half, IM_COL32_WHITE, false, thickness, true);
+        fn(draw_list, points.Data + half, points.Size - half, IM_COL32_WHITE, false, thickness, true);
+        const std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+        const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        if (ms < best)
+            best = ms;
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    const int polylines = argc > 1 ? atoi(argv[1]) : 4000;
+    const int bench_points = argc > 2 ? atoi(argv[2]) : 30000;
+
+    // AddPolyline needs a started frame for the style and the white pixel
+    ImGuiIO& io = ImGui::GetIO();
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+    io.DisplaySize = ImVec2(800, 600);
+    ImGui::NewFrame();
+
+    // Random open and closed polylines with repeated points, thin and thick, with and without anti-aliasing
+    ImDrawList simd, scalar;
+    ImVector<ImVec2> points;
+    int mismatches = 0;
+    srand(1);
+    for (int n = 0; n < polylines; n++)
+    {
+        const int count = 2 + rand() % 40;
+        points.resize(count);
+        for (int i = 0; i < count; i++)
+        {
+            if (i > 0 && rand() % 7 == 0)
+                points[i] = points[i - 1];
+            else
+                points[i] = ImVec2((rand() % 20000) / 37.0f, (rand() % 20000) / 41.0f);
+        }
+        const bool closed = (rand() & 1) != 0;
+        const float thickness = (rand() % 3 == 0) ? 1.0f : (rand() % 500) / 50.0f;
+        const bool anti_aliased = rand() % 5 != 0;
+        ResetDrawList(&simd);
+        ResetDrawList(&scalar);
+        AddPolylineSimd(&simd, points.Data, count, IM_COL32(200, 100, 50, 255), closed, thickness, anti_aliased);
+        ImDrawListAddPolylineScalar(&scalar, points.Data, count, IM_COL32(200, 100, 50, 255), closed, thickness, anti_aliased);
+        if (simd.VtxBuffer.Size != scalar.VtxBuffer.Size || simd.IdxBuffer.Size != scalar.IdxBuffer.Size ||
+            memcmp(simd.VtxBuffer.Data, scalar.VtxBuffer.Data, simd.VtxBuffer.Size * sizeof(ImDrawVert)) != 0 ||
+            memcmp(simd.IdxBuffer.Data, scalar.IdxBuffer.Data, simd.IdxBuffer.Size * sizeof(ImDrawIdx)) != 0)
+        {
+            if (mismatches++ < 10)
+                fprintf(stderr, "polyline %d (%d points, %s, thickness %g, %s) differs\n", n, count, closed ? "closed" : "open", thickness, anti_aliased ? "anti-aliased" : "aliased");
+        }
+    }
+    printf("%d / %d polylines bit-identical\n", polylines - mismatches, polylines);
+
+    // A long wavy line, the case the SIMD path is for
+    points.resize(bench_points);
+    for (int i = 0; i < bench_points; i++)
+        points[i] = ImVec2(i * 0.05f, 300.0f + 100.0f * sinf(i * 0.01f) + (rand() % 100) * 0.1f);
+    for (int thick = 0; thick < 2; thick++)
+    {
+        const float thickness = thick ? 3.0f : 1.0f;
+        const double ms_scalar = TimePolyline(ImDrawListAddPolylineScalar, &scalar, points, thickness, 40);
+        const double ms_simd = TimePolyline(AddPolylineSimd, &simd, points, thickness, 40);
+        printf("%s lines, %d points: scalar %.3f ms, simd %.3f ms (%.2fx)\n", thick ? "thick" : "thin", bench_points, ms_scalar, ms_simd, ms_scalar / ms_simd);
+    }
+
+    ImGui::Shutdown();
+    return mismatches == 0 ? 0 : 1;
+}
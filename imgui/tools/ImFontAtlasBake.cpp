@@ -0,0 +1,108 @@
+// Builds the default font atlas (ProggyClean 13px, as AddFontDefault() adds it) and writes it to a header of constant arrays.
+// The header is what imgui_draw.cpp includes with IMGUI_PREBAKED_DEFAULT_FONT, the build runs this tool without the define.
+// Usage: ImFontAtlasBake <output.h>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef IMGUI_PREBAKED_DEFAULT_FONT
+#error ImFontAtlasBake generates the header IMGUI_PREBAKED_DEFAULT_FONT includes, build it without the define
+#endif
+
+// %.9g keeps every float exact through the text round trip, whole numbers get a ".0" to stay float literals
+static void WriteFloat(FILE* f, float v)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", v);
+    fprintf(f, "%s%sf", buf, strpbrk(buf, ".e") ? "" : ".0");
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s <output.h>\n", argv[0]);
+        return 1;
+    }
+
+    ImFontAtlas atlas;
+    atlas.BuildThreads = 1;
+    atlas.AddFontDefault();
+    if (!atlas.Build())
+    {
+        fprintf(stderr, "%s: building the default font failed\n", argv[0]);
+        return 1;
+    }
+    const ImFont* font = atlas.Fonts[0];
+    const ImFontAtlas::CustomRect& rect = atlas.CustomRects[atlas.CustomRectIds[0]];
+    IM_ASSERT(atlas.Fonts.Size == 1 && atlas.CustomRects.Size == 1 && font->IndexAdvanceX.Size == font->IndexLookup.Size);
+
+    FILE* f = fopen(argv[1], "wb");
+    if (!f)
+    {
+        fprintf(stderr, "%s: can't write %s\n", argv[0], argv[1]);
+        return 1;
+    }
+    fprintf(f, "// Generated by tools/ImFontAtlasBake.cpp from ImFontAtlas::AddFontDefault(), do not edit.\n");
+    fprintf(f, "// %s, %dx%d atlas, %d glyphs\n\n", font->ConfigData->Name, atlas.TexWidth, atlas.TexHeight, font->Glyphs.Size);
+
+    fprintf(f, "constexpr unsigned char ImFontAtlasPrebakedDefaultPixels[%d] =\n{", atlas.TexWidth * atlas.TexHeight);
+    for (int i = 0; i < atlas.TexWidth * atlas.TexHeight; i++)
+        fprintf(f, "%s%d,", (i % 32) == 0 ? "\n    " : "", atlas.TexPixelsAlpha8[i]);
+    fprintf(f, "\n};\n\n");
+
+    // Codepoint, AdvanceX, X0, Y0, X1, Y1, U0, V0, U1, V1
+    fprintf(f, "constexpr ImFontGlyph ImFontAtlasPrebakedDefaultGlyphs[%d] =\n{\n", font->Glyphs.Size);
+    for (int i = 0; i < font->Glyphs.Size; i++)
+    {
+        const ImFontGlyph& g = font->Glyphs[i];
+        const float values[] = { g.AdvanceX, g.X0, g.Y0, g.X1, g.Y1, g.U0, g.V0, g.U1, g.V1 };
+        fprintf(f, "    { 0x%04X", (unsigned int)g.Codepoint);
+        for (int n = 0; n < IM_ARRAYSIZE(values); n++)
+        {
+            fprintf(f, ", ");
+            WriteFloat(f, values[n]);
+        }
+        fprintf(f, " },\n");
+    }
+    fprintf(f, "};\n\n");
+
+    fprintf(f, "constexpr float ImFontAtlasPrebakedDefaultIndexAdvanceX[%d] =\n{", font->IndexAdvanceX.Size);
+    for (int i = 0; i < font->IndexAdvanceX.Size; i++)
+    {
+        fprintf(f, "%s", (i % 16) == 0 ? "\n    " : " ");
+        WriteFloat(f, font->IndexAdvanceX[i]);
+        fprintf(f, ",");
+    }
+    fprintf(f, "\n};\n\n");
+
+    fprintf(f, "constexpr unsigned short ImFontAtlasPrebakedDefaultIndexLookup[%d] =\n{", font->IndexLookup.Size);
+    for (int i = 0; i < font->IndexLookup.Size; i++)
+        fprintf(f, "%s%d,", (i % 16) == 0 ? "\n    " : " ", font->IndexLookup[i]);
+    fprintf(f, "\n};\n\n");
+
+    fprintf(f, "constexpr ImFontAtlasPrebaked GImFontAtlasPrebakedDefault =\n{\n");
+    fprintf(f, "    %d, %d,\n", atlas.TexWidth, atlas.TexHeight);
+    fprintf(f, "    %d, %d, ", atlas.TexDesiredWidth, atlas.TexGlyphPadding);
+    WriteFloat(f, font->ConfigData->SizePixels);
+    fprintf(f, ",\n    %d, %d,\n    ", rect.X, rect.Y);
+    WriteFloat(f, font->Ascent);
+    fprintf(f, ", ");
+    WriteFloat(f, font->Descent);
+    fprintf(f, ",\n    %d,\n", font->MetricsTotalSurface);
+    fprintf(f, "    %d, %d,\n", font->Glyphs.Size, font->IndexLookup.Size);
+    fprintf(f, "    ImFontAtlasPrebakedDefaultPixels, ImFontAtlasPrebakedDefaultGlyphs, ImFontAtlasPrebakedDefaultIndexAdvanceX, ImFontAtlasPrebakedDefaultIndexLookup,\n");
+    fprintf(f, "};\n");
+
+    const bool ok = ferror(f) == 0;
+    fclose(f);
+    if (!ok)
+    {
+        remove(argv[1]);
+        fprintf(stderr, "%s: writing %s failed\n", argv[0], argv[1]);
+        return 1;
+    }
+    return 0;
+}